@@ -2,6 +2,11 @@
 #define APRS_CONFIG_H
 
 #include <Arduino.h>
+#include <APRS_SmartBeacon.h>
+
+// Update interval limits in minutes (the scheduler's period 0 is one-shot)
+#define UPDATE_INTERVAL_MIN     1
+#define UPDATE_INTERVAL_MAX     60
 
 /**
  * APRS Configuration Structure
@@ -22,6 +27,8 @@ struct APRSConfig {
     uint16_t preamble_ms;       // PTT lead time in milliseconds
     uint16_t tail_ms;           // PTT tail time in milliseconds
     uint16_t update_interval_min; // TX interval in minutes
+    bool smart_beacon;          // Position rate follows speed and turns (telemetry stays on update_interval_min)
+    APRS::SmartBeaconConfig smart_beacon_params; // Speeds in km/h, times in seconds
 };
 
 /**
@@ -52,4 +59,12 @@ bool isAPRSConfigured();
  */
 APRSConfig getDefaultAPRSConfig();
 
+/**
+ * Limit an update interval to UPDATE_INTERVAL_MIN..UPDATE_INTERVAL_MAX
+ * 
+ * @param minutes Interval as entered or stored
+ * @return Interval in minutes
+ */
+uint16_t clampUpdateInterval(int minutes);
+
 #endif // APRS_CONFIG_H
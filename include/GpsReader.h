@@ -0,0 +1,91 @@
+#ifndef GPSREADER_H
+#define GPSREADER_H
+
+#include <Arduino.h>
+#include <TinyGPSPlus.h>
+#include <driver/uart.h>
+#include "hardware_config.h"
+
+/**
+ * One GPS fix, copied out whole
+ */
+struct GpsFix {
+    bool valid = false;
+    float lat = 0.0f;
+    float lon = 0.0f;
+    float alt = 0.0f;
+    bool has_alt = false;
+    int16_t course = -1;        // Degrees, negative while unknown
+    float speed = -1.0f;        // Knots, negative while unknown
+    uint8_t satellites = 0;
+    uint32_t time_ms = 0;       // millis() when the fix was completed
+    uint32_t sequence = 0;      // Completed fixes so far
+};
+
+/**
+ * NMEA ingestion counters
+ */
+struct GpsStats {
+    uint32_t lines = 0;             // Lines read off the UART
+    uint32_t sentences = 0;         // Passed the checksum
+    uint32_t checksum_errors = 0;
+    uint32_t long_lines = 0;        // Longer than GPS_MAX_LINE, discarded
+    uint32_t fifo_overflows = 0;    // Hardware FIFO overran before the ISR emptied it
+    uint32_t buffer_full = 0;       // Driver ring buffer overran before the task read it
+    uint32_t pattern_overflows = 0; // More lines queued than the pattern queue holds
+    size_t buffered_peak = 0;       // Most bytes waiting in the ring buffer
+};
+
+/**
+ * GpsReader - NMEA parsing on its own FreeRTOS task
+ *
+ * The UART driver's ISR moves received bytes into a ring buffer and posts
+ * an event for every newline (pattern detect). The task sleeps on the
+ * event queue, reads whole lines and feeds them to TinyGPSPlus, so
+ * nothing is lost while other tasks are busy. Each sentence that carries
+ * a position completes a fix, published whole: fix() always returns the
+ * latest complete one.
+ */
+class GpsReader {
+public:
+    GpsReader();
+
+    /**
+     * Install the UART driver and start the task
+     *
+     * @param port UART number (not one in use by a HardwareSerial)
+     * @param rx_pin ESP32 RX <- GPS TX
+     * @param tx_pin ESP32 TX -> GPS RX
+     * @param baud GPS baud rate
+     * @param fallback Fix returned until the first valid one (e.g. a home position)
+     * @return true on success
+     */
+    bool begin(uart_port_t port, int rx_pin, int tx_pin, uint32_t baud, const GpsFix& fallback);
+
+    /**
+     * Latest complete fix (the fallback position until one is valid)
+     */
+    GpsFix fix() const;
+
+    /**
+     * Ingestion counters
+     */
+    GpsStats stats() const;
+
+private:
+    uart_port_t _port;
+    QueueHandle_t _events;
+    TaskHandle_t _task;
+    TinyGPSPlus _gps;
+    mutable portMUX_TYPE _mux;
+    GpsFix _fix;
+    GpsStats _stats;
+    char _line[GPS_MAX_LINE];
+
+    void readLines();
+    void parseLine(const char* line, size_t len);
+    void publish();
+    static void taskEntry(void* arg);
+};
+
+#endif // GPSREADER_H
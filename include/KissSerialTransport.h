@@ -0,0 +1,40 @@
+#ifndef KISSSERIALTRANSPORT_H
+#define KISSSERIALTRANSPORT_H
+
+#include <APRS_KISS.h>
+#include <Arduino.h>
+
+/**
+ * KissSerialTransport - KISS host link over an Arduino Stream
+ *
+ * Reads are polled: the UART driver buffers incoming bytes (size it with
+ * setRxBufferSize() before begin()) while the KISS task waits.
+ */
+class KissSerialTransport : public APRS::KissTransport {
+public:
+    explicit KissSerialTransport(Stream& stream) : _stream(stream) {}
+
+    size_t read(uint8_t* data, size_t max, uint32_t timeout_ms) override {
+        uint32_t start = millis();
+        while (_stream.available() <= 0) {
+            if (millis() - start >= timeout_ms) {
+                return 0;
+            }
+            delay(1);
+        }
+        size_t n = 0;
+        while (n < max && _stream.available() > 0) {
+            data[n++] = (uint8_t)_stream.read();
+        }
+        return n;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        return _stream.write(data, len);
+    }
+
+private:
+    Stream& _stream;
+};
+
+#endif // KISSSERIALTRANSPORT_H
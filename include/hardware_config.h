@@ -40,6 +40,11 @@
 #define RADIO_AUDIO_IN          36           // Radio audio out (ADC, input-only)
 #define RADIO_AUDIO_TRIGGER     32           // Defined but not used
 
+// TX audio backend: 0 = I2S built-in DAC (GPIO 25 only), 1 = sigma-delta
+// on RADIO_AUDIO_OUT (any GPIO, needs an RC low-pass, e.g. 1k / 47nF).
+// The sigma-delta sink leaves I2S0 to the receiver during transmit.
+#define RADIO_AUDIO_SIGMA_DELTA 0
+
 // ============================================================================
 // Radio (DRA818) Control Pins
 // ============================================================================
@@ -55,16 +60,34 @@
 // TX: GPIO 1 (implicit, USB)
 #define CONSOLE_BAUDRATE        115200
 
+// KISS TNC on the console (0: log only). The firmware's log lines still
+// go to the same port and can land inside a KISS frame sent to the host,
+// corrupting it; enable only for hosts that tolerate the odd bad frame.
+#define KISS_ON_CONSOLE         0
+#define KISS_RX_BUFFER          2048    // Console RX buffer for host frames
+
 // Serial Port 1: Radio (DRA818) Module (HardwareSerial(1))
 #define RADIO_RX                18  // ESP32 RX <- Radio TX
 #define RADIO_TX                19  // ESP32 TX -> Radio RX
 #define RADIO_BAUDRATE          9600
 
-// Serial Port 2: GPS Module (HardwareSerial(2))
+// GPS Module (UART1, ESP-IDF driver: see GpsReader)
 #define GPS_RX                  16  // ESP32 RX <- GPS TX
 #define GPS_TX                  17  // ESP32 TX -> GPS RX
 #define GPS_BAUDRATE            9600
 
+// GPS ingestion task (GpsReader): the UART driver's ISR fills a ring buffer
+// and wakes the task at each newline, so sentences survive while other
+// tasks are busy. At 9600 baud 2 KB holds about 2 s of NMEA.
+#define GPS_UART_NUM            1       // Driver owns UART1; no HardwareSerial on it
+#define GPS_RX_BUFFER           2048    // Driver ring buffer (bytes)
+#define GPS_EVENT_QUEUE         20      // UART events and queued newline positions
+#define GPS_MAX_LINE            96      // Longest NMEA line kept (spec: 82)
+#define GPS_TASK_PRIORITY       3       // Above the beacon scheduler
+#define GPS_TASK_CORE           1
+#define GPS_TASK_STACK          4096
+#define GPS_FIX_MAX_AGE_MS      2000    // Course/speed/altitude older than this leave a fix
+
 // ============================================================================
 // I2C Bus Configuration (for sensors like BME280)
 // ============================================================================
@@ -83,14 +106,29 @@
 #define CONFIG_TRIGGER_PIN      23  // Pull LOW to enter WiFi config mode
 
 // ============================================================================
-// I2S Configuration for AFSK/APRS Audio Generation
+// AFSK Modem for APRS Audio Generation
 // ============================================================================
-#define I2S_NUM                 I2S_NUM_0
-#define I2S_SAMPLE_RATE         105600  // 13200 * 8 (oversampling)
-#define I2S_SAMPLE_BITS         I2S_BITS_PER_SAMPLE_16BIT
-#define I2S_CHANNEL_FORMAT      I2S_CHANNEL_FMT_ONLY_RIGHT
-#define I2S_DMA_BUF_COUNT       2
-#define I2S_DMA_BUF_LEN         300
+// Sample rate, baud and tones come from the modem (APRS_Modem.h); the DAC
+// DMA buffers are sized from its rate. Bell202 runs at 105.6 kHz;
+// Bell202_26k and Bell202_13k use less CPU and DMA memory per packet.
+#define APRS_TX_MODEM           Bell202
+
+// FX.25 forward error correction on transmit: Off, Check16, Check32 or
+// Check64 parity bytes per frame. Plain AX.25 receivers still decode it.
+#define APRS_TX_FX25            Off
+
+// On-air framing: Ax25. The IL2P framings (IL2P receivers only) are built
+// only with APRS_IL2P, for the host tools, until il2p's known answers pass
+#define APRS_TX_FRAMING         Ax25
+
+// Position reports: Compressed (Base91, course/speed or altitude in 13
+// bytes), MicE (latitude in the destination, shortest frame) or
+// Uncompressed (DDMM.MMN/DDDMM.MMW with ccc/sss and /A=)
+#define APRS_POSITION_FORMAT    Compressed
+
+// Mic-E status: OffDuty, EnRoute, InService, Returning, Committed, Special,
+// Priority, Custom0-Custom6 or Emergency
+#define APRS_MIC_E_MESSAGE      EnRoute
 
 // ============================================================================
 // Radio Default Configuration
@@ -110,6 +148,7 @@
 #define DEFAULT_APRS_TABLE      '/'          // Primary symbol table
 #define DEFAULT_PREAMBLE_MS     350          // Pre-transmission flags
 #define DEFAULT_TAIL_MS         50           // Post-transmission flags
+#define DEFAULT_SMART_BEACON    true         // Position rate from speed/turns (telemetry keeps the fixed interval)
 
 // ============================================================================
 // Timing Configuration
@@ -118,11 +157,33 @@
 #define GPS_UPDATE_INTERVAL_MS  1000         // Check GPS every second
 #define TELEMETRY_EVERY_N_POS   3            // Send telemetry every 3rd position
 
+// Beacon scheduler (timer-driven jobs; see setupScheduler() in main.cpp)
+#define APRS_DEFINITIONS_EVERY_N 6           // PARM/UNIT with every 6th telemetry report
+#define APRS_STATUS_TEXT        "ESP32 APRS tracker"
+#define APRS_STATUS_DELAY_S     30           // Status report this long after boot ...
+#define APRS_STATUS_JITTER_S    30           // ... plus up to this much, so trackers restarted together spread out
+#define APRS_REPORT_INTERVAL_S  600          // TX, duty cycle, GPS/NMEA counters and job lateness on the console
+
+// Airtime cap: PTT-on time per rolling window. Key-ups over it drop the
+// telemetry definitions and wait (protects the channel and the DRA818's
+// thermal budget if the update interval is set too low).
+#define APRS_TX_MAX_DUTY_PERCENT 10          // 0: no limit
+#define APRS_TX_DUTY_WINDOW_S   600          // 10 minute window
+
 // ============================================================================
-// PTT Configuration
+// PTT Configuration (build_flags in platformio.ini take precedence)
+//
+// PTT switches in step with the DAC samples, so these are exact: trim them
+// to the radio's key-up and key-down times.
 // ============================================================================
+#ifndef PTT_ACTIVE_LOW
 #define PTT_ACTIVE_LOW          1            // PTT is active LOW
-#define APRS_PTT_PRE_MS         250          // PTT lead time before audio
-#define APRS_PTT_TAIL_MS        120          // PTT tail time after audio
+#endif
+#ifndef APRS_PTT_PRE_MS
+#define APRS_PTT_PRE_MS         250          // PTT on to the first audio sample
+#endif
+#ifndef APRS_PTT_TAIL_MS
+#define APRS_PTT_TAIL_MS        120          // Last audio sample to PTT off
+#endif
 
 #endif // HARDWARE_CONFIG_H
@@ -9,9 +9,27 @@ bool APRSClient::begin(const Config& config) {
     ProtocolConfig pconfig = {
         .ptt_pin = _config.ptt_pin,
         .preamble_ms = _config.preamble_ms,
-        .tail_ms = _config.tail_ms
+        .tail_ms = _config.tail_ms,
+        .modulator = _config.modulator,
+        .sink = _config.sink,
+        .modem = _config.modem,
+        .fx25 = _config.fx25,
+        .framing = _config.framing,
+        .render_cache = _config.render_cache,
+        .ptt_lead_ms = _config.ptt_lead_ms,
+        .ptt_tail_ms = _config.ptt_tail_ms,
+        .ptt_active_high = _config.ptt_active_high
     };
     
+    // Source, destination and path never change: encode them once
+    AX25Call src = makeCall(_config.callsign, _config.ssid);
+    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
+    AX25Call path[2]; size_t path_len;
+    buildPath(path, path_len);
+    if (!_header.build(src, dst, path, path_len)) {
+        return false;
+    }
+    
     return _protocol.begin(pconfig);
 }
 
@@ -33,48 +51,64 @@ void APRSClient::buildPath(AX25Call* path, size_t& path_len) {
     }
 }
 
-bool APRSClient::sendPosition(float lat, float lon, 
-                             const char* comment,
-                             uint8_t power,
-                             uint8_t height,
-                             uint8_t gain,
-                             uint8_t directivity) {
-    // Convert coordinates to APRS format
-    char lat_str[9];
-    char lon_str[10];
-    if (!convertLatitude(lat, lat_str) || !convertLongitude(lon, lon_str)) {
-        return false;
-    }
-    
-    // Build payload:
-    // =DDMM.MMN/DDDMM.MMLsPHGphgd<comment>
-    // where s is symbol table, L is symbol, PHG is optional
-    char payload[120];
+size_t APRSClient::buildPositionPayload(const PositionReport& report,
+                                        const char* comment,
+                                        const uint8_t* phg,
+                                        char* payload,
+                                        char* dest) const {
     size_t idx = 0;
     
-    payload[idx++] = '=';  // Position without timestamp
-    
-    // Latitude
-    memcpy(&payload[idx], lat_str, 8); idx += 8;
-    
-    // Symbol table
-    payload[idx++] = _config.symbol_table;
-    
-    // Longitude
-    memcpy(&payload[idx], lon_str, 9); idx += 9;
-    
-    // Symbol
-    payload[idx++] = _config.symbol;
-    
-    // Optional PHG (if all values < 10)
-    if (power < 10 && height < 10 && gain < 10 && directivity <= 9) {
-        payload[idx++] = 'P';
-        payload[idx++] = 'H';
-        payload[idx++] = 'G';
-        payload[idx++] = char('0' + power);
-        payload[idx++] = char('0' + height);
-        payload[idx++] = char('0' + gain);
-        payload[idx++] = char('0' + directivity);
+    if (_config.position_format == PositionFormat::MicE) {
+        // `dmhSDE$/[xxx}]<comment>, latitude and message in dest
+        idx = encodeMicE(report, _config.mic_e_message, _config.symbol_table,
+                         _config.symbol, dest, payload);
+        if (idx == 0) {
+            return 0;
+        }
+    } else if (_config.position_format == PositionFormat::Compressed) {
+        // =/YYYYXXXX$csT[/A=aaaaaa]<comment>
+        payload[idx++] = '=';  // Position without timestamp
+        size_t len = encodeCompressedPosition(report, _config.symbol_table,
+                                              _config.symbol, &payload[idx]);
+        if (len == 0) {
+            return 0;
+        }
+        idx += len;
+        
+        // cs already holds the altitude unless it holds course/speed
+        if (report.has_altitude && report.hasCourseSpeed()) {
+            idx += encodeAltitude(report.altitude_m, &payload[idx]);
+        }
+    } else {
+        // Convert coordinates to APRS format
+        char lat_str[9];
+        char lon_str[10];
+        if (!convertLatitude(report.lat, lat_str) || !convertLongitude(report.lon, lon_str)) {
+            return 0;
+        }
+        
+        // =DDMM.MMN/DDDMM.MMLs[PHGphgd|ccc/sss][/A=aaaaaa]<comment>
+        // where s is symbol table, L is symbol
+        payload[idx++] = '=';  // Position without timestamp
+        memcpy(&payload[idx], lat_str, 8); idx += 8;
+        payload[idx++] = _config.symbol_table;
+        memcpy(&payload[idx], lon_str, 9); idx += 9;
+        payload[idx++] = _config.symbol;
+        
+        // Optional PHG (if all values < 10)
+        if (phg && phg[0] < 10 && phg[1] < 10 && phg[2] < 10 && phg[3] <= 9) {
+            payload[idx++] = 'P';
+            payload[idx++] = 'H';
+            payload[idx++] = 'G';
+            for (int i = 0; i < 4; i++) {
+                payload[idx++] = char('0' + phg[i]);
+            }
+        } else if (report.hasCourseSpeed()) {
+            idx += encodeCourseSpeed(report.course, report.speed_knots, &payload[idx]);
+        }
+        if (report.has_altitude) {
+            idx += encodeAltitude(report.altitude_m, &payload[idx]);
+        }
     }
     
     // Optional comment
@@ -84,14 +118,102 @@ bool APRSClient::sendPosition(float lat, float lon,
         idx += comment_len;
     }
     
-    // Build path and send
-    AX25Call src = makeCall(_config.callsign, _config.ssid);
-    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
-    AX25Call path[2]; size_t path_len;
-    buildPath(path, path_len);
+    return idx;
+}
+
+size_t APRSClient::encode(const uint8_t* payload, size_t length, uint8_t* frame) const {
+    return _header.encode(payload, length, frame, AX25_MAX_FRAME_LEN);
+}
+
+size_t APRSClient::encodePosition(const PositionReport& report, const char* comment,
+                                  const uint8_t* phg, uint8_t* frame) const {
+    char payload[120];
+    char dest[MICE_DEST_LEN + 1];
+    size_t len = buildPositionPayload(report, comment, phg, payload, dest);
+    if (len == 0) {
+        return 0;
+    }
+    if (_config.position_format == PositionFormat::MicE) {
+        return _header.encode(makeCall(dest, 0), reinterpret_cast<uint8_t*>(payload), len,
+                              frame, AX25_MAX_FRAME_LEN);
+    }
+    return encode(reinterpret_cast<uint8_t*>(payload), len, frame);
+}
+
+bool APRSClient::send(const uint8_t* payload, size_t length) {
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encode(payload, length, frame);
+    return len > 0 && transmit(frame, len);
+}
+
+bool APRSClient::transmit(const uint8_t* frame, size_t len) {
+    if (_engine.inBurst()) {
+        return false;  // Would wait on a frame the open burst holds back
+    }
+    
+    // With a TX task running the protocol belongs to that task: queue the
+    // frame and wait for it instead of modulating concurrently
+    if (_engine.isRunning()) {
+        TxHandle handle = _engine.submit(frame, len);
+        if (handle == 0) {
+            return false;
+        }
+        TxState state = _engine.state(handle);
+        while (state == TxState::Queued || state == TxState::Sending) {
+            HAL::delayMs(10);
+            state = _engine.state(handle);
+        }
+        return state == TxState::Sent;
+    }
     
-    return _protocol.sendPacket(src, dst, path, path_len,
-                                reinterpret_cast<uint8_t*>(payload), idx);
+    return _protocol.transmitFrame(frame, len);
+}
+
+TxHandle APRSClient::enqueue(const uint8_t* payload, size_t length, uint8_t key,
+                             TxPriority priority) {
+    if (!_engine.isStarted()) {
+        return 0;
+    }
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encode(payload, length, frame);
+    if (len == 0) {
+        return 0;
+    }
+    return _engine.submit(frame, len, key, priority);
+}
+
+TxHandle APRSClient::enqueuePosition(const PositionReport& report, const char* comment,
+                                     const uint8_t* phg) {
+    if (!_engine.isStarted()) {
+        return 0;
+    }
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodePosition(report, comment, phg, frame);
+    if (len == 0) {
+        return 0;
+    }
+    return _engine.submit(frame, len, KEY_POSITION);
+}
+
+bool APRSClient::sendPosition(float lat, float lon, 
+                             const char* comment,
+                             uint8_t power,
+                             uint8_t height,
+                             uint8_t gain,
+                             uint8_t directivity) {
+    PositionReport report;
+    report.lat = lat;
+    report.lon = lon;
+    const uint8_t phg[4] = { power, height, gain, directivity };
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodePosition(report, comment, phg, frame);
+    return len > 0 && transmit(frame, len);
+}
+
+bool APRSClient::sendPosition(const PositionReport& report, const char* comment) {
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodePosition(report, comment, nullptr, frame);
+    return len > 0 && transmit(frame, len);
 }
 
 bool APRSClient::sendTelemetry(const TelemetryData& data, bool auto_increment) {
@@ -102,13 +224,7 @@ bool APRSClient::sendTelemetry(const TelemetryData& data, bool auto_increment) {
         _telemetry_seq = (_telemetry_seq + 1) % 1000;
     }
     
-    AX25Call src = makeCall(_config.callsign, _config.ssid);
-    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
-    AX25Call path[2]; size_t path_len;
-    buildPath(path, path_len);
-    
-    return _protocol.sendPacket(src, dst, path, path_len,
-                                reinterpret_cast<uint8_t*>(buffer), len);
+    return send(reinterpret_cast<uint8_t*>(buffer), len);
 }
 
 bool APRSClient::sendTelemetryDefinitions() {
@@ -117,15 +233,8 @@ bool APRSClient::sendTelemetryDefinitions() {
     size_t len_parm = TelemetryBuilder::buildStandardParmPacket(_config.callsign, _config.ssid, parm);
     size_t len_unit = TelemetryBuilder::buildStandardUnitPacket(_config.callsign, _config.ssid, unit);
     
-    AX25Call src = makeCall(_config.callsign, _config.ssid);
-    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
-    AX25Call path[2]; size_t path_len;
-    buildPath(path, path_len);
-    
-    bool ok1 = _protocol.sendPacket(src, dst, path, path_len,
-                                    reinterpret_cast<uint8_t*>(parm), len_parm);
-    bool ok2 = _protocol.sendPacket(src, dst, path, path_len,
-                                    reinterpret_cast<uint8_t*>(unit), len_unit);
+    bool ok1 = send(reinterpret_cast<uint8_t*>(parm), len_parm);
+    bool ok2 = send(reinterpret_cast<uint8_t*>(unit), len_unit);
     return ok1 && ok2;
 }
 
@@ -137,23 +246,112 @@ bool APRSClient::sendMessage(const char* message) {
     const uint8_t* payload = reinterpret_cast<const uint8_t*>(message);
     size_t length = strnlen(message, 255);
     
-    AX25Call src = makeCall(_config.callsign, _config.ssid);
-    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
-    AX25Call path[2]; size_t path_len;
-    buildPath(path, path_len);
-    
-    return _protocol.sendPacket(src, dst, path, path_len, payload, length);
+    return send(payload, length);
 }
 
 bool APRSClient::sendRawPacket(const uint8_t* payload, size_t length) {
     if (!payload || length == 0) return false;
     
-    AX25Call src = makeCall(_config.callsign, _config.ssid);
-    AX25Call dst = makeCall("APZMDR", 0);  // Open Source MDroid TOCALL
-    AX25Call path[2]; size_t path_len;
-    buildPath(path, path_len);
+    return send(payload, length);
+}
+
+// ============================================================================
+// Airtime estimates
+// ============================================================================
+
+uint32_t APRSClient::airtimeMs(const uint8_t* payload, size_t length) const {
+    if (!payload || length == 0) return 0;
+    
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encode(payload, length, frame);
+    return (len > 0) ? _protocol.frameAirtimeMs(frame, len) : 0;
+}
+
+uint32_t APRSClient::positionAirtimeMs(float lat, float lon,
+                                       const char* comment,
+                                       uint8_t power,
+                                       uint8_t height,
+                                       uint8_t gain,
+                                       uint8_t directivity) const {
+    PositionReport report;
+    report.lat = lat;
+    report.lon = lon;
+    const uint8_t phg[4] = { power, height, gain, directivity };
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodePosition(report, comment, phg, frame);
+    return (len > 0) ? _protocol.frameAirtimeMs(frame, len) : 0;
+}
+
+uint32_t APRSClient::positionAirtimeMs(const PositionReport& report, const char* comment) const {
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodePosition(report, comment, nullptr, frame);
+    return (len > 0) ? _protocol.frameAirtimeMs(frame, len) : 0;
+}
+
+// ============================================================================
+// Asynchronous API
+// ============================================================================
+
+bool APRSClient::startTxEngine(const TxEngineConfig& config) {
+    return _engine.begin(&_protocol, config);
+}
+
+bool APRSClient::startKiss(KissTransport* transport, const KissConfig& config) {
+    return _kiss.begin(transport, &_protocol, &_engine, config);
+}
+
+TxHandle APRSClient::queuePosition(float lat, float lon,
+                                   const char* comment,
+                                   uint8_t power,
+                                   uint8_t height,
+                                   uint8_t gain,
+                                   uint8_t directivity) {
+    PositionReport report;
+    report.lat = lat;
+    report.lon = lon;
+    const uint8_t phg[4] = { power, height, gain, directivity };
+    return enqueuePosition(report, comment, phg);
+}
+
+TxHandle APRSClient::queuePosition(const PositionReport& report, const char* comment) {
+    return enqueuePosition(report, comment, nullptr);
+}
+
+TxHandle APRSClient::queueTelemetry(const TelemetryData& data, bool auto_increment) {
+    char buffer[128];
+    size_t len = TelemetryBuilder::buildDataPacket(_telemetry_seq, data, buffer);
+    
+    TxHandle handle = enqueue(reinterpret_cast<uint8_t*>(buffer), len, KEY_TELEMETRY);
+    if (handle && auto_increment) {
+        _telemetry_seq = (_telemetry_seq + 1) % 1000;
+    }
+    return handle;
+}
+
+TxHandle APRSClient::queueTelemetryDefinitions() {
+    char parm[128];
+    char unit[128];
+    size_t len_parm = TelemetryBuilder::buildStandardParmPacket(_config.callsign, _config.ssid, parm);
+    size_t len_unit = TelemetryBuilder::buildStandardUnitPacket(_config.callsign, _config.ssid, unit);
+    
+    // Definitions only repeat what receivers already have: first to go
+    // under the duty-cycle limit
+    if (!enqueue(reinterpret_cast<uint8_t*>(parm), len_parm, KEY_TELEMETRY_PARM, TxPriority::Low)) {
+        return 0;
+    }
+    return enqueue(reinterpret_cast<uint8_t*>(unit), len_unit, KEY_TELEMETRY_UNIT, TxPriority::Low);
+}
+
+TxHandle APRSClient::queueMessage(const char* message, TxPriority priority) {
+    if (!message || !message[0]) return 0;
+    
+    return enqueue(reinterpret_cast<const uint8_t*>(message), strnlen(message, 255), 0, priority);
+}
+
+TxHandle APRSClient::queueRawPacket(const uint8_t* payload, size_t length, TxPriority priority) {
+    if (!payload || length == 0) return 0;
     
-    return _protocol.sendPacket(src, dst, path, path_len, payload, length);
+    return enqueue(payload, length, 0, priority);
 }
 
 } // namespace APRS
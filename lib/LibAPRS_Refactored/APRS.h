@@ -2,8 +2,14 @@
 #define APRS_H
 
 #include "APRS_Protocol.h"
+#include "APRS_AX25.h"
 #include "APRS_Position.h"
 #include "APRS_Telemetry.h"
+#include "APRS_TxEngine.h"
+#include "APRS_Receiver.h"
+#include "APRS_KISS.h"
+#include "APRS_SmartBeacon.h"
+#include "APRS_Scheduler.h"
 
 namespace APRS {
 
@@ -22,6 +28,17 @@ struct Config {
     uint16_t preamble_ms = 350;
     uint16_t tail_ms = 50;
     uint8_t ptt_pin = 33;  // GPIO pin number
+    bool ptt_active_high = false;   // PTT polarity (false: active low)
+    uint16_t ptt_lead_ms = PTT_LEAD_MS;  // PTT on to the first modulated sample
+    uint16_t ptt_tail_ms = PTT_TAIL_MS;  // Last modulated sample to PTT off
+    ModulatorMode modulator = ModulatorMode::Block;  // AFSK modulator
+    AudioSink* sink = nullptr;      // Audio output (nullptr: HAL DAC)
+    const ModemProfile* modem = nullptr;  // TX rate and tones (nullptr: Bell202)
+    FX25Mode fx25 = FX25Mode::Off;  // FX.25 forward error correction on transmit
+    Framing framing = Framing::Ax25;  // On-air framing (IL2P with APRS_IL2P)
+    bool render_cache = true;       // Replay the bitstream of repeated frames
+    PositionFormat position_format = PositionFormat::Uncompressed;  // Position report encoding
+    MicEMessage mic_e_message = MicEMessage::EnRoute;  // Status sent with Mic-E reports
 };
 
 /**
@@ -32,6 +49,11 @@ struct Config {
  * - Send telemetry with structured data
  * - Send custom messages
  * 
+ * send*() calls block until the packet has been transmitted. After
+ * startTxEngine() the queue*() calls return immediately with a handle and
+ * a dedicated TX task keys the radio in the background. Packets queued
+ * between beginBurst() and endBurst() share a single key-up.
+ * 
  * Example usage:
  * 
  *   APRS::APRSClient aprs;
@@ -57,6 +79,9 @@ public:
     /**
      * Send position report with automatic coordinate conversion
      * 
+     * PHG is sent in the uncompressed format only; compressed and Mic-E
+     * reports have no room for it.
+     * 
      * @param lat Latitude in decimal degrees
      * @param lon Longitude in decimal degrees
      * @param comment Optional comment (max 43 characters)
@@ -73,6 +98,20 @@ public:
                      uint8_t gain = 1,
                      uint8_t directivity = 0);
     
+    /**
+     * Send a position report with course/speed and altitude when known
+     * 
+     * Uncompressed: ccc/sss and /A= follow the symbol. Compressed: cs
+     * carries course/speed, or the altitude if there is no course/speed;
+     * /A= is added only when both are known. Mic-E: the latitude and
+     * message code go in the destination address instead of APZMDR, and
+     * the altitude follows the symbol.
+     * 
+     * @param comment Optional comment (max 60 characters)
+     * @return true on success
+     */
+    bool sendPosition(const PositionReport& report, const char* comment = nullptr);
+    
     /**
      * Send telemetry data
      * 
@@ -108,9 +147,175 @@ public:
     bool sendRawPacket(const uint8_t* payload, size_t length);
     
     /**
-     * Check if currently transmitting
+     * Airtime a packet with this payload would take in its own key-up,
+     * PTT on to PTT off, computed without rendering audio
+     * 
+     * Exact for the next key-up's timing, modem and framing: preamble,
+     * flags, bit stuffing of this payload (or the FX.25/IL2P size), tail
+     * and PTT delays. Cheap enough to call for every candidate packet.
+     * 
+     * @return Milliseconds, or 0 if the packet cannot be sent
+     */
+    uint32_t airtimeMs(const uint8_t* payload, size_t length) const;
+    
+    /**
+     * Airtime sendPosition() would take with these arguments
+     * @return Milliseconds, or 0 on invalid coordinates
+     */
+    uint32_t positionAirtimeMs(float lat, float lon,
+                               const char* comment = nullptr,
+                               uint8_t power = 1,
+                               uint8_t height = 1,
+                               uint8_t gain = 1,
+                               uint8_t directivity = 0) const;
+    
+    uint32_t positionAirtimeMs(const PositionReport& report, const char* comment = nullptr) const;
+    
+    // ------------------------------------------------------------------------
+    // Asynchronous API
+    // ------------------------------------------------------------------------
+    
+    /**
+     * Start the TX engine (call after begin())
+     * 
+     * With config.use_task the engine runs its own FreeRTOS task; otherwise
+     * (or on the native HAL) drain the queue with service().
+     * 
+     * @return true on success
+     */
+    bool startTxEngine(const TxEngineConfig& config = TxEngineConfig());
+    
+    /**
+     * Queue a position report (replaces an unsent queued position)
+     * @return Handle, or 0 if the report could not be queued
+     */
+    TxHandle queuePosition(float lat, float lon,
+                           const char* comment = nullptr,
+                           uint8_t power = 1,
+                           uint8_t height = 1,
+                           uint8_t gain = 1,
+                           uint8_t directivity = 0);
+    
+    TxHandle queuePosition(const PositionReport& report, const char* comment = nullptr);
+    
+    /**
+     * Queue telemetry data (replaces unsent queued telemetry)
+     * @return Handle, or 0 if the packet could not be queued
+     */
+    TxHandle queueTelemetry(const TelemetryData& data, bool auto_increment = true);
+    
+    /**
+     * Queue PARM and UNIT packets (each replaces its unsent predecessor)
+     * 
+     * They are TxPriority::Low: dropped rather than deferred when the
+     * duty-cycle limit is reached.
+     * 
+     * @return Handle of the UNIT packet, or 0 on failure
+     */
+    TxHandle queueTelemetryDefinitions();
+    
+    /**
+     * Queue a raw APRS message packet
+     * @param priority Treatment under the duty-cycle limit
+     * @return Handle, or 0 if the packet could not be queued
+     */
+    TxHandle queueMessage(const char* message, TxPriority priority = TxPriority::Normal);
+    
+    /**
+     * Queue a raw packet with custom payload
+     * @param priority Treatment under the duty-cycle limit
+     * @return Handle, or 0 if the packet could not be queued
+     */
+    TxHandle queueRawPacket(const uint8_t* payload, size_t length,
+                            TxPriority priority = TxPriority::Normal);
+    
+    /**
+     * Start a burst: packets queued until endBurst() are sent back to back
+     * in one key-up, paying the preamble and PTT delays once. Blocking
+     * send*() calls fail while a burst is open.
+     * 
+     * @return false if the TX engine is not started or a burst is open
+     */
+    bool beginBurst() { return _engine.beginBurst(); }
+    
+    /**
+     * Close the burst and hand it to the TX task
+     * @return false if no burst was open
+     */
+    bool endBurst() { return _engine.endBurst(); }
+    
+    /**
+     * Cumulative TX engine counters, including the airtime saved by bursts
+     */
+    TxEngineStats txEngineStats() const { return _engine.stats(); }
+    
+    /**
+     * Airtime ledger of the rolling duty-cycle window (PTT time, key-ups,
+     * frames and bits) and the configured limit
+     */
+    DutyCycleStatus dutyCycle() const { return _engine.dutyCycle(); }
+    
+    /**
+     * State of a queued packet
+     */
+    TxState txState(TxHandle handle) const { return _engine.state(handle); }
+    
+    /**
+     * Set the completion callback for queued packets
      */
-    bool isBusy() const { return _protocol.isBusy(); }
+    void onTxComplete(TxCallback callback, void* user = nullptr) { _engine.onComplete(callback, user); }
+    
+    /**
+     * Transmit the next queued packet on the calling task (no TX task)
+     * @return true if a packet was taken from the queue
+     */
+    bool service() { return _engine.service(); }
+    
+    /**
+     * Gate key-ups on a carrier sense (e.g. Receiver::isCarrierDetected())
+     */
+    void setCarrierSense(CarrierSense sense, void* user = nullptr) { _engine.setCarrierSense(sense, user); }
+    
+    // ------------------------------------------------------------------------
+    // KISS TNC
+    // ------------------------------------------------------------------------
+    
+    /**
+     * Start a KISS TNC on a host transport (call after startTxEngine())
+     * 
+     * Host data frames are queued alongside the tracker's own packets;
+     * TXDELAY/TXTAIL change the preamble and tail for every key-up.
+     * 
+     * @return true on success
+     */
+    bool startKiss(KissTransport* transport, const KissConfig& config = KissConfig());
+    
+    /**
+     * Pass a received frame (no FCS) to the KISS host
+     * @return false if KISS is not started or the write failed
+     */
+    bool kissForward(const uint8_t* frame, size_t len) { return _kiss.sendFrame(frame, len); }
+    
+    /**
+     * Decode one chunk of host bytes on the calling task (no KISS task)
+     * @return true if any bytes were processed
+     */
+    bool kissService() { return _kiss.service(); }
+    
+    /**
+     * True once startKiss() succeeded
+     */
+    bool kissStarted() const { return _kiss.isStarted(); }
+    
+    /**
+     * KISS frame and command counters
+     */
+    const KissStats& kissStats() const { return _kiss.stats(); }
+    
+    /**
+     * Check if currently transmitting or packets are queued
+     */
+    bool isBusy() const { return _protocol.isBusy() || _engine.pending() > 0; }
     
     /**
      * Get current telemetry sequence number
@@ -127,16 +332,92 @@ public:
      */
     void setPTT(bool enable) { _protocol.setPTT(enable); }
     
+    /**
+     * Statistics for the most recent key-up (airtime and airtime saved
+     * included)
+     */
+    const TxStats& lastTxStats() const { return _protocol.lastStats(); }
+    
+    /**
+     * Render cache counters: how often a repeated frame (e.g. a parked
+     * tracker's position) skipped encoding
+     */
+    const RenderCacheStats& renderCacheStats() const { return _protocol.renderCacheStats(); }
+    
+    /**
+     * Transmit modem in use (sample rate, baud and tones)
+     */
+    const ModemProfile& modem() const { return _protocol.modem(); }
+    
+    /**
+     * Switch the transmit modem, e.g. &Hf300::PROFILE for HF APRS or
+     * &Bell202::PROFILE for VHF (nullptr: Bell202). Takes effect from the
+     * next key-up; packets already queued go out with the new modem.
+     */
+    void setModem(const ModemProfile* modem) { _protocol.setModem(modem); }
+    
+    /**
+     * Switch FX.25 forward error correction (FX25Mode::Off: plain AX.25)
+     * from the next key-up
+     */
+    void setFx25(FX25Mode mode) { _protocol.setFx25(mode); }
+    
+    /**
+     * Switch on-air framing (Framing::Il2p for IL2P peers, APRS_IL2P
+     * builds only) from the next key-up
+     */
+    void setFraming(Framing framing) { _protocol.setFraming(framing); }
+    
+    /**
+     * Status for the next Mic-E reports (e.g. MicEMessage::Emergency)
+     */
+    void setMicEMessage(MicEMessage message) { _config.mic_e_message = message; }
+    
 private:
+    // Coalesce keys: a newer queued packet of the same kind replaces an unsent one
+    static const uint8_t KEY_POSITION = 1;
+    static const uint8_t KEY_TELEMETRY = 2;
+    static const uint8_t KEY_TELEMETRY_PARM = 3;
+    static const uint8_t KEY_TELEMETRY_UNIT = 4;
+    
     Config _config;
     Protocol _protocol;
+    TxEngine _engine;
+    KissTnc _kiss;
+    AX25HeaderCache _header;    // Source, APZMDR and path, built by begin()
     uint16_t _telemetry_seq;
     
+    // Build position payload (PHG codes or nullptr) and, for Mic-E, the
+    // destination callsign; returns 0 on invalid coordinates
+    size_t buildPositionPayload(const PositionReport& report, const char* comment,
+                                const uint8_t* phg, char* payload, char* dest) const;
+    
+    // Encode payload behind the cached header, returns 0 on failure
+    size_t encode(const uint8_t* payload, size_t length, uint8_t* frame) const;
+    
+    // Encode a position frame, returns 0 on invalid coordinates
+    size_t encodePosition(const PositionReport& report, const char* comment,
+                          const uint8_t* phg, uint8_t* frame) const;
+    
+    // Transmit payload, blocking until done
+    bool send(const uint8_t* payload, size_t length);
+    
+    // Transmit an encoded frame, blocking until done
+    bool transmit(const uint8_t* frame, size_t len);
+    
+    // Queue payload on the TX engine
+    TxHandle enqueue(const uint8_t* payload, size_t length, uint8_t key,
+                     TxPriority priority = TxPriority::Normal);
+    
+    // Queue a position frame on the TX engine
+    TxHandle enqueuePosition(const PositionReport& report, const char* comment,
+                             const uint8_t* phg);
+    
     // Build path array from config
     void buildPath(AX25Call* path, size_t& path_len);
     
     // Create AX25Call from string
-    AX25Call makeCall(const char* callsign, uint8_t ssid);
+    static AX25Call makeCall(const char* callsign, uint8_t ssid);
 };
 
 } // namespace APRS
@@ -0,0 +1,302 @@
+#include "APRS_AX25.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// Address View
+// ============================================================================
+size_t AX25AddressView::callsign(char out[7]) const {
+    size_t len = 0;
+    while (len < 6 && (_raw[len] >> 1) != ' ') {
+        out[len] = (char)(_raw[len] >> 1);
+        len++;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+bool AX25AddressView::equals(const char* call, uint8_t ssid) const {
+    if (this->ssid() != ssid) {
+        return false;
+    }
+    size_t i = 0;
+    for (; i < 6 && call[i] != '\0'; i++) {
+        if ((_raw[i] >> 1) != (uint8_t)call[i]) {
+            return false;
+        }
+    }
+    if (call[i] != '\0') {
+        return false;   // Longer than 6 characters
+    }
+    for (; i < 6; i++) {
+        if ((_raw[i] >> 1) != ' ') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Frame View
+// ============================================================================
+AX25FrameView::AX25FrameView()
+    : _frame(nullptr), _len(0), _pathLen(0), _controlOffset(0),
+      _infoOffset(0), _hasPid(false) {
+}
+
+bool AX25FrameView::parse(const uint8_t* frame, size_t len) {
+    _frame = nullptr;
+    if (!frame || len < 2 * AX25_ADDR_LEN + 1) {
+        return false;
+    }
+
+    // Walk the address field to the extension bit
+    size_t addresses = 0;
+    size_t offset = 0;
+    for (;;) {
+        if (offset + AX25_ADDR_LEN > len || addresses == 2 + AX25_MAX_PATH) {
+            return false;
+        }
+        addresses++;
+        offset += AX25_ADDR_LEN;
+        if (frame[offset - 1] & AX25_SSID_LAST) {
+            break;
+        }
+    }
+    if (addresses < 2 || offset >= len) {
+        return false;   // No room for control
+    }
+
+    uint8_t control = frame[offset];
+    bool has_pid = ((control & 0x01) == 0) || ((control & 0xEF) == AX25_CTRL_UI);
+    size_t info = offset + 1 + (has_pid ? 1 : 0);
+    if (info > len) {
+        return false;
+    }
+
+    _frame = frame;
+    _len = len;
+    _pathLen = (uint8_t)(addresses - 2);
+    _controlOffset = (uint16_t)offset;
+    _infoOffset = (uint16_t)info;
+    _hasPid = has_pid;
+    return true;
+}
+
+size_t AX25FrameView::format(char* out, size_t capacity) const {
+    if (capacity == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    if (!_frame) {
+        return 0;
+    }
+
+    // Source, destination, then the digipeater path
+    size_t pos = 0;
+    for (size_t n = 0; n < 2 + pathLength(); n++) {
+        AX25AddressView a = (n == 0) ? source() : (n == 1) ? destination() : path(n - 2);
+        char call[7];
+        a.callsign(call);
+
+        const char* sep = (n == 0) ? "" : (n == 1) ? ">" : ",";
+        const char* used = (n >= 2 && a.isRepeated()) ? "*" : "";
+        int w = a.ssid() ? snprintf(out + pos, capacity - pos, "%s%s-%u%s", sep, call, a.ssid(), used)
+                         : snprintf(out + pos, capacity - pos, "%s%s%s", sep, call, used);
+        if (w < 0 || (size_t)w >= capacity - pos) {
+            out[0] = '\0';
+            return 0;
+        }
+        pos += w;
+    }
+
+    if (pos + 1 < capacity) {
+        out[pos++] = ':';
+    }
+    const uint8_t* data = info();
+    for (size_t i = 0; i < infoLength() && pos + 1 < capacity; i++) {
+        char ch = (char)data[i];
+        out[pos++] = (ch >= 0x20 && ch < 0x7F) ? ch : '.';
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+// ============================================================================
+// Frame Builder
+// ============================================================================
+AX25FrameBuilder::AX25FrameBuilder(uint8_t* out, size_t capacity)
+    : _out(out), _capacity(out ? capacity : 0), _len(0), _addresses(0),
+      _header(false), _failed(false) {
+}
+
+bool AX25FrameBuilder::reserve(size_t bytes) {
+    if (_failed || _len + bytes > _capacity) {
+        _failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool AX25FrameBuilder::addAddress(const AX25Call& call, bool repeated) {
+    if (_header || _addresses == 2 + AX25_MAX_PATH) {
+        _failed = true;
+    }
+    if (!reserve(AX25_ADDR_LEN)) {
+        return false;
+    }
+
+    // 6-character call (pad with spaces), shifted left one bit
+    uint8_t* a = &_out[_len];
+    size_t len = strnlen(call.call, 6);
+    for (size_t i = 0; i < 6; i++) {
+        char c = (i < len) ? toupper(call.call[i]) : ' ';
+        a[i] = (uint8_t)(c << 1);
+    }
+
+    // SSID byte; the extension bit is set by addHeader()
+    a[6] = 0x60 | ((call.ssid & 0x0F) << 1) | (repeated ? AX25_SSID_H : 0);
+    _len += AX25_ADDR_LEN;
+    _addresses++;
+    return true;
+}
+
+bool AX25FrameBuilder::addAddress(const AX25AddressView& address) {
+    if (_header || _addresses == 2 + AX25_MAX_PATH || !address.isValid()) {
+        _failed = true;
+    }
+    if (!reserve(AX25_ADDR_LEN)) {
+        return false;
+    }
+    memcpy(&_out[_len], address.raw(), AX25_ADDR_LEN);
+    _out[_len + 6] &= ~AX25_SSID_LAST;
+    _len += AX25_ADDR_LEN;
+    _addresses++;
+    return true;
+}
+
+bool AX25FrameBuilder::addHeader(uint8_t control, uint8_t pid) {
+    if (_header || _addresses < 2) {
+        _failed = true;
+    }
+    if (!reserve(2)) {
+        return false;
+    }
+    _out[_len - 1] |= AX25_SSID_LAST;
+    _out[_len++] = control;
+    _out[_len++] = pid;
+    _header = true;
+    return true;
+}
+
+bool AX25FrameBuilder::addInfo(const uint8_t* data, size_t len) {
+    if (!_header || (len > 0 && !data)) {
+        _failed = true;
+    }
+    if (!reserve(len)) {
+        return false;
+    }
+    if (len > 0) {
+        memcpy(&_out[_len], data, len);
+        _len += len;
+    }
+    return true;
+}
+
+size_t AX25FrameBuilder::finish() {
+    if (!_header) {
+        _failed = true;
+    }
+    if (!reserve(2)) {
+        return 0;
+    }
+    _len = appendFcs(_out, _len, _capacity);
+    return _len;
+}
+
+size_t AX25FrameBuilder::appendFcs(uint8_t* frame, size_t len, size_t capacity) {
+    if (!frame || len + 2 > capacity) {
+        return 0;
+    }
+
+    // FCS (CRC) - inverted, low byte first
+    uint16_t fcs = Crc16::compute(frame, len);
+    frame[len++] = fcs & 0xFF;
+    frame[len++] = fcs >> 8;
+    return len;
+}
+
+// ============================================================================
+// Header Cache
+// ============================================================================
+AX25HeaderCache::AX25HeaderCache() : _len(0), _crc(AX25_CRC_INIT) {
+}
+
+bool AX25HeaderCache::build(const AX25Call& src, const AX25Call& dst,
+                            const AX25Call* path, size_t path_len) {
+    _len = 0;
+    if (path_len > AX25_MAX_PATH) {
+        return false;
+    }
+
+    AX25FrameBuilder header(_data, sizeof(_data));
+    header.addAddress(dst);
+    header.addAddress(src);
+    for (size_t i = 0; i < path_len; i++) {
+        header.addAddress(path[i]);
+    }
+    if (!header.addHeader(AX25_CTRL_UI, AX25_PID_NOLAYER3)) {
+        return false;
+    }
+
+    _crc = Crc16::updateBlock(_data, header.length(), AX25_CRC_INIT);
+    _len = header.length();
+    return true;
+}
+
+size_t AX25HeaderCache::encode(const uint8_t* info, size_t info_len, uint8_t* out,
+                               size_t capacity) const {
+    if (_len == 0 || !out || (info_len > 0 && !info) || info_len > AX25_MAX_INFO_LEN ||
+        _len + info_len + 2 > capacity) {
+        return 0;
+    }
+
+    memcpy(out, _data, _len);
+    size_t len = _len;
+    if (info_len > 0) {
+        memcpy(out + len, info, info_len);
+        len += info_len;
+    }
+
+    // FCS (CRC) - inverted, low byte first
+    Crc16 crc;
+    crc.resume(_crc);
+    crc.update(info, info_len);
+    out[len++] = crc.fcs() & 0xFF;
+    out[len++] = crc.fcs() >> 8;
+    return len;
+}
+
+size_t AX25HeaderCache::encode(const AX25Call& dst, const uint8_t* info, size_t info_len,
+                               uint8_t* out, size_t capacity) const {
+    if (_len == 0 || !out || (info_len > 0 && !info) || info_len > AX25_MAX_INFO_LEN ||
+        _len + info_len + 2 > capacity) {
+        return 0;
+    }
+
+    // The destination is the first address and never the last one
+    AX25FrameBuilder frame(out, capacity);
+    frame.addAddress(dst);
+    memcpy(out + AX25_ADDR_LEN, _data + AX25_ADDR_LEN, _len - AX25_ADDR_LEN);
+    size_t len = _len;
+    if (info_len > 0) {
+        memcpy(out + len, info, info_len);
+        len += info_len;
+    }
+    return AX25FrameBuilder::appendFcs(out, len, capacity);
+}
+
+} // namespace APRS
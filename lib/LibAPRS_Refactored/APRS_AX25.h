@@ -0,0 +1,247 @@
+#ifndef APRS_AX25_H
+#define APRS_AX25_H
+
+#include "APRS_Protocol.h"
+
+namespace APRS {
+
+// ============================================================================
+// AX.25 Address Field Constants
+// ============================================================================
+#define AX25_ADDR_LEN       7       // 6 shifted chars + SSID byte
+#define AX25_SSID_LAST      0x01    // Address extension bit: last address
+#define AX25_SSID_H         0x80    // Has-been-repeated bit (path entries)
+
+// ============================================================================
+// Address View
+// ============================================================================
+
+/**
+ * One 7-byte address inside a frame buffer (not copied)
+ */
+class AX25AddressView {
+public:
+    AX25AddressView() : _raw(nullptr) {}
+    explicit AX25AddressView(const uint8_t* raw) : _raw(raw) {}
+
+    bool isValid() const { return _raw != nullptr; }
+
+    /**
+     * Callsign without padding
+     * @param out Receives up to 6 characters plus terminator
+     * @return Callsign length
+     */
+    size_t callsign(char out[7]) const;
+
+    uint8_t ssid() const { return (_raw[6] >> 1) & 0x0F; }
+
+    /**
+     * H bit: a digipeater has repeated the frame through this entry
+     */
+    bool isRepeated() const { return (_raw[6] & AX25_SSID_H) != 0; }
+
+    /**
+     * Compare with a callsign and SSID (case sensitive, as on air)
+     */
+    bool equals(const char* call, uint8_t ssid) const;
+
+    /**
+     * Raw address bytes
+     */
+    const uint8_t* raw() const { return _raw; }
+
+private:
+    const uint8_t* _raw;
+};
+
+// ============================================================================
+// Frame View
+// ============================================================================
+
+/**
+ * Zero-copy view of an AX.25 frame (first address through the information
+ * field, no FCS), e.g. as delivered by the Demodulator.
+ *
+ * parse() only validates the address field and locates control, PID and
+ * info; every accessor reads the caller's buffer, which must outlive the
+ * view.
+ */
+class AX25FrameView {
+public:
+    AX25FrameView();
+
+    /**
+     * Parse a frame in place
+     * @return false if the address field or header is malformed
+     */
+    bool parse(const uint8_t* frame, size_t len);
+
+    AX25AddressView destination() const { return AX25AddressView(_frame); }
+    AX25AddressView source() const { return AX25AddressView(_frame + AX25_ADDR_LEN); }
+
+    /**
+     * Number of digipeater addresses (0 to AX25_MAX_PATH)
+     */
+    size_t pathLength() const { return _pathLen; }
+
+    AX25AddressView path(size_t index) const {
+        return AX25AddressView(_frame + AX25_ADDR_LEN * (2 + index));
+    }
+
+    uint8_t control() const { return _frame[_controlOffset]; }
+
+    /**
+     * True for UI and I frames, which carry a PID byte
+     */
+    bool hasPid() const { return _hasPid; }
+    uint8_t pid() const { return _hasPid ? _frame[_controlOffset + 1] : 0; }
+
+    /**
+     * True for an unnumbered information frame (poll/final bit ignored)
+     */
+    bool isUI() const { return (control() & 0xEF) == AX25_CTRL_UI; }
+
+    const uint8_t* info() const { return _frame + _infoOffset; }
+    size_t infoLength() const { return _len - _infoOffset; }
+
+    const uint8_t* data() const { return _frame; }
+    size_t length() const { return _len; }
+
+    /**
+     * Format in TNC2 monitor style ("SRC>DST,PATH*:info"), with
+     * non-printable info bytes as '.'
+     *
+     * @param out Output buffer, always terminated
+     * @param capacity Output buffer size
+     * @return String length, or 0 if the frame is not parsed or does not fit
+     */
+    size_t format(char* out, size_t capacity) const;
+
+private:
+    const uint8_t* _frame;
+    size_t _len;
+    uint8_t _pathLen;
+    uint16_t _controlOffset;
+    uint16_t _infoOffset;
+    bool _hasPid;
+};
+
+// ============================================================================
+// Frame Builder
+// ============================================================================
+
+/**
+ * Writes an AX.25 frame into caller-provided storage
+ *
+ * Call addAddress() for the destination, the source and each path entry,
+ * then addHeader(), addInfo() and finish(). Any step that does not fit
+ * fails and makes finish() return 0.
+ */
+class AX25FrameBuilder {
+public:
+    AX25FrameBuilder(uint8_t* out, size_t capacity);
+
+    /**
+     * Append an address (destination, source, then path)
+     * @param repeated Set the H bit (path entries only)
+     */
+    bool addAddress(const AX25Call& call, bool repeated = false);
+
+    /**
+     * Append a parsed address unchanged (e.g. when digipeating)
+     */
+    bool addAddress(const AX25AddressView& address);
+
+    /**
+     * Close the address field and append control and PID
+     */
+    bool addHeader(uint8_t control = AX25_CTRL_UI, uint8_t pid = AX25_PID_NOLAYER3);
+
+    bool addInfo(const uint8_t* data, size_t len);
+
+    /**
+     * Append the FCS
+     * @return Frame length including FCS, or 0 if any step failed
+     */
+    size_t finish();
+
+    /**
+     * Bytes written so far (no FCS until finish())
+     */
+    size_t length() const { return _len; }
+
+    /**
+     * Append the FCS to a complete frame in place (e.g. from KISS)
+     * @return Frame length including FCS, or 0 if it does not fit
+     */
+    static size_t appendFcs(uint8_t* frame, size_t len, size_t capacity);
+
+private:
+    uint8_t* _out;
+    size_t _capacity;
+    size_t _len;
+    uint8_t _addresses;
+    bool _header;
+    bool _failed;
+
+    bool reserve(size_t bytes);
+};
+
+// ============================================================================
+// Header Cache
+// ============================================================================
+
+/**
+ * Address field, control and PID encoded once, with the CRC register
+ * value after them
+ *
+ * For a station that always sends from the same source through the same
+ * path: encode() copies the header and only runs the CRC over the
+ * information field.
+ */
+class AX25HeaderCache {
+public:
+    AX25HeaderCache();
+
+    /**
+     * Encode the header of a UI frame
+     * @return false if the path is too long
+     */
+    bool build(const AX25Call& src, const AX25Call& dst,
+               const AX25Call* path, size_t path_len);
+
+    bool isValid() const { return _len > 0; }
+
+    /**
+     * Encoded header (addresses, control, PID)
+     */
+    const uint8_t* data() const { return _data; }
+    size_t length() const { return _len; }
+
+    /**
+     * Write header, information field and FCS
+     *
+     * @param info Information field
+     * @param info_len Information field length (up to AX25_MAX_INFO_LEN)
+     * @param out Frame buffer
+     * @param capacity Frame buffer size (AX25_MAX_FRAME_LEN always fits)
+     * @return Frame length including FCS, or 0 if it does not fit
+     */
+    size_t encode(const uint8_t* info, size_t info_len, uint8_t* out, size_t capacity) const;
+
+    /**
+     * Same, to another destination (e.g. a Mic-E latitude); the CRC then
+     * runs over the whole frame
+     */
+    size_t encode(const AX25Call& dst, const uint8_t* info, size_t info_len, uint8_t* out,
+                  size_t capacity) const;
+
+private:
+    uint8_t _data[AX25_ADDR_LEN * (2 + AX25_MAX_PATH) + 2];
+    size_t _len;
+    uint16_t _crc;                  // CRC register after the header
+};
+
+} // namespace APRS
+
+#endif // APRS_AX25_H
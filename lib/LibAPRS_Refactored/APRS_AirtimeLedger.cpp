@@ -0,0 +1,90 @@
+#include "APRS_AirtimeLedger.h"
+
+namespace APRS {
+
+AirtimeLedger::AirtimeLedger() : _buckets(), _windowMs(0), _bucketMs(1) {}
+
+void AirtimeLedger::begin(uint32_t window_ms) {
+    // N buckets must span the window plus the bucket still filling
+    const uint32_t spans = AIRTIME_LEDGER_BUCKETS - 1;
+    _windowMs = window_ms;
+    _bucketMs = (window_ms + spans - 1) / spans;
+    if (_bucketMs == 0) {
+        _bucketMs = 1;
+    }
+    for (size_t i = 0; i < AIRTIME_LEDGER_BUCKETS; i++) {
+        _buckets[i] = Bucket();
+    }
+}
+
+// A bucket counts until its last millisecond is a window old
+bool AirtimeLedger::live(const Bucket& b, uint32_t now) const {
+    return b.totals.keyups > 0 && now - b.start < _windowMs + _bucketMs;
+}
+
+// ============================================================================
+// Booking
+// ============================================================================
+void AirtimeLedger::record(uint32_t now, uint32_t airtime_ms, uint32_t frames, uint32_t bits) {
+    uint32_t start = now - now % _bucketMs;
+    Bucket& b = _buckets[(now / _bucketMs) % AIRTIME_LEDGER_BUCKETS];
+    if (b.start != start || !live(b, now)) {
+        b.start = start;
+        b.totals = AirtimeTotals();
+    }
+    b.totals.airtime_ms += airtime_ms;
+    b.totals.keyups++;
+    b.totals.frames += frames;
+    b.totals.bits += bits;
+}
+
+AirtimeTotals AirtimeLedger::totals(uint32_t now) const {
+    AirtimeTotals sum;
+    for (size_t i = 0; i < AIRTIME_LEDGER_BUCKETS; i++) {
+        const Bucket& b = _buckets[i];
+        if (live(b, now)) {
+            sum.airtime_ms += b.totals.airtime_ms;
+            sum.keyups += b.totals.keyups;
+            sum.frames += b.totals.frames;
+            sum.bits += b.totals.bits;
+        }
+    }
+    return sum;
+}
+
+// ============================================================================
+// Budget
+// ============================================================================
+uint32_t AirtimeLedger::waitMs(uint32_t now, uint32_t airtime_ms, uint32_t budget_ms) const {
+    if (airtime_ms > budget_ms) {
+        return UINT32_MAX;
+    }
+    uint32_t used = totals(now).airtime_ms;
+    if (used + airtime_ms <= budget_ms) {
+        return 0;
+    }
+
+    // Let the oldest buckets expire until the key-up fits
+    bool gone[AIRTIME_LEDGER_BUCKETS] = { false };
+    for (;;) {
+        const Bucket* oldest = nullptr;
+        size_t index = 0;
+        for (size_t i = 0; i < AIRTIME_LEDGER_BUCKETS; i++) {
+            const Bucket& b = _buckets[i];
+            if (!gone[i] && live(b, now) && (!oldest || now - b.start > now - oldest->start)) {
+                oldest = &b;
+                index = i;
+            }
+        }
+        if (!oldest) {
+            return 0;
+        }
+        gone[index] = true;
+        used -= oldest->totals.airtime_ms;
+        if (used + airtime_ms <= budget_ms) {
+            return oldest->start + _windowMs + _bucketMs - now;
+        }
+    }
+}
+
+} // namespace APRS
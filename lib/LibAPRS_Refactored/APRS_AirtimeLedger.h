@@ -0,0 +1,82 @@
+#ifndef APRS_AIRTIME_LEDGER_H
+#define APRS_AIRTIME_LEDGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// Airtime Ledger Constants
+// ============================================================================
+#define AIRTIME_LEDGER_BUCKETS  13      // Window / 12 per bucket, plus the one filling
+
+/**
+ * Transmit totals within the rolling window
+ */
+struct AirtimeTotals {
+    uint32_t airtime_ms = 0;    // PTT-on time
+    uint32_t keyups = 0;
+    uint32_t frames = 0;
+    uint32_t bits = 0;          // On-air bits incl. preamble, flags and stuffing
+};
+
+// ============================================================================
+// Rolling Airtime Ledger
+// ============================================================================
+
+/**
+ * Key-ups of the last window, kept in AIRTIME_LEDGER_BUCKETS time buckets
+ *
+ * Each key-up is booked into the bucket of its end time. A bucket counts
+ * until the whole of it has left the window, so totals can run up to one
+ * bucket long but never short: a limit enforced on them holds over every
+ * window-long span. Times are HAL::millis() values; wrap-around is handled
+ * by unsigned differences.
+ */
+class AirtimeLedger {
+public:
+    AirtimeLedger();
+
+    /**
+     * Empty the ledger and set its window
+     * @param window_ms Window length (at least one ms per bucket)
+     */
+    void begin(uint32_t window_ms);
+
+    /**
+     * Book a key-up that ended at now
+     */
+    void record(uint32_t now, uint32_t airtime_ms, uint32_t frames, uint32_t bits);
+
+    /**
+     * Totals of the key-ups still in the window at now
+     */
+    AirtimeTotals totals(uint32_t now) const;
+
+    /**
+     * How long a key-up of airtime_ms has to wait until the window holds
+     * no more than budget_ms including it
+     *
+     * @return 0 if it fits now, UINT32_MAX if it never fits the budget
+     */
+    uint32_t waitMs(uint32_t now, uint32_t airtime_ms, uint32_t budget_ms) const;
+
+    uint32_t windowMs() const { return _windowMs; }
+
+private:
+    struct Bucket {
+        uint32_t start;         // millis() at the start of the bucket
+        AirtimeTotals totals;
+    };
+
+    Bucket _buckets[AIRTIME_LEDGER_BUCKETS];
+    uint32_t _windowMs;
+    uint32_t _bucketMs;
+
+    bool live(const Bucket& b, uint32_t now) const;
+};
+
+} // namespace APRS
+
+#endif // APRS_AIRTIME_LEDGER_H
@@ -0,0 +1,120 @@
+#include "APRS_AudioSink.h"
+#include "APRS_HAL.h"
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// Audio Sink
+// ============================================================================
+void AudioSink::pttWrite(uint8_t pin, bool level) {
+    HAL::pttWrite(pin, level);
+}
+
+// ============================================================================
+// HAL DAC Sink
+// ============================================================================
+bool HalDacSink::begin(uint32_t sample_rate) {
+    return HAL::audioBegin(sample_rate);
+}
+
+size_t HalDacSink::write(const void* samples, size_t count) {
+    return HAL::audioWrite(static_cast<const uint16_t*>(samples), count);
+}
+
+void HalDacSink::txBegin() {
+    HAL::audioTxBegin();
+}
+
+void HalDacSink::txEnd() {
+    HAL::audioTxEnd();
+}
+
+void HalDacSink::pttWrite(uint8_t pin, bool level) {
+    HAL::audioPttWrite(pin, level);
+}
+
+void HalDacSink::drain() {
+    HAL::audioDrain();
+}
+
+// ============================================================================
+// File Sink
+// ============================================================================
+static void putLE(uint8_t* p, uint32_t v, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void wavHeader(uint8_t h[44], uint32_t rate, uint32_t samples) {
+    memcpy(h, "RIFF", 4);
+    putLE(h + 4, 36 + samples, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    putLE(h + 16, 16, 4);           // fmt chunk size
+    putLE(h + 20, 1, 2);            // PCM
+    putLE(h + 22, 1, 2);            // Mono
+    putLE(h + 24, rate, 4);
+    putLE(h + 28, rate, 4);         // Byte rate
+    putLE(h + 32, 1, 2);            // Block align
+    putLE(h + 34, 8, 2);            // Bits per sample
+    memcpy(h + 36, "data", 4);
+    putLE(h + 40, samples, 4);
+}
+
+FileSink::FileSink(const char* path, bool wav)
+    : _path(path), _wav(wav), _file(nullptr), _rate(0), _samples(0), _error(false) {
+}
+
+FileSink::~FileSink() {
+    close();
+}
+
+bool FileSink::begin(uint32_t sample_rate) {
+    close();
+    _file = fopen(_path, "wb");
+    if (!_file) {
+        return false;
+    }
+    _rate = sample_rate;
+    _samples = 0;
+    _error = false;
+    if (_wav) {
+        uint8_t header[44];
+        wavHeader(header, _rate, 0);
+        _error = fwrite(header, 1, sizeof(header), _file) != sizeof(header);
+    }
+    return !_error;
+}
+
+size_t FileSink::write(const void* samples, size_t count) {
+    if (!_file) {
+        return 0;
+    }
+    size_t n = fwrite(samples, 1, count, _file);
+    if (n != count) {
+        _error = true;
+    }
+    _samples += n;
+    return n;
+}
+
+bool FileSink::close() {
+    if (!_file) {
+        return !_error;
+    }
+    if (_wav) {
+        uint8_t header[44];
+        wavHeader(header, _rate, _samples);
+        if (fseek(_file, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), _file) != sizeof(header)) {
+            _error = true;
+        }
+    }
+    if (fclose(_file) != 0) {
+        _error = true;
+    }
+    _file = nullptr;
+    return !_error;
+}
+
+} // namespace APRS
@@ -0,0 +1,195 @@
+#ifndef APRS_AUDIO_SINK_H
+#define APRS_AUDIO_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace APRS {
+
+// ============================================================================
+// Sample Formats
+// ============================================================================
+enum class SampleFormat : uint8_t {
+    U8,         // Unsigned 8-bit, 0x80 = silence (8-bit PCM, sigma-delta duty)
+    U8Msb16     // 16-bit words, 8-bit value in the high byte (ESP32 I2S DAC)
+};
+
+inline size_t sampleBytes(SampleFormat format) {
+    return (format == SampleFormat::U8) ? 1 : 2;
+}
+
+// ============================================================================
+// Audio Sink Interface
+// ============================================================================
+
+/**
+ * Destination for modulated audio
+ *
+ * The modulator renders straight into format(), so a sink never converts
+ * per sample. write() blocks until the samples are queued; txBegin() and
+ * txEnd() bracket each key-up. A sink that queues audio ahead of its
+ * output switches PTT from pttWrite() in step with the samples and waits
+ * for them in drain(); the defaults suit sinks without output latency.
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    /**
+     * Prepare the output for the modulator's sample rate
+     * @return true on success
+     */
+    virtual bool begin(uint32_t sample_rate) = 0;
+
+    /**
+     * Native sample format; fixed once begin() succeeded
+     */
+    virtual SampleFormat format() const = 0;
+
+    /**
+     * Write samples in format()
+     * @return Samples written
+     */
+    virtual size_t write(const void* samples, size_t count) = 0;
+
+    virtual void txBegin() {}
+    virtual void txEnd() {}
+
+    /**
+     * Drive a PTT pin to a raw level as the next sample written starts to
+     * play (the default switches at once)
+     */
+    virtual void pttWrite(uint8_t pin, bool level);
+
+    /**
+     * Block until every sample written has played (and a pending
+     * pttWrite() edge has been applied)
+     */
+    virtual void drain() {}
+};
+
+// ============================================================================
+// HAL DAC Sink
+// ============================================================================
+
+/**
+ * The HAL audio output: the I2S0 built-in DAC on GPIO25 on the ESP32
+ * (half duplex with the ADC receiver), the sample capture on the native
+ * HAL. This is the default sink.
+ */
+class HalDacSink : public AudioSink {
+public:
+    bool begin(uint32_t sample_rate) override;
+    SampleFormat format() const override { return SampleFormat::U8Msb16; }
+    size_t write(const void* samples, size_t count) override;
+    void txBegin() override;
+    void txEnd() override;
+    void pttWrite(uint8_t pin, bool level) override;
+    void drain() override;
+};
+
+// ============================================================================
+// File Sink
+// ============================================================================
+
+/**
+ * Streams audio to an 8-bit mono PCM WAV or raw file (host runs, or a
+ * mounted filesystem on the ESP32)
+ *
+ * The WAV header is written by begin() and its sizes are filled in by
+ * close() (also called by the destructor).
+ */
+class FileSink : public AudioSink {
+public:
+    /**
+     * @param path Output file (opened by begin())
+     * @param wav true: WAV container, false: raw samples
+     */
+    FileSink(const char* path, bool wav = true);
+    ~FileSink();
+
+    bool begin(uint32_t sample_rate) override;
+    SampleFormat format() const override { return SampleFormat::U8; }
+    size_t write(const void* samples, size_t count) override;
+
+    /**
+     * Finish the header and close the file
+     * @return false if any write failed
+     */
+    bool close();
+
+    /**
+     * Samples written since begin()
+     */
+    uint32_t samples() const { return _samples; }
+
+private:
+    const char* _path;
+    bool _wav;
+    FILE* _file;
+    uint32_t _rate;
+    uint32_t _samples;
+    bool _error;
+};
+
+#ifndef APRS_HAL_NATIVE
+// ============================================================================
+// Sigma-Delta Sink (ESP32)
+// ============================================================================
+
+/**
+ * Audio on any GPIO through the ESP32 sigma-delta modulator, for boards
+ * where GPIO25 (the DAC) is taken
+ *
+ * A hardware timer loads one sample per period into the sigma-delta duty
+ * register, so the modulator output is decimated to update_rate (13.2 kHz
+ * keeps six updates per 2200 Hz cycle). Needs an RC low-pass on the pin
+ * (e.g. 1 kOhm / 47 nF, ~3.4 kHz). I2S0 stays free, so the receiver keeps
+ * capturing while this sink transmits. PTT edges are switched by the same
+ * ISR, on the update that loads their sample.
+ */
+class SigmaDeltaSink : public AudioSink {
+public:
+    /**
+     * @param pin Output GPIO
+     * @param channel Sigma-delta channel (0-7)
+     * @param update_rate Duty updates per second (must divide the
+     *                    modulator sample rate)
+     */
+    SigmaDeltaSink(uint8_t pin, uint8_t channel = 0, uint32_t update_rate = 13200);
+
+    bool begin(uint32_t sample_rate) override;
+    SampleFormat format() const override { return SampleFormat::U8; }
+    size_t write(const void* samples, size_t count) override;
+    void txBegin() override;
+    void txEnd() override;
+    void pttWrite(uint8_t pin, bool level) override;
+    void drain() override;
+
+private:
+    static const size_t RING_SIZE = 1024;   // ~78 ms at 13.2 kHz
+
+    uint8_t _pin;
+    uint8_t _channel;
+    uint32_t _updateRate;
+    uint32_t _decimation;
+    uint32_t _phase;                // Input samples to skip before the next keep
+    uint8_t _ring[RING_SIZE];
+    volatile size_t _head;          // Written by write()
+    volatile size_t _tail;          // Advanced by the timer ISR
+    volatile uint32_t _written;     // Samples kept since txBegin()
+    volatile uint32_t _played;      // Samples loaded by the timer ISR
+    volatile bool _edgePending;     // PTT edge due at sample _edgeAt
+    volatile uint32_t _edgeAt;
+    volatile uint8_t _edgePin;
+    volatile bool _edgeLevel;
+    bool _started;
+
+    static bool onTimer(void* arg);
+};
+#endif
+
+} // namespace APRS
+
+#endif // APRS_AUDIO_SINK_H
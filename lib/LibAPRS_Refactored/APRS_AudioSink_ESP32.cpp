@@ -0,0 +1,139 @@
+#ifndef APRS_HAL_NATIVE
+
+#include "APRS_AudioSink.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/gpio.h>
+#include <driver/sigmadelta.h>
+#include <driver/timer.h>
+
+namespace APRS {
+
+// Timer group 1 stays clear of the timers the Arduino core hands out first
+#define SD_TIMER_GROUP      TIMER_GROUP_1
+#define SD_TIMER_INDEX      TIMER_1
+#define SD_TIMER_DIVIDER    2           // 40 MHz timer clock
+#define SD_TIMER_HZ         (80000000 / SD_TIMER_DIVIDER)     // 80 MHz APB clock
+
+// ============================================================================
+// Sigma-Delta Sink
+// ============================================================================
+SigmaDeltaSink::SigmaDeltaSink(uint8_t pin, uint8_t channel, uint32_t update_rate)
+    : _pin(pin), _channel(channel), _updateRate(update_rate), _decimation(1),
+      _phase(0), _head(0), _tail(0), _written(0), _played(0), _edgePending(false),
+      _edgeAt(0), _edgePin(0), _edgeLevel(false), _started(false) {
+}
+
+bool SigmaDeltaSink::begin(uint32_t sample_rate) {
+    if (_started || _updateRate == 0 || sample_rate % _updateRate != 0) {
+        return false;
+    }
+    _decimation = sample_rate / _updateRate;
+
+    sigmadelta_config_t sd;
+    sd.channel = (sigmadelta_channel_t)_channel;
+    sd.sigmadelta_duty = 0;             // Mid-scale
+    sd.sigmadelta_prescale = 0;         // Full 80 MHz modulator clock
+    sd.sigmadelta_gpio = _pin;
+    if (sigmadelta_config(&sd) != ESP_OK) {
+        return false;
+    }
+
+    timer_config_t timer;
+    timer.alarm_en = TIMER_ALARM_EN;
+    timer.counter_en = TIMER_PAUSE;
+    timer.intr_type = TIMER_INTR_LEVEL;
+    timer.counter_dir = TIMER_COUNT_UP;
+    timer.auto_reload = TIMER_AUTORELOAD_EN;
+    timer.divider = SD_TIMER_DIVIDER;
+    if (timer_init(SD_TIMER_GROUP, SD_TIMER_INDEX, &timer) != ESP_OK) {
+        return false;
+    }
+    timer_set_counter_value(SD_TIMER_GROUP, SD_TIMER_INDEX, 0);
+    timer_set_alarm_value(SD_TIMER_GROUP, SD_TIMER_INDEX,
+                          (SD_TIMER_HZ + _updateRate / 2) / _updateRate);
+    timer_enable_intr(SD_TIMER_GROUP, SD_TIMER_INDEX);
+    if (timer_isr_callback_add(SD_TIMER_GROUP, SD_TIMER_INDEX, onTimer, this, 0) != ESP_OK) {
+        return false;
+    }
+
+    _started = true;
+    return true;
+}
+
+size_t SigmaDeltaSink::write(const void* samples, size_t count) {
+    const uint8_t* in = static_cast<const uint8_t*>(samples);
+    for (size_t i = 0; i < count; i++) {
+        if (_phase != 0) {
+            _phase--;
+            continue;
+        }
+        _phase = _decimation - 1;
+
+        // Ring full: the timer drains one slot per update period
+        size_t next = (_head + 1) % RING_SIZE;
+        while (next == _tail) {
+            vTaskDelay(1);
+        }
+        _ring[_head] = in[i];
+        _head = next;
+        _written++;
+    }
+    return count;
+}
+
+void SigmaDeltaSink::txBegin() {
+    _head = _tail = 0;
+    _phase = 0;
+    _written = 0;
+    _played = 0;
+    _edgePending = false;
+    timer_start(SD_TIMER_GROUP, SD_TIMER_INDEX);
+}
+
+void SigmaDeltaSink::pttWrite(uint8_t pin, bool level) {
+    // Wait out an edge still pending, then hand this one to the ISR
+    while (_edgePending) {
+        vTaskDelay(1);
+    }
+    _edgePin = pin;
+    _edgeLevel = level;
+    _edgeAt = _written;
+    _edgePending = true;
+}
+
+void SigmaDeltaSink::drain() {
+    while (_tail != _head || _edgePending) {
+        vTaskDelay(1);
+    }
+}
+
+void SigmaDeltaSink::txEnd() {
+    // Let the queued audio play out, then park the output at mid-scale
+    drain();
+    timer_pause(SD_TIMER_GROUP, SD_TIMER_INDEX);
+    sigmadelta_set_duty((sigmadelta_channel_t)_channel, 0);
+}
+
+bool SigmaDeltaSink::onTimer(void* arg) {
+    SigmaDeltaSink* sink = static_cast<SigmaDeltaSink*>(arg);
+    // An edge switches as its sample is loaded, or once the samples before
+    // it have played (the key-up's first edge waits for audio to start)
+    size_t tail = sink->_tail;
+    bool loading = (tail != sink->_head);
+    if (sink->_edgePending && sink->_played == sink->_edgeAt && (loading || sink->_written > 0)) {
+        gpio_set_level((gpio_num_t)sink->_edgePin, sink->_edgeLevel ? 1 : 0);
+        sink->_edgePending = false;
+    }
+    if (loading) {
+        sigmadelta_set_duty((sigmadelta_channel_t)sink->_channel,
+                            (int8_t)(sink->_ring[tail] - 0x80));
+        sink->_tail = (tail + 1) % RING_SIZE;
+        sink->_played++;
+    }
+    return false;   // No task woken
+}
+
+} // namespace APRS
+
+#endif // APRS_HAL_NATIVE
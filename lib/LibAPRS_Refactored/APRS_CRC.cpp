@@ -0,0 +1,31 @@
+#include "APRS_CRC.h"
+
+namespace APRS {
+
+// ============================================================================
+// Slicing-by-8
+//
+// Byte i of an 8-byte step is followed by 7 - i more bytes, so it goes
+// through slice 7 - i; the register only overlaps the first two bytes.
+// Byte loads keep it independent of alignment and endianness.
+// ============================================================================
+static_assert(CRC_SLICES == 8, "updateBlock() is unrolled for 8 slices");
+
+uint16_t Crc16::updateBlock(const uint8_t* data, size_t len, uint16_t crc) {
+    const uint16_t* t = CrcMath::CrcTable<>::TABLE;
+    while (len >= CRC_SLICES) {
+        uint16_t head = crc ^ (uint16_t)(data[0] | (data[1] << 8));
+        crc = t[7 * 256 + (head & 0xFF)] ^ t[6 * 256 + (head >> 8)] ^
+              t[5 * 256 + data[2]] ^ t[4 * 256 + data[3]] ^
+              t[3 * 256 + data[4]] ^ t[2 * 256 + data[5]] ^
+              t[1 * 256 + data[6]] ^ t[data[7]];
+        data += CRC_SLICES;
+        len -= CRC_SLICES;
+    }
+    while (len-- > 0) {
+        crc = updateByte(*data++, crc);
+    }
+    return crc;
+}
+
+} // namespace APRS
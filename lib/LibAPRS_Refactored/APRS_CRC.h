@@ -0,0 +1,126 @@
+#ifndef APRS_CRC_H
+#define APRS_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "APRS_Modem.h"
+
+namespace APRS {
+
+// ============================================================================
+// AX.25 FCS Constants
+// ============================================================================
+#define AX25_CRC_INIT       0xFFFF  // Register at the start of a frame
+#define AX25_CRC_POLY       0x8408  // x^16 + x^12 + x^5 + 1, reflected
+#define AX25_CRC_GOOD       0xF0B8  // CRC residue over frame + valid FCS
+#define CRC_SLICES          8       // Bytes per step of the bulk path
+
+// ============================================================================
+// Compile-time tables
+// ============================================================================
+namespace CrcMath {
+
+// Register after shifting n bits of zeros through it
+constexpr uint16_t shift(uint16_t crc, int n) {
+    return n == 0 ? crc : shift((crc & 1) ? (uint16_t)((crc >> 1) ^ AX25_CRC_POLY) : (uint16_t)(crc >> 1), n - 1);
+}
+
+// Effect of a byte followed by k zero bytes: slice k of the table
+constexpr uint16_t slice(size_t k, uint16_t crc) {
+    return k == 0 ? crc : slice(k - 1, (uint16_t)((crc >> 8) ^ shift(crc & 0xFF, 8)));
+}
+
+template <typename Indices = typename ModemMath::MakeIndices<256 * CRC_SLICES>::type> struct CrcTable;
+
+template <size_t... I>
+struct CrcTable<ModemMath::IndexList<I...> > {
+    static constexpr uint16_t TABLE[sizeof...(I)] = {
+        slice(I / 256, shift(I % 256, 8))...
+    };
+};
+
+template <size_t... I>
+constexpr uint16_t CrcTable<ModemMath::IndexList<I...> >::TABLE[sizeof...(I)];
+
+} // namespace CrcMath
+
+// ============================================================================
+// CRC-CCITT (AX.25 FCS)
+// ============================================================================
+
+/**
+ * CRC-CCITT as AX.25 uses it (reflected, start 0xFFFF, FCS inverted and
+ * sent low byte first)
+ *
+ * The tables are generated at compile time: slice 0 is the classic
+ * byte-at-a-time table, slices 1-7 let update() fold CRC_SLICES bytes per
+ * step (slicing-by-8) for bulk data. Feed bytes incrementally with
+ * update() as they are produced or received, then read fcs() for a frame
+ * being built, or check good() after running over a frame and its FCS.
+ */
+class Crc16 {
+public:
+    Crc16() : _crc(AX25_CRC_INIT) {}
+
+    /**
+     * Start over (a new frame)
+     */
+    void reset() { _crc = AX25_CRC_INIT; }
+
+    /**
+     * Resume from a register value saved with value()
+     */
+    void resume(uint16_t crc) { _crc = crc; }
+
+    void update(uint8_t byte) { _crc = updateByte(byte, _crc); }
+
+    void update(const uint8_t* data, size_t len) { _crc = updateBlock(data, len, _crc); }
+
+    /**
+     * Register value (AX25_CRC_GOOD after a frame and its valid FCS)
+     */
+    uint16_t value() const { return _crc; }
+
+    /**
+     * FCS to append after the bytes so far
+     */
+    uint16_t fcs() const { return _crc ^ 0xFFFF; }
+
+    /**
+     * True after a frame followed by its correct FCS
+     */
+    bool good() const { return _crc == AX25_CRC_GOOD; }
+
+    /**
+     * Fold one byte into a register (table, one lookup)
+     */
+    static uint16_t updateByte(uint8_t byte, uint16_t crc) {
+        return (crc >> 8) ^ CrcMath::CrcTable<>::TABLE[(crc ^ byte) & 0xFF];
+    }
+
+    /**
+     * Fold a block into a register, CRC_SLICES bytes per step
+     */
+    static uint16_t updateBlock(const uint8_t* data, size_t len, uint16_t crc);
+
+    /**
+     * FCS of a whole frame (addresses through info)
+     */
+    static uint16_t compute(const uint8_t* data, size_t len) {
+        return updateBlock(data, len, AX25_CRC_INIT) ^ 0xFFFF;
+    }
+
+    /**
+     * True if the frame ends in its correct FCS
+     */
+    static bool check(const uint8_t* frame, size_t len) {
+        return len >= 2 && updateBlock(frame, len, AX25_CRC_INIT) == AX25_CRC_GOOD;
+    }
+
+private:
+    uint16_t _crc;
+};
+
+} // namespace APRS
+
+#endif // APRS_CRC_H
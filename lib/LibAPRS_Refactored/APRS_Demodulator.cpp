@@ -0,0 +1,209 @@
+#include "APRS_Demodulator.h"
+#include <math.h>
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// Correlator reference (one sine cycle, Q7, indexed by the top phase byte)
+// ============================================================================
+static int8_t SIN_Q7[256];
+static bool sinBuilt = false;
+
+static void buildSinTable() {
+    if (sinBuilt) {
+        return;
+    }
+    const double two_pi = 6.283185307179586;
+    for (int i = 0; i < 256; i++) {
+        SIN_Q7[i] = (int8_t)lround(127.0 * sin(two_pi * i / 256.0));
+    }
+    sinBuilt = true;
+}
+
+#define PHASE_INC(freq, rate) (uint32_t)((((uint64_t)(freq) << 32) + (rate) / 2) / (rate))
+#define PLL_CENTER 0x80000000u
+#define DCD_ERR_MAX 0x40000000      // Quarter bit either side of the clock
+#define DCD_LOCKED_EDGES 28         // Of the last 32 edges
+
+// |I| + |Q| style magnitude: max + min / 2 (within 12%, same bias for both
+// tones)
+static inline int32_t magnitude(int32_t i, int32_t q) {
+    if (i < 0) i = -i;
+    if (q < 0) q = -q;
+    return (i > q) ? i + (q >> 1) : q + (i >> 1);
+}
+
+Demodulator::Demodulator()
+    : _callback(nullptr), _user(nullptr), _markInc(0), _spaceInc(0),
+      _window(0), _pllStep(0), _edges(0), _dcd(false) {
+    reset();
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+bool Demodulator::begin(uint32_t sample_rate, FrameCallback callback, void* user,
+                        const ModemProfile* modem) {
+    const ModemProfile& m = modem ? *modem : Bell202::PROFILE;
+    uint32_t window = (sample_rate + m.baud / 2) / m.baud;
+    if (window < 8 || window > DEMOD_MAX_WINDOW) {
+        return false;
+    }
+
+    buildSinTable();
+    _callback = callback;
+    _user = user;
+    _window = (uint8_t)window;
+    _markInc = PHASE_INC(m.mark_freq, sample_rate);
+    _spaceInc = PHASE_INC(m.space_freq, sample_rate);
+    _pllStep = PHASE_INC(m.baud, sample_rate);
+    _stats = DemodStats();
+    reset();
+    return true;
+}
+
+void Demodulator::reset() {
+    _markPhase = 0;
+    _spacePhase = 0;
+    _dc = 0;
+    _pos = 0;
+    memset(_terms, 0, sizeof(_terms));
+    memset(_sums, 0, sizeof(_sums));
+
+    _pll = 0;
+    _lastTone = false;
+    _lastBitTone = false;
+    _edges = 0;
+    _dcd = false;
+
+    _shift = 0;
+    _ones = 0;
+    _byte = 0;
+    _bitCount = 0;
+    _inFrame = false;
+    _frameLen = 0;
+}
+
+// ============================================================================
+// Sample processing
+// ============================================================================
+void Demodulator::process(const int16_t* samples, size_t count) {
+    if (_window == 0) {
+        return;
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        // DC block (~16 Hz at 13.2 kHz), scaled to 12 bits
+        int32_t x = samples[n];
+        _dc += ((x << 4) - _dc) >> 7;
+        x = (x - (_dc >> 4)) >> 4;
+
+        // Sliding one-bit correlators: add the newest term, drop the oldest
+        int32_t t[4];
+        t[0] = x * SIN_Q7[_markPhase >> 24];
+        t[1] = x * SIN_Q7[(uint8_t)((_markPhase >> 24) + 64)];
+        t[2] = x * SIN_Q7[_spacePhase >> 24];
+        t[3] = x * SIN_Q7[(uint8_t)((_spacePhase >> 24) + 64)];
+        _markPhase += _markInc;
+        _spacePhase += _spaceInc;
+        for (int c = 0; c < 4; c++) {
+            _sums[c] += t[c] - _terms[c][_pos];
+            _terms[c][_pos] = t[c];
+        }
+        if (++_pos == _window) {
+            _pos = 0;
+        }
+
+        bool tone = magnitude(_sums[0], _sums[1]) > magnitude(_sums[2], _sums[3]);
+
+        // Pull the clock so discriminator edges fall half a bit from the
+        // sampling point, i.e. sample when the window covers one whole bit
+        if (tone != _lastTone) {
+            int32_t err = (int32_t)(_pll - PLL_CENTER);
+            _pll = PLL_CENTER + (uint32_t)(err - (err >> 2));
+            _lastTone = tone;
+
+            // Carrier detect: edges within a quarter bit of the clock
+            bool locked = err > -DCD_ERR_MAX && err < DCD_ERR_MAX;
+            _edges = (_edges << 1) | (locked ? 1 : 0);
+            _dcd = __builtin_popcount(_edges) >= DCD_LOCKED_EDGES;
+        }
+
+        uint32_t prev = _pll;
+        _pll += _pllStep;
+        if (_pll < prev) {
+            // NRZI: an unchanged tone is a one
+            receiveBit(tone == _lastBitTone);
+            _lastBitTone = tone;
+        }
+    }
+
+    _stats.samples += count;
+}
+
+// ============================================================================
+// HDLC deframing
+// ============================================================================
+void Demodulator::receiveBit(bool bit) {
+    _shift = (_shift >> 1) | (bit ? 0x80 : 0);
+
+    if (_shift == HDLC_FLAG) {
+        endFrame();
+        _inFrame = true;
+        _frameLen = 0;
+        _bitCount = 0;
+        _ones = 0;
+        return;
+    }
+
+    // Seven ones in a row: abort or idle channel
+    if ((_shift & 0xFE) == 0xFE) {
+        _inFrame = false;
+        return;
+    }
+
+    if (!_inFrame) {
+        return;
+    }
+
+    // Drop the zero stuffed after five ones
+    if (bit) {
+        _ones++;
+    } else {
+        bool stuffed = (_ones == BIT_STUFF_LEN);
+        _ones = 0;
+        if (stuffed) {
+            return;
+        }
+    }
+
+    _byte = (_byte >> 1) | (bit ? 0x80 : 0);
+    if (++_bitCount == 8) {
+        _bitCount = 0;
+        if (_frameLen < sizeof(_frame)) {
+            _frame[_frameLen++] = _byte;
+        } else {
+            _stats.overruns++;
+            _inFrame = false;
+        }
+    }
+}
+
+void Demodulator::endFrame() {
+    if (!_inFrame || _frameLen < AX25_MIN_FRAME_LEN) {
+        return;   // Back-to-back flags or noise
+    }
+
+    if (!Crc16::check(_frame, _frameLen)) {
+        _stats.fcs_errors++;
+        return;
+    }
+
+    _stats.frames++;
+    if (_callback) {
+        _callback(_frame, _frameLen - 2, _user);
+    }
+}
+
+} // namespace APRS
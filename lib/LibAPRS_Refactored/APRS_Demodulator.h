@@ -0,0 +1,123 @@
+#ifndef APRS_DEMODULATOR_H
+#define APRS_DEMODULATOR_H
+
+#include "APRS_Protocol.h"
+
+namespace APRS {
+
+// ============================================================================
+// Receive Constants
+// ============================================================================
+#define RX_SAMPLERATE       13200   // 11 samples per bit
+#define DEMOD_MAX_WINDOW    96      // Longest correlator window (samples)
+
+/**
+ * Frame callback: AX.25 frame from the first address through the
+ * information field (FCS checked and stripped)
+ */
+typedef void (*FrameCallback)(const uint8_t* frame, size_t len, void* user);
+
+// ============================================================================
+// Demodulator Statistics
+// ============================================================================
+struct DemodStats {
+    uint32_t samples = 0;       // Samples processed
+    uint32_t frames = 0;        // Frames with a good FCS
+    uint32_t fcs_errors = 0;    // Frames dropped on a bad FCS
+    uint32_t overruns = 0;      // Frames longer than AX25_MAX_FRAME_LEN
+};
+
+// ============================================================================
+// AFSK Demodulator
+// ============================================================================
+
+/**
+ * Integer AFSK demodulator and HDLC deframer (Bell 202 unless begin() is
+ * given another modem's baud and tones)
+ *
+ * Per sample: a DC-blocking high-pass, four sliding one-bit correlators
+ * (I/Q at mark and space, O(1) each), a magnitude discriminator and a
+ * digital PLL that samples each bit in the middle of its correlator
+ * window. Bits are NRZI decoded, de-stuffed and assembled between HDLC
+ * flags; frames with a good FCS go to the callback. Carrier detect
+ * follows how many recent tone edges the PLL found where it expected
+ * them: noise puts them anywhere, a locked signal on the clock.
+ *
+ * Holds no hardware state: the Receiver feeds it from the ADC and the
+ * native driver from WAV files.
+ */
+class Demodulator {
+public:
+    Demodulator();
+
+    /**
+     * Configure for a sample rate and reset all state
+     *
+     * @param sample_rate Input rate in Hz (8 up to DEMOD_MAX_WINDOW
+     *                    samples per bit)
+     * @param callback Called for every good frame
+     * @param user Passed to the callback
+     * @param modem Baud and tones to receive (its sample rate is not
+     *              used; nullptr: Bell202)
+     * @return false if the rate is out of range
+     */
+    bool begin(uint32_t sample_rate, FrameCallback callback, void* user,
+               const ModemProfile* modem = nullptr);
+
+    /**
+     * Demodulate a block of signed samples
+     */
+    void process(const int16_t* samples, size_t count);
+
+    /**
+     * Clear correlator, PLL and deframer state (keeps statistics)
+     */
+    void reset();
+
+    const DemodStats& stats() const { return _stats; }
+
+    /**
+     * Data carrier detect: most recent tone edges fell on the bit clock
+     */
+    bool isCarrierDetected() const { return _dcd; }
+
+private:
+    FrameCallback _callback;
+    void* _user;
+    DemodStats _stats;
+
+    // Correlators
+    uint32_t _markInc;              // Phase increments (2^32 = 1 cycle)
+    uint32_t _spaceInc;
+    uint32_t _markPhase;
+    uint32_t _spacePhase;
+    int32_t _dc;                    // DC estimate (Q4)
+    uint8_t _window;                // Samples per correlator window
+    uint8_t _pos;
+    int32_t _terms[4][DEMOD_MAX_WINDOW];    // mark I/Q, space I/Q
+    int32_t _sums[4];
+
+    // Bit clock
+    uint32_t _pllStep;
+    uint32_t _pll;                  // Bit sampled on wrap; edges pulled to 2^31
+    bool _lastTone;                 // Discriminator sign at the previous sample
+    bool _lastBitTone;              // Tone of the previous sampled bit
+    uint32_t _edges;                // Last 32 edges, 1 = close to the clock
+    volatile bool _dcd;
+
+    // HDLC
+    uint8_t _shift;                 // Last 8 bits, newest in the MSB
+    uint8_t _ones;
+    uint8_t _byte;
+    uint8_t _bitCount;
+    bool _inFrame;
+    size_t _frameLen;
+    uint8_t _frame[AX25_MAX_FRAME_LEN];
+
+    void receiveBit(bool bit);
+    void endFrame();
+};
+
+} // namespace APRS
+
+#endif // APRS_DEMODULATOR_H
@@ -0,0 +1,228 @@
+#include "APRS_FX25.h"
+#include "APRS_HDLC.h"
+#include "APRS_Protocol.h"
+#include "APRS_ReedSolomon.h"
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// Correlation tags (FX.25 specification), smallest block first per parity size
+// ============================================================================
+static const FX25Code CODES_16[] = {
+    { 0x8F056EB4369660EEULL,  48,  32 },    // Tag_04
+    { 0xC7DC0508F3D9B09EULL,  80,  64 },    // Tag_03
+    { 0x26FF60A600CC8FDEULL, 144, 128 },    // Tag_02
+    { 0xB74DB7DF8A532F3EULL, 255, 239 },    // Tag_01
+};
+
+static const FX25Code CODES_32[] = {
+    { 0xDBF869BD2DBB1776ULL,  64,  32 },    // Tag_08
+    { 0x1EB7B9CDBC09C00EULL,  96,  64 },    // Tag_07
+    { 0xFF94DC634F1CFF4EULL, 160, 128 },    // Tag_06
+    { 0x6E260B1AC5835FAEULL, 255, 223 },    // Tag_05
+};
+
+static const FX25Code CODES_64[] = {
+    { 0x4A4ABEC4A724B796ULL, 128,  64 },    // Tag_0B
+    { 0xAB69DB6A543188D6ULL, 192, 128 },    // Tag_0A
+    { 0x3ADB0C13DEAE2836ULL, 255, 191 },    // Tag_09
+};
+
+static const FX25Code* codes(FX25Mode mode, size_t& count) {
+    switch (mode) {
+    case FX25Mode::Check16: count = sizeof(CODES_16) / sizeof(CODES_16[0]); return CODES_16;
+    case FX25Mode::Check32: count = sizeof(CODES_32) / sizeof(CODES_32[0]); return CODES_32;
+    case FX25Mode::Check64: count = sizeof(CODES_64) / sizeof(CODES_64[0]); return CODES_64;
+    default: count = 0; return nullptr;
+    }
+}
+
+// One codec per parity size, built on first use
+static const ReedSolomon& codec(uint8_t nroots) {
+    static const ReedSolomon rs16(16, FX25_RS_FCR);
+    static const ReedSolomon rs32(32, FX25_RS_FCR);
+    static const ReedSolomon rs64(64, FX25_RS_FCR);
+    return (nroots == 16) ? rs16 : (nroots == 32) ? rs32 : rs64;
+}
+
+// ============================================================================
+// Code selection
+// ============================================================================
+const FX25Code* FX25Codec::pick(FX25Mode mode, const uint8_t* frame, size_t len) {
+    size_t count;
+    const FX25Code* table = codes(mode, count);
+    if (!table || !frame || len == 0 || len > AX25_MAX_FRAME_LEN) {
+        return nullptr;
+    }
+    // Opening flag, stuffed frame, closing flag
+    size_t bytes = (HdlcEncoder::frameBits(frame, len) + 16 + 7) / 8;
+    for (size_t i = 0; i < count; i++) {
+        if (bytes <= table[i].k) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+size_t FX25Codec::blockBytes(FX25Mode mode, const uint8_t* frame, size_t len) {
+    const FX25Code* code = pick(mode, frame, len);
+    return code ? FX25_CTAG_LEN + code->n : 0;
+}
+
+const FX25Code* FX25Codec::matchTag(uint64_t tag) {
+    const FX25Mode modes[] = { FX25Mode::Check16, FX25Mode::Check32, FX25Mode::Check64 };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        size_t count;
+        const FX25Code* table = codes(modes[m], count);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t diff = tag ^ table[i].tag;
+            int errors = 0;
+            while (diff && errors <= FX25_TAG_ERRORS) {
+                diff &= diff - 1;
+                errors++;
+            }
+            if (errors <= FX25_TAG_ERRORS) {
+                return &table[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// Data block bits (LSB first)
+// ============================================================================
+static inline void putBit(uint8_t* out, size_t& pos, bool bit) {
+    if (bit) {
+        out[pos / 8] |= (uint8_t)(1u << (pos % 8));
+    }
+    pos++;
+}
+
+static void putFlag(uint8_t* out, size_t& pos) {
+    for (uint8_t mask = 0x01; mask; mask <<= 1) {
+        putBit(out, pos, (HDLC_FLAG & mask) != 0);
+    }
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+size_t FX25Codec::encode(FX25Mode mode, const uint8_t* frame, size_t len,
+                         uint8_t* out, size_t capacity) {
+    const FX25Code* code = pick(mode, frame, len);
+    if (!code || !out || capacity < (size_t)FX25_CTAG_LEN + code->n) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < FX25_CTAG_LEN; i++) {
+        out[i] = (uint8_t)(code->tag >> (8 * i));
+    }
+
+    // Flag, stuffed frame, flag; pick() guaranteed it fits in k bytes
+    uint8_t* data = out + FX25_CTAG_LEN;
+    memset(data, 0, code->k);
+    size_t pos = 0;
+    putFlag(data, pos);
+    uint8_t ones = 0;
+    for (size_t i = 0; i < len; i++) {
+        for (uint8_t mask = 0x01; mask; mask <<= 1) {
+            bool bit = (frame[i] & mask) != 0;
+            putBit(data, pos, bit);
+            if (!bit) {
+                ones = 0;
+            } else if (++ones == BIT_STUFF_LEN) {
+                putBit(data, pos, false);
+                ones = 0;
+            }
+        }
+    }
+    putFlag(data, pos);
+
+    // Pad with the flag pattern running on to the end of the block
+    for (uint8_t i = 0; pos < (size_t)code->k * 8; i = (i + 1) % 8) {
+        putBit(data, pos, (HDLC_FLAG >> i) & 1);
+    }
+
+    codec(code->n - code->k).encode(data, code->k, data + code->k);
+    return FX25_CTAG_LEN + code->n;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+size_t FX25Codec::decode(const uint8_t* block, size_t len, uint8_t* frame, size_t capacity,
+                         int* corrected) {
+    if (!block || len < FX25_CTAG_LEN || !frame) {
+        return 0;
+    }
+    uint64_t tag = 0;
+    for (size_t i = 0; i < FX25_CTAG_LEN; i++) {
+        tag |= (uint64_t)block[i] << (8 * i);
+    }
+    const FX25Code* code = matchTag(tag);
+    if (!code || len < (size_t)FX25_CTAG_LEN + code->n) {
+        return 0;
+    }
+
+    uint8_t data[RS_SYMBOLS];
+    memcpy(data, block + FX25_CTAG_LEN, code->n);
+    int fixed = codec(code->n - code->k).decode(data, code->n);
+    if (fixed < 0) {
+        return 0;
+    }
+    if (corrected) {
+        *corrected = fixed;
+    }
+
+    // Find the opening flag, then unstuff up to the closing flag
+    const size_t bits = (size_t)code->k * 8;
+    size_t pos = 0;
+    uint8_t shift = 0;
+    while (pos < bits && shift != HDLC_FLAG) {
+        shift = (uint8_t)((shift >> 1) | (((data[pos / 8] >> (pos % 8)) & 1) << 7));
+        pos++;
+    }
+    if (shift != HDLC_FLAG) {
+        return 0;
+    }
+
+    size_t out_bits = 0;
+    uint8_t ones = 0;
+    bool closed = false;
+    memset(frame, 0, capacity);
+    for (; pos < bits && !closed; pos++) {
+        bool bit = (data[pos / 8] >> (pos % 8)) & 1;
+        if (bit) {
+            if (++ones > BIT_STUFF_LEN) {
+                closed = true;          // Sixth one: closing flag
+                continue;
+            }
+        } else if (ones == BIT_STUFF_LEN) {
+            ones = 0;                   // Stuffed zero
+            continue;
+        } else {
+            ones = 0;
+        }
+        if (out_bits / 8 >= capacity) {
+            return 0;
+        }
+        if (bit) {
+            frame[out_bits / 8] |= (uint8_t)(1u << (out_bits % 8));
+        }
+        out_bits++;
+    }
+
+    // The flag's leading zero and five ones were taken as data
+    if (!closed || out_bits < 6 || (out_bits - 6) % 8 != 0) {
+        return 0;
+    }
+    size_t frame_len = (out_bits - 6) / 8;
+    if (frame_len < AX25_MIN_FRAME_LEN) {
+        return 0;
+    }
+    return Crc16::check(frame, frame_len) ? frame_len : 0;
+}
+
+} // namespace APRS
@@ -0,0 +1,105 @@
+#ifndef APRS_FX25_H
+#define APRS_FX25_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// FX.25 Constants
+// ============================================================================
+#define FX25_CTAG_LEN       8       // Correlation tag, sent LSB first
+#define FX25_MAX_DATA       239     // Largest data block (RS(255,239))
+#define FX25_MAX_CHECK      64      // Largest parity block
+#define FX25_MAX_BLOCK      (FX25_CTAG_LEN + 255)
+#define FX25_RS_FCR         1       // First consecutive root of the generator
+#define FX25_TAG_ERRORS     8       // Tag bit errors still accepted on receive
+
+// ============================================================================
+// FX.25 Mode Selection
+// ============================================================================
+enum class FX25Mode : uint8_t {
+    Off,        // Plain AX.25
+    Check16,    // 16 parity bytes: corrects 8 byte errors per frame
+    Check32,    // 32 parity bytes: 16 byte errors
+    Check64     // 64 parity bytes: 32 byte errors
+};
+
+/**
+ * Parity bytes a mode adds to each frame (0 for Off)
+ */
+inline uint8_t fx25CheckBytes(FX25Mode mode) {
+    return (mode == FX25Mode::Off) ? 0 : (uint8_t)(8 << (uint8_t)mode);
+}
+
+/**
+ * One FX.25 code: correlation tag and RS(n, k) as sent on air
+ */
+struct FX25Code {
+    uint64_t tag;
+    uint8_t n;          // Data plus parity bytes on air
+    uint8_t k;          // Data bytes on air
+};
+
+// ============================================================================
+// FX.25 Codec
+// ============================================================================
+
+/**
+ * FX.25 wraps an AX.25 frame in forward error correction that plain AX.25
+ * receivers simply skip
+ *
+ * The data block is the frame as an AX.25 receiver sees it: opening flag,
+ * bit-stuffed frame with FCS and closing flag, packed LSB first and padded
+ * with more flags. The smallest code of the mode that holds it is chosen;
+ * its 64-bit correlation tag goes first and the Reed-Solomon parity last.
+ * None of it is bit stuffed; NRZI runs over the whole block on air.
+ * Frames too long for any code of the mode go out as plain AX.25.
+ */
+class FX25Codec {
+public:
+    /**
+     * Code a frame would be sent with
+     * @param mode FX.25 mode
+     * @param frame Encoded AX.25 frame (addresses through FCS)
+     * @param len Frame length
+     * @return nullptr for Off, or if the frame does not fit any code
+     */
+    static const FX25Code* pick(FX25Mode mode, const uint8_t* frame, size_t len);
+
+    /**
+     * Size of the FX.25 block for a frame (0: sent as plain AX.25)
+     */
+    static size_t blockBytes(FX25Mode mode, const uint8_t* frame, size_t len);
+
+    /**
+     * Build the on-air FX.25 block: tag, data block, parity
+     * @param out Output buffer (FX25_MAX_BLOCK always fits)
+     * @return Block length, or 0 if the frame goes out as plain AX.25
+     */
+    static size_t encode(FX25Mode mode, const uint8_t* frame, size_t len,
+                         uint8_t* out, size_t capacity);
+
+    /**
+     * Correct a received block and recover its AX.25 frame
+     * @param block Tag, data block and parity as received (NRZI decoded)
+     * @param len Bytes available (at least the block size of its tag)
+     * @param frame Receives the frame, addresses through FCS
+     * @param capacity Frame buffer size
+     * @param corrected Receives the bytes the parity corrected (optional)
+     * @return Frame length, or 0 if no tag matched, the block could not be
+     *         corrected or the FCS is bad
+     */
+    static size_t decode(const uint8_t* block, size_t len, uint8_t* frame, size_t capacity,
+                         int* corrected = nullptr);
+
+    /**
+     * Code whose tag is within FX25_TAG_ERRORS bits of a received tag
+     */
+    static const FX25Code* matchTag(uint64_t tag);
+};
+
+} // namespace APRS
+
+#endif // APRS_FX25_H
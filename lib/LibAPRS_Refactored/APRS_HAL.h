@@ -0,0 +1,197 @@
+#ifndef APRS_HAL_H
+#define APRS_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * APRS Hardware Abstraction Layer
+ *
+ * The protocol layer only talks to the hardware through these functions.
+ * Two implementations exist:
+ * - APRS_HAL_ESP32.cpp:  I2S built-in DAC/ADC, GPIO and FreeRTOS (default)
+ * - APRS_HAL_Native.cpp: Host capture of samples and PTT edges against a
+ *                        virtual clock, audio input fed from a buffer
+ *                        (built with -D APRS_HAL_NATIVE)
+ */
+
+namespace APRS {
+namespace HAL {
+
+/**
+ * Configure a GPIO pin as PTT output
+ */
+void pttBegin(uint8_t pin);
+
+/**
+ * Drive the PTT pin to a raw logic level
+ */
+void pttWrite(uint8_t pin, bool level);
+
+/**
+ * Initialize the audio output at the given sample rate
+ * @return true on success
+ */
+bool audioBegin(uint32_t sample_rate);
+
+/**
+ * Write samples to the audio output, blocking until all are queued
+ *
+ * Samples are unsigned with the DAC value in the high byte
+ * (128 << 8 is the DC midpoint).
+ *
+ * @param samples Sample buffer
+ * @param count Number of samples
+ * @return Number of samples written
+ */
+size_t audioWrite(const uint16_t* samples, size_t count);
+
+/**
+ * Drive the PTT pin to a raw logic level as the next sample written with
+ * audioWrite() starts to leave the DAC
+ *
+ * Between audioTxBegin() and audioTxEnd() only; one edge may be pending.
+ */
+void audioPttWrite(uint8_t pin, bool level);
+
+/**
+ * Block until every sample written has left the DAC, applying a pending
+ * audioPttWrite() edge on the way
+ */
+void audioDrain();
+
+// ============================================================================
+// Audio input
+//
+// On the ESP32 the built-in ADC and DAC share I2S0, so audio is half
+// duplex: capture stops between audioTxBegin() and audioTxEnd() and resumes
+// afterwards. Without captureBegin() the bracket only serializes output.
+// ============================================================================
+
+/**
+ * Start continuous capture from an ADC pin into the DMA ring
+ *
+ * @param pin ADC1 GPIO (32-39)
+ * @param sample_rate Capture rate in Hz
+ * @return true on success
+ */
+bool captureBegin(uint8_t pin, uint32_t sample_rate);
+
+/**
+ * Read captured samples (signed, DC midpoint at 0, full scale +-32768)
+ *
+ * @param samples Output buffer
+ * @param max Buffer size in samples
+ * @param timeout_ms Longest time to wait for data
+ * @return Number of samples read (0 on timeout or while transmitting)
+ */
+size_t captureRead(int16_t* samples, size_t max, uint32_t timeout_ms);
+
+/**
+ * Take the audio path for transmission (suspends capture)
+ */
+void audioTxBegin();
+
+/**
+ * Release the audio path (resumes capture if it was started)
+ */
+void audioTxEnd();
+
+/**
+ * Block the calling task for the given number of milliseconds
+ */
+void delayMs(uint32_t ms);
+
+/**
+ * Milliseconds since boot (virtual time on the host)
+ */
+uint32_t millis();
+
+/**
+ * Microseconds since boot (virtual time on the host)
+ */
+uint64_t micros();
+
+/**
+ * 32 random bits (hardware RNG; a fixed-seed generator on the host)
+ */
+uint32_t random32();
+
+// ============================================================================
+// Timers
+//
+// One-shot timers on the ESP32's esp_timer service. The callback runs on
+// the esp_timer task, so it should only wake the task that does the work
+// (taskNotify()). On the host, timers fire while the virtual clock
+// advances, and taskWait() returns early, notified, at the first one.
+// ============================================================================
+typedef void* Timer;
+typedef void (*TimerCallback)(void* arg);
+
+/**
+ * Create a stopped timer
+ * @return Timer handle, or nullptr on failure
+ */
+Timer timerCreate(TimerCallback callback, void* arg, const char* name);
+
+/**
+ * Fire once when micros() reaches at_us (at once if that has passed),
+ * replacing any pending expiry
+ */
+void timerArmAt(Timer timer, uint64_t at_us);
+
+/**
+ * Cancel a pending expiry
+ */
+void timerStop(Timer timer);
+
+// ============================================================================
+// Tasks and synchronization
+//
+// The native HAL is single threaded: lockCreate() returns a no-op lock and
+// taskStart() returns false, so callers fall back to servicing work from
+// their own thread. taskWait() there only returns notified by a timer.
+// ============================================================================
+typedef void* Lock;
+typedef void* Task;
+typedef void (*TaskEntry)(void* arg);
+
+/**
+ * Create a mutex
+ * @return Lock handle, or nullptr on failure
+ */
+Lock lockCreate();
+
+void lockTake(Lock lock);
+void lockGive(Lock lock);
+
+/**
+ * Start a task
+ *
+ * @param entry Task function (must never return)
+ * @param arg Argument passed to entry
+ * @param name Task name
+ * @param stack_bytes Stack size in bytes
+ * @param priority Task priority
+ * @param core Core to pin the task to, or -1 for no affinity
+ * @param task Receives the task handle
+ * @return true if the task is running
+ */
+bool taskStart(TaskEntry entry, void* arg, const char* name,
+               uint32_t stack_bytes, uint8_t priority, int8_t core, Task* task);
+
+/**
+ * Wake a task blocked in taskWait()
+ */
+void taskNotify(Task task);
+
+/**
+ * Block the calling task until notified or the timeout expires
+ * @return true if notified
+ */
+bool taskWait(uint32_t timeout_ms);
+
+} // namespace HAL
+} // namespace APRS
+
+#endif // APRS_HAL_H
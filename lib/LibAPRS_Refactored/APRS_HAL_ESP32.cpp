@@ -0,0 +1,439 @@
+#ifndef APRS_HAL_NATIVE
+
+#include "APRS_HAL.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <driver/gpio.h>
+#include <driver/i2s.h>
+#include <driver/adc.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_rom_sys.h>
+
+namespace APRS {
+namespace HAL {
+
+// ============================================================================
+// PTT
+// ============================================================================
+void pttBegin(uint8_t pin) {
+    gpio_set_direction((gpio_num_t)pin, GPIO_MODE_OUTPUT);
+}
+
+void pttWrite(uint8_t pin, bool level) {
+    gpio_set_level((gpio_num_t)pin, level ? 1 : 0);
+}
+
+// ============================================================================
+// Audio (I2S0: built-in DAC on GPIO25 for TX, built-in ADC1 for RX)
+//
+// The driver is reinstalled when switching direction; i2s_lock serializes
+// the switch against captureRead() on the receive task.
+//
+// The DAC's DMA ring plays its buffers in the order i2s_write() fills them
+// and posts I2S_EVENT_TX_DONE as each one finishes, so a buffer filled now
+// starts to play at the next event: buffer n of a key-up starts at the
+// (n + 1)th event after its first write. Counting events places PTT edges
+// on the sample they belong to instead of on a fixed delay.
+// ============================================================================
+namespace {
+    enum class I2sMode : uint8_t { None, Dac, Adc };
+
+    I2sMode i2s_mode = I2sMode::None;
+    SemaphoreHandle_t i2s_lock = NULL;
+    uint32_t dac_rate = 0;
+    uint32_t adc_rate = 0;          // 0: capture not started
+    adc1_channel_t adc_channel = ADC1_CHANNEL_0;
+    QueueHandle_t dac_events = NULL;
+
+    // Key-up in progress (audioTxBegin() to audioTxEnd())
+    uint32_t tx_written = 0;        // Samples written
+    uint32_t tx_events = 0;         // TX_DONE events since the first write
+    bool edge_pending = false;      // audioPttWrite() edge not yet switched
+    uint8_t edge_pin = 0;
+    bool edge_level = false;
+    uint32_t edge_at = 0;           // Index of the sample it belongs to
+
+    bool adcChannelForPin(uint8_t pin, adc1_channel_t* channel) {
+        static const uint8_t PINS[] = { 36, 37, 38, 39, 32, 33, 34, 35 };
+        for (uint8_t i = 0; i < sizeof(PINS); i++) {
+            if (PINS[i] == pin) {
+                *channel = (adc1_channel_t)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void i2sUninstall() {
+        if (i2s_mode == I2sMode::Adc) {
+            i2s_adc_disable(I2S_NUM_0);
+        }
+        if (i2s_mode != I2sMode::None) {
+            i2s_driver_uninstall(I2S_NUM_0);
+        }
+        i2s_mode = I2sMode::None;
+        dac_events = NULL;
+    }
+
+    // DAC DMA buffers hold the same time at any modem rate (300 samples at
+    // 105.6 kHz), so lower rates need less DMA memory
+    const uint32_t DAC_DMA_BUF_US = 2841;
+
+    const int DAC_EVENT_QUEUE_LEN = 8;
+
+    int dacDmaLen() {
+        uint32_t len = (uint32_t)((uint64_t)dac_rate * DAC_DMA_BUF_US / 1000000);
+        return (len < 8) ? 8 : (len > 1024) ? 1024 : (int)len;
+    }
+
+    // Switch the pending edge once its buffer has started, its offset into
+    // the buffer after the event that started it
+    void dacEdge() {
+        uint32_t len = dacDmaLen();
+        if (!edge_pending || edge_at / len >= tx_events) {
+            return;
+        }
+        uint32_t offset = edge_at % len;
+        if (offset != 0) {
+            esp_rom_delay_us((uint32_t)((uint64_t)offset * 1000000 / dac_rate));
+        }
+        pttWrite(edge_pin, edge_level);
+        edge_pending = false;
+    }
+
+    // Count TX_DONE events, waiting up to ticks for the first
+    bool dacPoll(TickType_t ticks) {
+        i2s_event_t event;
+        bool any = false;
+        while (dac_events && xQueueReceive(dac_events, &event, ticks) == pdTRUE) {
+            ticks = 0;
+            if (event.type == I2S_EVENT_TX_DONE) {
+                tx_events++;
+                any = true;
+                dacEdge();
+            }
+        }
+        return any;
+    }
+
+    bool i2sInstallDac() {
+        i2s_config_t i2s_config = {
+            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN),
+            .sample_rate = dac_rate,
+            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+            .channel_format = I2S_CHANNEL_FMT_ONLY_RIGHT,
+            .communication_format = I2S_COMM_FORMAT_STAND_MSB,
+            .intr_alloc_flags = 0,
+            .dma_buf_count = 2,
+            .dma_buf_len = dacDmaLen(),
+            .use_apll = true,
+            .tx_desc_auto_clear = true,
+            .fixed_mclk = 0
+        };
+
+        if (i2s_driver_install(I2S_NUM_0, &i2s_config, DAC_EVENT_QUEUE_LEN, &dac_events) != ESP_OK) {
+            dac_events = NULL;
+            return false;
+        }
+        i2s_set_pin(I2S_NUM_0, NULL);
+        i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);
+        i2s_mode = I2sMode::Dac;
+        return true;
+    }
+
+    bool i2sInstallAdc() {
+        // 8 x 256 sample DMA ring: ~155 ms of audio at 13.2 kHz
+        i2s_config_t i2s_config = {
+            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN),
+            .sample_rate = adc_rate,
+            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+            .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+            .communication_format = I2S_COMM_FORMAT_STAND_MSB,
+            .intr_alloc_flags = 0,
+            .dma_buf_count = 8,
+            .dma_buf_len = 256,
+            .use_apll = false,
+            .tx_desc_auto_clear = false,
+            .fixed_mclk = 0
+        };
+
+        if (i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL) != ESP_OK) {
+            return false;
+        }
+        adc1_config_width(ADC_WIDTH_BIT_12);
+        adc1_config_channel_atten(adc_channel, ADC_ATTEN_DB_11);
+        i2s_set_adc_mode(ADC_UNIT_1, adc_channel);
+        i2s_adc_enable(I2S_NUM_0);
+        i2s_mode = I2sMode::Adc;
+        return true;
+    }
+
+    // Either direction may be started first (capture runs alone when the
+    // modulator writes to a sink other than the DAC)
+    bool lockBegin() {
+        if (!i2s_lock) {
+            i2s_lock = xSemaphoreCreateMutex();
+        }
+        return i2s_lock != NULL;
+    }
+}
+
+bool audioBegin(uint32_t sample_rate) {
+    if (!lockBegin()) {
+        return false;
+    }
+
+    xSemaphoreTake(i2s_lock, portMAX_DELAY);
+    dac_rate = sample_rate;
+    i2sUninstall();
+    bool ok = i2sInstallDac();
+    xSemaphoreGive(i2s_lock);
+    return ok;
+}
+
+size_t audioWrite(const uint16_t* samples, size_t count) {
+    // Events before the first write belong to the idle ring
+    if (tx_written == 0 && dac_events) {
+        xQueueReset(dac_events);
+    }
+
+    // Up to the end of the current DMA buffer at a time: the write that
+    // needs the next buffer blocks until a TX_DONE frees it, and the event
+    // is read right after
+    size_t len = dacDmaLen();
+    size_t written = 0;
+    while (written < count) {
+        size_t n = len - tx_written % len;
+        if (n > count - written) {
+            n = count - written;
+        }
+        size_t bytes_written = 0;
+        i2s_write(I2S_NUM_0, samples + written, n * sizeof(uint16_t),
+                 &bytes_written, portMAX_DELAY);
+        if (bytes_written == 0) {
+            break;
+        }
+        written += bytes_written / sizeof(uint16_t);
+        tx_written += bytes_written / sizeof(uint16_t);
+        dacPoll(0);
+    }
+    return written;
+}
+
+void audioPttWrite(uint8_t pin, bool level) {
+    if (!dac_events) {
+        pttWrite(pin, level);   // No DAC: nothing to line up with
+        return;
+    }
+    if (edge_pending) {
+        pttWrite(edge_pin, edge_level);
+    }
+    edge_pin = pin;
+    edge_level = level;
+    edge_at = tx_written;
+    edge_pending = true;
+    dacEdge();
+}
+
+void audioDrain() {
+    // Pad the last buffer with midpoint silence, so it plays whole and the
+    // next key-up starts on a buffer boundary
+    uint16_t silence[32];
+    for (size_t i = 0; i < 32; i++) {
+        silence[i] = 128 << 8;
+    }
+    size_t len = dacDmaLen();
+    while (dac_events && tx_written % len != 0) {
+        size_t n = len - tx_written % len;
+        if (audioWrite(silence, (n < 32) ? n : 32) == 0) {
+            break;
+        }
+    }
+
+    // The last buffer has played at the event after the one that started it
+    uint32_t buffers = tx_written / len;
+    TickType_t timeout = pdMS_TO_TICKS(2 * DAC_DMA_BUF_US / 1000 + 10);
+    while (dac_events && tx_events <= buffers) {
+        if (!dacPoll(timeout)) {
+            break;      // DMA stopped
+        }
+    }
+    if (edge_pending) {
+        pttWrite(edge_pin, edge_level);
+        edge_pending = false;
+    }
+}
+
+void audioTxBegin() {
+    tx_written = 0;
+    tx_events = 0;
+    edge_pending = false;
+    if (!i2s_lock) {
+        return;
+    }
+    xSemaphoreTake(i2s_lock, portMAX_DELAY);
+    if (i2s_mode != I2sMode::Dac) {
+        i2sUninstall();
+        i2sInstallDac();
+    }
+}
+
+void audioTxEnd() {
+    if (!i2s_lock) {
+        return;
+    }
+    if (adc_rate != 0) {
+        i2sUninstall();
+        i2sInstallAdc();
+    }
+    xSemaphoreGive(i2s_lock);
+}
+
+bool captureBegin(uint8_t pin, uint32_t sample_rate) {
+    adc1_channel_t channel;
+    if (!lockBegin() || sample_rate == 0 || !adcChannelForPin(pin, &channel)) {
+        return false;
+    }
+
+    xSemaphoreTake(i2s_lock, portMAX_DELAY);
+    adc_channel = channel;
+    adc_rate = sample_rate;
+    i2sUninstall();
+    bool ok = i2sInstallAdc();
+    if (!ok) {
+        adc_rate = 0;
+        if (dac_rate != 0) {
+            i2sInstallDac();
+        }
+    }
+    xSemaphoreGive(i2s_lock);
+    return ok;
+}
+
+size_t captureRead(int16_t* samples, size_t max, uint32_t timeout_ms) {
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    if (!i2s_lock || xSemaphoreTake(i2s_lock, ticks) != pdTRUE) {
+        return 0;   // Transmitting
+    }
+    if (i2s_mode != I2sMode::Adc) {
+        xSemaphoreGive(i2s_lock);
+        vTaskDelay(ticks);
+        return 0;
+    }
+
+    // Read whole 32-bit DMA words; the ADC stores each pair of 16-bit
+    // samples swapped
+    size_t bytes_read = 0;
+    i2s_read(I2S_NUM_0, samples, (max & ~(size_t)1) * sizeof(uint16_t),
+             &bytes_read, ticks);
+    xSemaphoreGive(i2s_lock);
+
+    size_t count = bytes_read / sizeof(uint16_t);
+    uint16_t* raw = (uint16_t*)samples;
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        uint16_t first = raw[i + 1];
+        uint16_t second = raw[i];
+        samples[i] = (int16_t)(((int32_t)(first & 0x0FFF) - 2048) << 4);
+        samples[i + 1] = (int16_t)(((int32_t)(second & 0x0FFF) - 2048) << 4);
+    }
+    return count;
+}
+
+// ============================================================================
+// Timing
+// ============================================================================
+void delayMs(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+uint32_t millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+uint64_t micros() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+uint32_t random32() {
+    return esp_random();
+}
+
+// ============================================================================
+// Timers (esp_timer, callbacks dispatched from the esp_timer task)
+// ============================================================================
+Timer timerCreate(TimerCallback callback, void* arg, const char* name) {
+    esp_timer_create_args_t args = {};
+    args.callback = callback;
+    args.arg = arg;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = name;
+    esp_timer_handle_t handle = NULL;
+    if (esp_timer_create(&args, &handle) != ESP_OK) {
+        return nullptr;
+    }
+    return handle;
+}
+
+void timerArmAt(Timer timer, uint64_t at_us) {
+    if (!timer) {
+        return;
+    }
+    esp_timer_handle_t handle = (esp_timer_handle_t)timer;
+    esp_timer_stop(handle);     // ESP_ERR_INVALID_STATE when not running
+    int64_t now = esp_timer_get_time();
+    uint64_t timeout = ((int64_t)at_us > now) ? at_us - (uint64_t)now : 0;
+    esp_timer_start_once(handle, timeout);
+}
+
+void timerStop(Timer timer) {
+    if (timer) {
+        esp_timer_stop((esp_timer_handle_t)timer);
+    }
+}
+
+// ============================================================================
+// Tasks and synchronization
+// ============================================================================
+Lock lockCreate() {
+    return xSemaphoreCreateMutex();
+}
+
+void lockTake(Lock lock) {
+    xSemaphoreTake((SemaphoreHandle_t)lock, portMAX_DELAY);
+}
+
+void lockGive(Lock lock) {
+    xSemaphoreGive((SemaphoreHandle_t)lock);
+}
+
+bool taskStart(TaskEntry entry, void* arg, const char* name,
+               uint32_t stack_bytes, uint8_t priority, int8_t core, Task* task) {
+    TaskHandle_t handle = NULL;
+    BaseType_t affinity = (core < 0) ? tskNO_AFFINITY : core;
+    if (xTaskCreatePinnedToCore(entry, name, stack_bytes, arg, priority,
+                                &handle, affinity) != pdPASS) {
+        return false;
+    }
+    if (task) {
+        *task = handle;
+    }
+    return true;
+}
+
+void taskNotify(Task task) {
+    if (task) {
+        xTaskNotifyGive((TaskHandle_t)task);
+    }
+}
+
+bool taskWait(uint32_t timeout_ms) {
+    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return ulTaskNotifyTake(pdTRUE, ticks) > 0;
+}
+
+} // namespace HAL
+} // namespace APRS
+
+#endif // APRS_HAL_NATIVE
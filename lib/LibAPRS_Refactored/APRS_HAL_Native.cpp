@@ -0,0 +1,359 @@
+#ifdef APRS_HAL_NATIVE
+
+#include "APRS_HAL_Native.h"
+#include <algorithm>
+#include <stdio.h>
+
+namespace APRS {
+namespace HAL {
+
+namespace {
+    struct NativeTimer {
+        TimerCallback callback;
+        void* arg;
+        uint64_t at_us;
+        bool armed;
+    };
+
+    struct State {
+        uint32_t sample_rate = 0;
+        uint64_t now_us = 0;
+        uint64_t sample_count = 0;   // Samples since last reset (drives clock)
+        bool capture = true;
+        std::vector<uint16_t> samples;
+        std::vector<Native::PttEdge> edges;
+        uint32_t capture_rate = 0;
+        uint64_t input_count = 0;    // Input samples read since last reset
+        size_t input_pos = 0;
+        std::vector<int16_t> input;
+        uint32_t random = 2463534242u;
+        std::vector<NativeTimer*> timers;
+    };
+
+    State& state() {
+        static State instance;
+        return instance;
+    }
+
+    /**
+     * Earliest armed timer due by limit_us, or nullptr
+     */
+    NativeTimer* nextTimer(uint64_t limit_us) {
+        NativeTimer* next = nullptr;
+        for (size_t i = 0; i < state().timers.size(); i++) {
+            NativeTimer* t = state().timers[i];
+            if (t->armed && t->at_us <= limit_us && (!next || t->at_us < next->at_us)) {
+                next = t;
+            }
+        }
+        return next;
+    }
+
+    /**
+     * Move the clock to the timer's expiry (never backwards) and fire it
+     */
+    void fire(NativeTimer* timer) {
+        if (timer->at_us > state().now_us) {
+            state().now_us = timer->at_us;
+        }
+        timer->armed = false;
+        timer->callback(timer->arg);
+    }
+
+    /**
+     * Advance the virtual clock, firing the timers it passes in order
+     */
+    void advance(uint64_t us) {
+        uint64_t end_us = state().now_us + us;
+        while (NativeTimer* timer = nextTimer(end_us)) {
+            fire(timer);
+        }
+        state().now_us = end_us;
+    }
+
+    void putLE16(FILE* f, uint16_t v) {
+        fputc(v & 0xFF, f);
+        fputc(v >> 8, f);
+    }
+
+    void putLE32(FILE* f, uint32_t v) {
+        putLE16(f, v & 0xFFFF);
+        putLE16(f, v >> 16);
+    }
+}
+
+// ============================================================================
+// PTT
+// ============================================================================
+void pttBegin(uint8_t pin) {
+    (void)pin;
+}
+
+void pttWrite(uint8_t pin, bool level) {
+    Native::PttEdge edge = { state().now_us, pin, level };
+    state().edges.push_back(edge);
+}
+
+// ============================================================================
+// Audio capture
+// ============================================================================
+bool audioBegin(uint32_t sample_rate) {
+    state().sample_rate = sample_rate;
+    return sample_rate > 0;
+}
+
+size_t audioWrite(const uint16_t* samples, size_t count) {
+    State& s = state();
+    if (s.capture) {
+        s.samples.insert(s.samples.end(), samples, samples + count);
+    }
+
+    // Advance the clock by the playback time, computed from the absolute
+    // sample count so rounding does not accumulate
+    uint64_t start_us = s.sample_count * 1000000ULL / s.sample_rate;
+    s.sample_count += count;
+    uint64_t end_us = s.sample_count * 1000000ULL / s.sample_rate;
+    advance(end_us - start_us);
+    return count;
+}
+
+// Samples play as they are written, so the next one starts now
+void audioPttWrite(uint8_t pin, bool level) {
+    pttWrite(pin, level);
+}
+
+void audioDrain() {
+}
+
+void audioTxBegin() {
+}
+
+void audioTxEnd() {
+}
+
+// ============================================================================
+// Audio input
+// ============================================================================
+bool captureBegin(uint8_t pin, uint32_t sample_rate) {
+    (void)pin;
+    state().capture_rate = sample_rate;
+    return sample_rate > 0;
+}
+
+size_t captureRead(int16_t* samples, size_t max, uint32_t timeout_ms) {
+    State& s = state();
+    size_t count = s.input.size() - s.input_pos;
+    if (count > max) {
+        count = max;
+    }
+    if (count == 0 || s.capture_rate == 0) {
+        delayMs(timeout_ms);
+        return 0;
+    }
+
+    std::copy(s.input.begin() + s.input_pos, s.input.begin() + s.input_pos + count, samples);
+    s.input_pos += count;
+
+    uint64_t start_us = s.input_count * 1000000ULL / s.capture_rate;
+    s.input_count += count;
+    uint64_t end_us = s.input_count * 1000000ULL / s.capture_rate;
+    advance(end_us - start_us);
+    return count;
+}
+
+// ============================================================================
+// Timing
+// ============================================================================
+void delayMs(uint32_t ms) {
+    advance((uint64_t)ms * 1000);
+}
+
+uint32_t millis() {
+    return (uint32_t)(state().now_us / 1000);
+}
+
+uint64_t micros() {
+    return state().now_us;
+}
+
+uint32_t random32() {
+    // xorshift32, reseeded by reset() so runs are reproducible
+    uint32_t& x = state().random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// ============================================================================
+// Timers (fired by advance() as the virtual clock passes them)
+// ============================================================================
+Timer timerCreate(TimerCallback callback, void* arg, const char* name) {
+    (void)name;
+    if (!callback) {
+        return nullptr;
+    }
+    NativeTimer* timer = new NativeTimer();
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->at_us = 0;
+    timer->armed = false;
+    state().timers.push_back(timer);
+    return timer;
+}
+
+void timerArmAt(Timer timer, uint64_t at_us) {
+    if (timer) {
+        static_cast<NativeTimer*>(timer)->at_us = at_us;
+        static_cast<NativeTimer*>(timer)->armed = true;
+    }
+}
+
+void timerStop(Timer timer) {
+    if (timer) {
+        static_cast<NativeTimer*>(timer)->armed = false;
+    }
+}
+
+// ============================================================================
+// Tasks and synchronization (single threaded)
+// ============================================================================
+Lock lockCreate() {
+    static int dummy;
+    return &dummy;
+}
+
+void lockTake(Lock lock) {
+    (void)lock;
+}
+
+void lockGive(Lock lock) {
+    (void)lock;
+}
+
+bool taskStart(TaskEntry entry, void* arg, const char* name,
+               uint32_t stack_bytes, uint8_t priority, int8_t core, Task* task) {
+    (void)entry; (void)arg; (void)name; (void)stack_bytes;
+    (void)priority; (void)core; (void)task;
+    return false;
+}
+
+void taskNotify(Task task) {
+    (void)task;
+}
+
+// Sleep until the first timer fires (notified) or the timeout
+bool taskWait(uint32_t timeout_ms) {
+    NativeTimer* timer = nextTimer(state().now_us + (uint64_t)timeout_ms * 1000);
+    if (timer) {
+        fire(timer);
+        return true;
+    }
+    delayMs(timeout_ms);
+    return false;
+}
+
+// ============================================================================
+// Capture inspection
+// ============================================================================
+namespace Native {
+
+void reset() {
+    State& s = state();
+    s.now_us = 0;
+    s.sample_count = 0;
+    s.samples.clear();
+    s.edges.clear();
+    s.input_count = 0;
+    s.input_pos = 0;
+    s.input.clear();
+    s.random = 2463534242u;
+    for (size_t i = 0; i < s.timers.size(); i++) {
+        s.timers[i]->armed = false;     // Their expiries belong to the old clock
+    }
+}
+
+void setCapture(bool enable) {
+    state().capture = enable;
+}
+
+uint64_t nowMicros() {
+    return state().now_us;
+}
+
+uint32_t sampleRate() {
+    return state().sample_rate;
+}
+
+const std::vector<uint16_t>& samples() {
+    return state().samples;
+}
+
+const std::vector<PttEdge>& pttEdges() {
+    return state().edges;
+}
+
+uint32_t captureRate() {
+    return state().capture_rate;
+}
+
+void feedCapture(const int16_t* samples, size_t count) {
+    State& s = state();
+    s.input.erase(s.input.begin(), s.input.begin() + s.input_pos);
+    s.input_pos = 0;
+    s.input.insert(s.input.end(), samples, samples + count);
+}
+
+bool writeWav(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+
+    const State& s = state();
+    uint32_t data_len = (uint32_t)s.samples.size();
+    uint32_t pad = data_len & 1;    // RIFF chunks are word aligned
+
+    // RIFF header, 8-bit unsigned mono PCM
+    fputs("RIFF", f);
+    putLE32(f, 36 + data_len + pad);
+    fputs("WAVE", f);
+    fputs("fmt ", f);
+    putLE32(f, 16);              // fmt chunk size
+    putLE16(f, 1);               // PCM
+    putLE16(f, 1);               // Mono
+    putLE32(f, s.sample_rate);
+    putLE32(f, s.sample_rate);   // Byte rate
+    putLE16(f, 1);               // Block align
+    putLE16(f, 8);               // Bits per sample
+    fputs("data", f);
+    putLE32(f, data_len);
+
+    for (size_t i = 0; i < s.samples.size(); i++) {
+        fputc(s.samples[i] >> 8, f);
+    }
+    if (pad) {
+        fputc(0, f);
+    }
+
+    return fclose(f) == 0;
+}
+
+bool writeRaw(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    const State& s = state();
+    for (size_t i = 0; i < s.samples.size(); i++) {
+        fputc(s.samples[i] >> 8, f);
+    }
+    return fclose(f) == 0;
+}
+
+} // namespace Native
+
+} // namespace HAL
+} // namespace APRS
+
+#endif // APRS_HAL_NATIVE
@@ -0,0 +1,88 @@
+#ifndef APRS_HAL_NATIVE_H
+#define APRS_HAL_NATIVE_H
+
+#include "APRS_HAL.h"
+#include <vector>
+
+/**
+ * Host-side capture for the native HAL
+ *
+ * Only available when built with -D APRS_HAL_NATIVE. Every sample that
+ * would have gone to i2s_write() and every PTT edge is recorded against a
+ * virtual clock that advances with delayMs() and with the playback time of
+ * the samples written. captureRead() returns samples queued with
+ * feedCapture() and advances the clock by their duration. HAL timers fire
+ * as the clock passes their expiry.
+ */
+
+namespace APRS {
+namespace HAL {
+namespace Native {
+
+struct PttEdge {
+    uint64_t time_us;   // Virtual time of the edge
+    uint8_t pin;        // GPIO pin number
+    bool level;         // Raw logic level written
+};
+
+/**
+ * Clear all captured samples and PTT edges, stop all timers and rewind the
+ * virtual clock
+ */
+void reset();
+
+/**
+ * Enable or disable sample capture (enabled by default)
+ *
+ * With capture disabled samples are only counted, which keeps long
+ * benchmark runs from measuring vector growth instead of the modulator.
+ */
+void setCapture(bool enable);
+
+/**
+ * Current virtual time in microseconds
+ */
+uint64_t nowMicros();
+
+/**
+ * Sample rate passed to audioBegin()
+ */
+uint32_t sampleRate();
+
+/**
+ * All samples written so far (DAC value in the high byte)
+ */
+const std::vector<uint16_t>& samples();
+
+/**
+ * All PTT edges written so far
+ */
+const std::vector<PttEdge>& pttEdges();
+
+/**
+ * Sample rate passed to captureBegin() (0 before)
+ */
+uint32_t captureRate();
+
+/**
+ * Queue audio for captureRead() (at captureRate())
+ */
+void feedCapture(const int16_t* samples, size_t count);
+
+/**
+ * Write captured samples as 8-bit unsigned mono PCM WAV
+ * @return true on success
+ */
+bool writeWav(const char* path);
+
+/**
+ * Write captured samples as raw 8-bit unsigned PCM
+ * @return true on success
+ */
+bool writeRaw(const char* path);
+
+} // namespace Native
+} // namespace HAL
+} // namespace APRS
+
+#endif // APRS_HAL_NATIVE_H
@@ -0,0 +1,187 @@
+#include "APRS_HDLC.h"
+#include "APRS_Protocol.h"
+
+namespace APRS {
+
+HdlcEncoder::HdlcEncoder()
+    : _words(nullptr), _capacity(0), _len(0), _stuffed(0), _ones(0),
+      _tone(false), _overflow(false) {
+}
+
+void HdlcEncoder::begin(uint32_t* words, size_t capacity_bits) {
+    _words = words;
+    _capacity = words ? capacity_bits : (size_t)-1;
+    _len = 0;
+    _stuffed = 0;
+    _ones = 0;
+    _tone = false;
+    _overflow = false;
+}
+
+// ============================================================================
+// Bit output
+// ============================================================================
+bool HdlcEncoder::reserve(size_t bits) {
+    if (_overflow || bits > _capacity - _len) {
+        _overflow = true;
+        return false;
+    }
+    return true;
+}
+
+void HdlcEncoder::put(bool bit) {
+    // NRZI: a zero toggles the tone, a one keeps it
+    if (!bit) {
+        _tone = !_tone;
+    }
+    if (_words) {
+        uint32_t& word = _words[_len / HDLC_WORD_BITS];
+        uint32_t mask = 1u << (_len % HDLC_WORD_BITS);
+        word = _tone ? (word | mask) : (word & ~mask);
+    }
+    _len++;
+}
+
+// ============================================================================
+// Flags and frames
+// ============================================================================
+bool HdlcEncoder::flags(size_t count) {
+    if (!reserve(count * 8)) {
+        return false;
+    }
+    for (size_t n = 0; n < count; n++) {
+        for (uint8_t mask = 0x01; mask; mask <<= 1) {
+            put((HDLC_FLAG & mask) != 0);
+        }
+    }
+    _ones = 0;
+    return true;
+}
+
+bool HdlcEncoder::frame(const uint8_t* data, size_t len) {
+    // Unstuffed size up front; each stuffed bit is checked as it is added
+    size_t remaining = len * 8;
+    if (!reserve(remaining)) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        for (uint8_t mask = 0x01; mask; mask <<= 1) {
+            bool bit = (byte & mask) != 0;
+            put(bit);
+            remaining--;
+            if (!bit) {
+                _ones = 0;
+            } else if (++_ones == BIT_STUFF_LEN) {
+                if (!reserve(1 + remaining)) {
+                    return false;
+                }
+                put(false);
+                _stuffed++;
+                _ones = 0;
+            }
+        }
+    }
+    return true;
+}
+
+void HdlcEncoder::putByte(uint8_t byte, bool msb_first) {
+    for (uint8_t i = 0; i < 8; i++) {
+        put((byte >> (msb_first ? 7 - i : i)) & 1);
+    }
+}
+
+bool HdlcEncoder::raw(const uint8_t* data, size_t len, bool msb_first) {
+    if (!reserve(len * 8)) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        putByte(data[i], msb_first);
+    }
+    _ones = 0;
+    return true;
+}
+
+bool HdlcEncoder::fill(uint8_t byte, size_t count, bool msb_first) {
+    if (!reserve(count * 8)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        putByte(byte, msb_first);
+    }
+    _ones = 0;
+    return true;
+}
+
+// ============================================================================
+// Pre-encoded tones
+// ============================================================================
+bool HdlcEncoder::tones(const uint32_t* words, size_t bits, uint32_t stuffed) {
+    if (!reserve(bits)) {
+        return false;
+    }
+    if (bits == 0) {
+        return true;
+    }
+    const uint32_t invert = _tone ? 0xFFFFFFFFu : 0;
+    if (_words) {
+        size_t shift = _len % HDLC_WORD_BITS;
+        uint32_t* dst = _words + _len / HDLC_WORD_BITS;
+        size_t count = (bits + HDLC_WORD_BITS - 1) / HDLC_WORD_BITS;
+        size_t last = (_len + bits - 1) / HDLC_WORD_BITS - _len / HDLC_WORD_BITS;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t w = words[i] ^ invert;
+            if (shift == 0) {
+                dst[i] = w;
+            } else {
+                dst[i] = (dst[i] & ((1u << shift) - 1)) | (w << shift);
+                if (i + 1 <= last) {
+                    dst[i + 1] = w >> (HDLC_WORD_BITS - shift);
+                }
+            }
+        }
+    }
+    size_t end = bits - 1;
+    _tone = (((words[end / HDLC_WORD_BITS] >> (end % HDLC_WORD_BITS)) & 1) != 0) != (invert != 0);
+    _len += bits;
+    _stuffed += stuffed;
+    _ones = 0;
+    return true;
+}
+
+void HdlcEncoder::copyTones(size_t from, size_t bits, uint32_t* out, bool invert) const {
+    if (!_words || bits == 0) {
+        return;
+    }
+    const uint32_t mask = invert ? 0xFFFFFFFFu : 0;
+    size_t first = from / HDLC_WORD_BITS;
+    size_t shift = from % HDLC_WORD_BITS;
+    size_t last = (from + bits - 1) / HDLC_WORD_BITS;
+    size_t count = (bits + HDLC_WORD_BITS - 1) / HDLC_WORD_BITS;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t w = _words[first + i] >> shift;
+        if (shift && first + i + 1 <= last) {
+            w |= _words[first + i + 1] << (HDLC_WORD_BITS - shift);
+        }
+        out[i] = w ^ mask;
+    }
+}
+
+uint32_t HdlcEncoder::frameBits(const uint8_t* data, size_t len) {
+    uint32_t bits = len * 8;
+    uint8_t ones = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        for (uint8_t mask = 0x01; mask; mask <<= 1) {
+            if (!(byte & mask)) {
+                ones = 0;
+            } else if (++ones == BIT_STUFF_LEN) {
+                bits++;
+                ones = 0;
+            }
+        }
+    }
+    return bits;
+}
+
+} // namespace APRS
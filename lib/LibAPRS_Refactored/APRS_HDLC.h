@@ -0,0 +1,150 @@
+#ifndef APRS_HDLC_H
+#define APRS_HDLC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// Bitstream Constants
+// ============================================================================
+#define HDLC_WORD_BITS      32      // Bits per storage word
+
+// ============================================================================
+// HDLC Bitstream Encoder
+// ============================================================================
+
+/**
+ * Encodes flags and frames into the final on-air bitstream
+ *
+ * Frame bits are sent LSB first with a zero stuffed after every five
+ * consecutive ones; flags are never stuffed. Every bit is then NRZI coded
+ * (a zero toggles the tone, a one keeps it), so each stored bit is the tone
+ * of one bit period: 0 = mark, 1 = space. The modulator only walks bits.
+ *
+ * Bits are packed LSB first into 32-bit words supplied by the caller.
+ * Every append checks the capacity and fails without writing past it.
+ * Without storage the encoder only counts, which sizes a key-up exactly
+ * before it is sent.
+ *
+ * clear() empties the buffer but keeps the line state (current tone and
+ * ones run), so a long transmission can be encoded and modulated in
+ * consecutive segments as one continuous signal.
+ */
+class HdlcEncoder {
+public:
+    HdlcEncoder();
+
+    /**
+     * Attach storage and restart the line on the mark tone
+     *
+     * @param words Bit storage (nullptr: count only)
+     * @param capacity_bits Storage size in bits
+     */
+    void begin(uint32_t* words, size_t capacity_bits);
+
+    /**
+     * Empty the buffer, keeping tone and stuffing state
+     */
+    void clear() { _len = 0; _overflow = false; }
+
+    /**
+     * Append HDLC flags (0x7E, not stuffed)
+     * @return false if they do not fit
+     */
+    bool flags(size_t count);
+
+    /**
+     * Append frame bytes with bit stuffing
+     * @return false if they do not fit
+     */
+    bool frame(const uint8_t* data, size_t len);
+
+    /**
+     * Append bytes as they are, without bit stuffing (e.g. an FX.25 block)
+     * @param msb_first Send each byte MSB first (IL2P) instead of LSB first
+     * @return false if they do not fit
+     */
+    bool raw(const uint8_t* data, size_t len, bool msb_first = false);
+
+    /**
+     * Append one byte repeated, without bit stuffing (e.g. IL2P preamble)
+     * @return false if they do not fit
+     */
+    bool fill(uint8_t byte, size_t count, bool msb_first = false);
+
+    /**
+     * Append tones encoded earlier (see copyTones()), starting from the
+     * current line tone: inverted if the line is on the space tone. They
+     * must end on a flag or outside stuffed data.
+     *
+     * @param words Tones as packed by this encoder, relative to mark
+     * @param bits Number of tones
+     * @param stuffed Stuffed bits among them (for stuffedBits())
+     * @return false if they do not fit
+     */
+    bool tones(const uint32_t* words, size_t bits, uint32_t stuffed);
+
+    /**
+     * Copy tones out of the buffer for tones()
+     *
+     * @param from First bit
+     * @param bits Number of bits
+     * @param out Receives (bits + 31) / 32 words
+     * @param invert Invert them (pass the line tone before bit from, so
+     *               the copy is relative to mark)
+     */
+    void copyTones(size_t from, size_t bits, uint32_t* out, bool invert) const;
+
+    /**
+     * Tone of the last bit appended (true: space)
+     */
+    bool lineTone() const { return _tone; }
+
+    /**
+     * Bits in the buffer since begin() or clear()
+     */
+    size_t length() const { return _len; }
+
+    /**
+     * True if an append did not fit since begin() or clear()
+     */
+    bool overflowed() const { return _overflow; }
+
+    /**
+     * Tone of bit i (true: space)
+     */
+    bool tone(size_t i) const {
+        return (_words[i / HDLC_WORD_BITS] >> (i % HDLC_WORD_BITS)) & 1;
+    }
+
+    const uint32_t* words() const { return _words; }
+
+    /**
+     * Zero bits inserted by stuffing since begin()
+     */
+    uint32_t stuffedBits() const { return _stuffed; }
+
+    /**
+     * Number of on-air bits for a frame (stuffing included, no flags)
+     */
+    static uint32_t frameBits(const uint8_t* data, size_t len);
+
+private:
+    uint32_t* _words;
+    size_t _capacity;
+    size_t _len;
+    uint32_t _stuffed;
+    uint8_t _ones;                  // Consecutive one bits in frame data
+    bool _tone;                     // Current tone (true: space)
+    bool _overflow;
+
+    bool reserve(size_t bits);
+    void put(bool bit);
+    void putByte(uint8_t byte, bool msb_first);
+};
+
+} // namespace APRS
+
+#endif // APRS_HDLC_H
@@ -0,0 +1,364 @@
+#include "APRS_IL2P.h"
+#include "APRS_AX25.h"
+#include "APRS_ReedSolomon.h"
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// Header fields
+//
+// Bytes 0-5 and 6-11 carry the destination and source callsigns as 6-bit
+// characters in bits 0-5; byte 12 the SSIDs (destination high nibble).
+// Bits 6 and 7 of bytes 0-11 hold the remaining fields, MSB first:
+//   byte 0 bit 6: UI        bytes 1-4 bit 6: PID    bytes 5-11 bit 6: control
+//   byte 0 bit 7: max FEC   byte 1 bit 7: header type
+//   bytes 2-11 bit 7: payload byte count
+// ============================================================================
+#define IL2P_HDR_UI         0x40    // Byte 0
+#define IL2P_HDR_MAX_FEC    0x80    // Byte 0
+#define IL2P_HDR_TYPE_1     0x80    // Byte 1
+#define IL2P_CTRL_PF        0x40    // Control field bits
+#define IL2P_CTRL_C         0x04
+#define IL2P_PID_S          0       // PID codes of frames without a PID
+#define IL2P_PID_U          1
+#define IL2P_U_UI           5       // U frame opcode of UI
+
+static void setField(uint8_t* hdr, uint8_t bit, size_t first, size_t width, unsigned value) {
+    for (size_t i = 0; i < width; i++) {
+        if ((value >> (width - 1 - i)) & 1) {
+            hdr[first + i] |= (uint8_t)(1u << bit);
+        }
+    }
+}
+
+static unsigned getField(const uint8_t* hdr, uint8_t bit, size_t first, size_t width) {
+    unsigned value = 0;
+    for (size_t i = 0; i < width; i++) {
+        value = (value << 1) | ((hdr[first + i] >> bit) & 1);
+    }
+    return value;
+}
+
+// AX.25 PIDs the 4-bit header field can carry (index: IL2P code)
+static const int16_t PID_MAP[16] = {
+    -1, -1, 0x20, 0x01, 0x06, 0x07, 0x08, -1,
+    -1, -1, -1, 0xCC, 0xCD, 0xCE, 0xCF, 0xF0
+};
+
+// AX.25 control byte (P/F clear) of each U frame opcode:
+// SABM, DISC, DM, UA, FRMR, UI, XID, TEST
+static const uint8_t U_CONTROL[8] = { 0x2F, 0x43, 0x0F, 0x63, 0x87, 0x03, 0xAF, 0xE3 };
+
+static int pidCode(uint8_t pid) {
+    for (int i = 0; i < 16; i++) {
+        if (PID_MAP[i] == pid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// Scrambler: multiplicative x^9 + x^4 + 1, MSB first. Each block starts
+// from IL2P_SCRAMBLE_INIT as the last 9 scrambled bits (newest in bit 0).
+// ============================================================================
+static void scramble(uint8_t* data, size_t len) {
+    uint16_t state = IL2P_SCRAMBLE_INIT;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = 0;
+        for (int b = 7; b >= 0; b--) {
+            uint8_t out = ((data[i] >> b) ^ (state >> 3) ^ (state >> 8)) & 1;
+            state = (uint16_t)(((state << 1) | out) & 0x1FF);
+            byte |= (uint8_t)(out << b);
+        }
+        data[i] = byte;
+    }
+}
+
+static void descramble(uint8_t* data, size_t len) {
+    uint16_t state = IL2P_SCRAMBLE_INIT;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = 0;
+        for (int b = 7; b >= 0; b--) {
+            uint8_t in = (data[i] >> b) & 1;
+            byte |= (uint8_t)(((in ^ (state >> 3) ^ (state >> 8)) & 1) << b);
+            state = (uint16_t)(((state << 1) | in) & 0x1FF);
+        }
+        data[i] = byte;
+    }
+}
+
+// ============================================================================
+// Payload blocks: large blocks (one byte longer) first
+// ============================================================================
+struct Il2pBlocks {
+    size_t count;
+    size_t small;               // Data bytes of a small block
+    size_t large_count;
+    uint8_t parity;             // Parity bytes per block
+
+    Il2pBlocks(size_t payload, bool max_fec) {
+        size_t limit = max_fec ? IL2P_MAX_FEC_BLOCK : IL2P_MAX_BLOCK;
+        count = (payload + limit - 1) / limit;
+        small = count ? payload / count : 0;
+        large_count = payload - count * small;
+        parity = max_fec ? IL2P_MAX_FEC_PARITY : (uint8_t)(2 + small / 32);
+    }
+
+    size_t size(size_t i) const { return small + (i < large_count ? 1 : 0); }
+    size_t bytes(size_t payload) const { return payload + count * parity; }
+
+    // A full 247-byte baseline block takes 9 parity bytes, one more than
+    // a Reed-Solomon codeword holds
+    bool fits() const { return count == 0 || size(0) + parity <= RS_SYMBOLS; }
+};
+
+// ============================================================================
+// Translation
+// ============================================================================
+static bool sixbit(const AX25AddressView& address) {
+    const uint8_t* raw = address.raw();
+    for (size_t i = 0; i < 6; i++) {
+        uint8_t c = raw[i] >> 1;
+        if ((raw[i] & 1) || c < 0x20 || c > 0x5F) {
+            return false;
+        }
+    }
+    return (raw[6] & 0x60) == 0x60;
+}
+
+// UI flag, PID code and 7-bit control field of a modulo-8 frame
+// I frame: P/F, N(R), N(S)    S frame: P/F, N(R), C, type
+// U frame: P/F, opcode, C
+static bool type1Fields(const AX25FrameView& view, bool* ui, int* pid, unsigned* control) {
+    uint8_t c = view.control();
+    unsigned pf = (c & 0x10) ? IL2P_CTRL_PF : 0;
+    unsigned command = view.destination().isRepeated() ? IL2P_CTRL_C : 0;
+    *ui = false;
+    if ((c & 0x01) == 0) {
+        *pid = pidCode(view.pid());
+        *control = pf | ((c >> 5) << 3) | ((c >> 1) & 0x07);
+        return *pid >= 0;
+    }
+    if ((c & 0x03) == 0x01) {
+        *pid = IL2P_PID_S;
+        *control = pf | ((c >> 5) << 3) | command | ((c >> 2) & 0x03);
+        return true;
+    }
+    for (unsigned op = 0; op < 8; op++) {
+        if (U_CONTROL[op] == (c & 0xEF)) {
+            *ui = (op == IL2P_U_UI);
+            *pid = *ui ? pidCode(view.pid()) : IL2P_PID_U;
+            *control = pf | (op << 3) | command;
+            return *pid >= 0;
+        }
+    }
+    return false;
+}
+
+bool Il2pCodec::translatable(const uint8_t* frame, size_t len) {
+    AX25FrameView view;
+    if (!frame || len < 2 || !view.parse(frame, len - 2)) {
+        return false;
+    }
+    bool ui;
+    int pid;
+    unsigned control;
+    return view.pathLength() == 0 && sixbit(view.destination()) && sixbit(view.source()) &&
+           type1Fields(view, &ui, &pid, &control);
+}
+
+// Header and payload of a frame; returns the payload length
+static size_t buildHeader(const uint8_t* frame, size_t len, bool max_fec,
+                          uint8_t hdr[IL2P_HEADER_LEN], const uint8_t** payload) {
+    memset(hdr, 0, IL2P_HEADER_LEN);
+    size_t count;
+    if (Il2pCodec::translatable(frame, len)) {
+        AX25FrameView view;
+        view.parse(frame, len - 2);
+        bool ui;
+        int pid;
+        unsigned control;
+        type1Fields(view, &ui, &pid, &control);
+        for (size_t i = 0; i < 6; i++) {
+            hdr[i] = (uint8_t)((frame[i] >> 1) - 0x20);
+            hdr[6 + i] = (uint8_t)((frame[AX25_ADDR_LEN + i] >> 1) - 0x20);
+        }
+        hdr[12] = (uint8_t)((view.destination().ssid() << 4) | view.source().ssid());
+        if (ui) {
+            hdr[0] |= IL2P_HDR_UI;
+        }
+        hdr[1] |= IL2P_HDR_TYPE_1;
+        setField(hdr, 6, 1, 4, (unsigned)pid);
+        setField(hdr, 6, 5, 7, control);
+        *payload = view.info();
+        count = view.infoLength();
+    } else {
+        *payload = frame;
+        count = len - 2;        // The FCS is replaced by the block parity
+    }
+    if (max_fec) {
+        hdr[0] |= IL2P_HDR_MAX_FEC;
+    }
+    setField(hdr, 7, 2, 10, (unsigned)count);
+    return count;
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+size_t Il2pCodec::frameBytes(const uint8_t* frame, size_t len, bool max_fec) {
+    if (!frame || len < 3 || len - 2 > IL2P_MAX_PAYLOAD) {
+        return 0;
+    }
+    uint8_t hdr[IL2P_HEADER_LEN];
+    const uint8_t* payload;
+    size_t count = buildHeader(frame, len, max_fec, hdr, &payload);
+    Il2pBlocks blocks(count, max_fec);
+    if (!blocks.fits()) {
+        return 0;
+    }
+    return IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY + blocks.bytes(count);
+}
+
+size_t Il2pCodec::encode(const uint8_t* frame, size_t len, bool max_fec,
+                         uint8_t* out, size_t capacity) {
+    if (!frame || !out || len < 3 || len - 2 > IL2P_MAX_PAYLOAD) {
+        return 0;
+    }
+    uint8_t* hdr = out + IL2P_SYNC_LEN;
+    if (capacity < IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY) {
+        return 0;
+    }
+    const uint8_t* payload;
+    size_t count = buildHeader(frame, len, max_fec, hdr, &payload);
+    Il2pBlocks blocks(count, max_fec);
+    size_t total = IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY + blocks.bytes(count);
+    if (!blocks.fits() || total > capacity) {
+        return 0;
+    }
+
+    out[0] = (uint8_t)(IL2P_SYNC_WORD >> 16);
+    out[1] = (uint8_t)(IL2P_SYNC_WORD >> 8);
+    out[2] = (uint8_t)IL2P_SYNC_WORD;
+
+    static const ReedSolomon header_rs(IL2P_HEADER_PARITY, IL2P_RS_FCR);
+    scramble(hdr, IL2P_HEADER_LEN);
+    header_rs.encode(hdr, IL2P_HEADER_LEN, hdr + IL2P_HEADER_LEN);
+
+    uint8_t* pos = hdr + IL2P_HEADER_LEN + IL2P_HEADER_PARITY;
+    if (blocks.count > 0) {
+        ReedSolomon rs(blocks.parity, IL2P_RS_FCR);
+        for (size_t i = 0; i < blocks.count; i++) {
+            size_t n = blocks.size(i);
+            memcpy(pos, payload, n);
+            scramble(pos, n);
+            rs.encode(pos, n, pos + n);
+            payload += n;
+            pos += n + blocks.parity;
+        }
+    }
+    return total;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+size_t Il2pCodec::decode(const uint8_t* in, size_t len, uint8_t* frame, size_t capacity,
+                         int* corrected) {
+    const size_t head = IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY;
+    if (!in || !frame || len < head ||
+        in[0] != (uint8_t)(IL2P_SYNC_WORD >> 16) || in[1] != (uint8_t)(IL2P_SYNC_WORD >> 8) ||
+        in[2] != (uint8_t)IL2P_SYNC_WORD) {
+        return 0;
+    }
+
+    static const ReedSolomon header_rs(IL2P_HEADER_PARITY, IL2P_RS_FCR);
+    uint8_t hdr[IL2P_HEADER_LEN + IL2P_HEADER_PARITY];
+    memcpy(hdr, in + IL2P_SYNC_LEN, sizeof(hdr));
+    int fixed = header_rs.decode(hdr, sizeof(hdr));
+    if (fixed < 0) {
+        return 0;
+    }
+    descramble(hdr, IL2P_HEADER_LEN);
+
+    bool max_fec = (hdr[0] & IL2P_HDR_MAX_FEC) != 0;
+    size_t count = getField(hdr, 7, 2, 10);
+    Il2pBlocks blocks(count, max_fec);
+    if (!blocks.fits() || len < head + blocks.bytes(count)) {
+        return 0;
+    }
+
+    // Translated frames get their addresses, control and PID back first
+    size_t pos = 0;
+    bool type1 = (hdr[1] & IL2P_HDR_TYPE_1) != 0;
+    if (type1) {
+        bool ui = (hdr[0] & IL2P_HDR_UI) != 0;
+        unsigned code = getField(hdr, 6, 1, 4);
+        unsigned control = getField(hdr, 6, 5, 7);
+        uint8_t pf = (control & IL2P_CTRL_PF) ? 0x10 : 0;
+        bool command = (control & IL2P_CTRL_C) != 0;
+        int16_t pid = -1;
+        uint8_t c;
+        if (ui || code > IL2P_PID_U) {
+            pid = PID_MAP[code];
+            if (pid < 0) {
+                return 0;
+            }
+        }
+        if (ui) {
+            c = AX25_CTRL_UI | pf;
+        } else if (code == IL2P_PID_S) {
+            c = (uint8_t)((((control >> 3) & 0x07) << 5) | pf | ((control & 0x03) << 2) | 0x01);
+        } else if (code == IL2P_PID_U) {
+            c = (uint8_t)(U_CONTROL[(control >> 3) & 0x07] | pf);
+        } else {
+            c = (uint8_t)((((control >> 3) & 0x07) << 5) | pf | ((control & 0x07) << 1));
+            command = true;     // I frames are always commands
+        }
+        size_t overhead = 2 * AX25_ADDR_LEN + 1 + (pid >= 0 ? 1 : 0);
+        if (capacity < overhead) {
+            return 0;
+        }
+        for (size_t i = 0; i < 6; i++) {
+            frame[i] = (uint8_t)(((hdr[i] & 0x3F) + 0x20) << 1);
+            frame[AX25_ADDR_LEN + i] = (uint8_t)(((hdr[6 + i] & 0x3F) + 0x20) << 1);
+        }
+        frame[6] = (uint8_t)(0x60 | ((hdr[12] >> 4) << 1) | (command ? 0x80 : 0));
+        frame[13] = (uint8_t)(0x60 | ((hdr[12] & 0x0F) << 1) | (command ? 0 : 0x80) | AX25_SSID_LAST);
+        frame[14] = c;
+        if (pid >= 0) {
+            frame[15] = (uint8_t)pid;
+        }
+        pos = overhead;
+    }
+    if (pos + count > capacity) {
+        return 0;
+    }
+
+    const uint8_t* block = in + head;
+    if (blocks.count > 0) {
+        ReedSolomon rs(blocks.parity, IL2P_RS_FCR);
+        uint8_t buf[RS_SYMBOLS];
+        for (size_t i = 0; i < blocks.count; i++) {
+            size_t n = blocks.size(i);
+            memcpy(buf, block, n + blocks.parity);
+            int f = rs.decode(buf, n + blocks.parity);
+            if (f < 0) {
+                return 0;
+            }
+            fixed += f;
+            descramble(buf, n);
+            memcpy(frame + pos, buf, n);
+            pos += n;
+            block += n + blocks.parity;
+        }
+    }
+    if (corrected) {
+        *corrected = fixed;
+    }
+    return AX25FrameBuilder::appendFcs(frame, pos, capacity);
+}
+
+} // namespace APRS
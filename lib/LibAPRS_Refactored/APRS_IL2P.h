@@ -0,0 +1,100 @@
+#ifndef APRS_IL2P_H
+#define APRS_IL2P_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// IL2P Constants
+// ============================================================================
+#define IL2P_SYNC_WORD      0xF15E48    // 24 bits, sent MSB first
+#define IL2P_SYNC_LEN       3
+#define IL2P_PREAMBLE       0x55        // Preamble and tail byte
+#define IL2P_HEADER_LEN     13
+#define IL2P_HEADER_PARITY  2
+#define IL2P_MAX_BLOCK      247         // Data bytes per payload block
+#define IL2P_MAX_FEC_BLOCK  239         // Data bytes per payload block with max FEC
+#define IL2P_MAX_FEC_PARITY 16          // Parity per block with max FEC
+#define IL2P_MAX_PAYLOAD    1023        // 10-bit payload byte count
+#define IL2P_RS_FCR         0           // First consecutive root of the generator
+#define IL2P_SCRAMBLE_INIT  0x1FF       // Scrambler state at the start of each block
+
+// On-air bytes (sync word through the last parity byte) for a payload,
+// worst case over both FEC levels
+#define IL2P_MAX_FRAME_BYTES(payload) \
+    (IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY + (payload) + \
+     (((payload) + IL2P_MAX_FEC_BLOCK - 1) / IL2P_MAX_FEC_BLOCK) * IL2P_MAX_FEC_PARITY)
+
+// ============================================================================
+// IL2P Codec
+// ============================================================================
+
+/**
+ * IL2P (Improved Layer 2 Protocol) framing of AX.25 frames
+ *
+ * A frame is the sync word, a 13-byte header with 2 Reed-Solomon parity
+ * bytes, and the payload in blocks of at most IL2P_MAX_BLOCK bytes, each
+ * followed by its own parity (2 + block/32 bytes), or with max FEC blocks
+ * of at most IL2P_MAX_FEC_BLOCK bytes and 16 parity bytes. Header and
+ * payload blocks are scrambled (multiplicative, x^9 + x^4 + 1, restarted
+ * per block) before the parity is computed. Everything is sent MSB first
+ * with no bit stuffing; the sync word and RS blocks replace HDLC flags and
+ * FCS. A single 247-byte baseline block would need a 256-byte codeword,
+ * so frames with exactly that payload cannot be sent.
+ *
+ * A modulo-8 I, S or U frame between two stations (no digipeaters) with a
+ * callsign alphabet and PID the header can carry is translated (header
+ * type 1): callsigns, SSIDs, control and PID go into the header as 6-bit
+ * characters and bit fields, and only the information field is payload.
+ * Anything else, including every frame with a path, goes out transparent
+ * (header type 0) with the whole frame, addresses through PID and info,
+ * as payload.
+ */
+class Il2pCodec {
+public:
+    /**
+     * On-air bytes for a frame, sync word through the last parity byte
+     * @param frame Encoded AX.25 frame (addresses through FCS)
+     * @param len Frame length
+     * @param max_fec 16 parity bytes per payload block
+     * @return 0 if the frame cannot be sent
+     */
+    static size_t frameBytes(const uint8_t* frame, size_t len, bool max_fec);
+
+    /**
+     * Build the on-air IL2P frame
+     * @param out Output buffer (IL2P_MAX_FRAME_BYTES(len) always fits)
+     * @return Frame length, or 0 if it does not fit
+     */
+    static size_t encode(const uint8_t* frame, size_t len, bool max_fec,
+                         uint8_t* out, size_t capacity);
+
+    /**
+     * Correct a received IL2P frame and rebuild its AX.25 frame
+     *
+     * A translated frame comes back with a fresh FCS; its command/response
+     * bits are either destination C set (command, and every I frame) or
+     * source C set (response).
+     *
+     * @param in Sync word, header and payload as received
+     * @param len Bytes available
+     * @param frame Receives the frame, addresses through FCS
+     * @param capacity Frame buffer size
+     * @param corrected Receives the bytes the parity corrected (optional)
+     * @return Frame length, or 0 if the sync word is missing or a block
+     *         could not be corrected
+     */
+    static size_t decode(const uint8_t* in, size_t len, uint8_t* frame, size_t capacity,
+                         int* corrected = nullptr);
+
+    /**
+     * True if the frame gets the compact (type 1) header
+     */
+    static bool translatable(const uint8_t* frame, size_t len);
+};
+
+} // namespace APRS
+
+#endif // APRS_IL2P_H
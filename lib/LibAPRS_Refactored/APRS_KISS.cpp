@@ -0,0 +1,215 @@
+#include "APRS_KISS.h"
+#include "APRS_AX25.h"
+
+namespace APRS {
+
+#define KISS_READ_TIMEOUT_MS    100     // Transport read wait per service()
+#define KISS_RETRY_MS           20      // Queue full: wait before retrying
+
+KissTnc::KissTnc()
+    : _transport(nullptr), _protocol(nullptr), _engine(nullptr), _task(nullptr),
+      _txLock(nullptr), _persistence(KISS_DEFAULT_P), _slotMs(KISS_DEFAULT_SLOT * 10),
+      _fullDuplex(false), _rxPos(0), _rxLen(0), _frameLen(0), _escape(false),
+      _overflow(false), _pending(false), _pendingLen(0) {
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+bool KissTnc::begin(KissTransport* transport, Protocol* protocol, TxEngine* engine,
+                    const KissConfig& config) {
+    if (_transport || !transport || !protocol || !engine || !engine->isStarted()) {
+        return false;
+    }
+
+    _txLock = HAL::lockCreate();
+    if (!_txLock) {
+        return false;
+    }
+    _protocol = protocol;
+    _engine = engine;
+    _config = config;
+    _engine->setChannelAccess(_persistence, _slotMs, _fullDuplex);
+    _transport = transport;
+
+    if (_config.use_task) {
+        if (!HAL::taskStart(taskEntry, this, "aprs_kiss", _config.stack_bytes,
+                            _config.priority, _config.core, &_task)) {
+            _transport = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Host to radio
+// ============================================================================
+bool KissTnc::service() {
+    if (!_transport) {
+        return false;
+    }
+
+    // Queue full: leave further bytes in the transport until a slot frees up
+    if (_pending && !submitPending()) {
+        HAL::delayMs(KISS_RETRY_MS);
+        return false;
+    }
+
+    if (_rxPos == _rxLen) {
+        _rxPos = 0;
+        _rxLen = _transport->read(_rx, RX_CHUNK, KISS_READ_TIMEOUT_MS);
+        if (_rxLen == 0) {
+            return false;
+        }
+    }
+    while (_rxPos < _rxLen && !_pending) {
+        receiveByte(_rx[_rxPos++]);
+    }
+    return true;
+}
+
+void KissTnc::receiveByte(uint8_t b) {
+    if (b == KISS_FEND) {
+        endFrame();
+        _frameLen = 0;
+        _escape = false;
+        _overflow = false;
+        return;
+    }
+
+    if (_escape) {
+        _escape = false;
+        if (b == KISS_TFEND) {
+            b = KISS_FEND;
+        } else if (b == KISS_TFESC) {
+            b = KISS_FESC;
+        }
+    } else if (b == KISS_FESC) {
+        _escape = true;
+        return;
+    }
+
+    // Keep two bytes free for the FCS
+    if (_frameLen < sizeof(_frame) - 2) {
+        _frame[_frameLen++] = b;
+    } else {
+        _overflow = true;
+    }
+}
+
+void KissTnc::endFrame() {
+    if (_frameLen == 0) {
+        return;     // Back-to-back FENDs
+    }
+    if (_frame[0] == KISS_CMD_RETURN) {
+        return;
+    }
+    if (_overflow || (_frame[0] >> 4) != 0) {
+        _stats.dropped++;
+        return;
+    }
+
+    uint8_t command = _frame[0] & 0x0F;
+    if (command != KISS_CMD_DATA) {
+        if (_frameLen < 2) {
+            _stats.dropped++;
+            return;
+        }
+        applyCommand(command, _frame[1]);
+        return;
+    }
+
+    AX25FrameView view;
+    size_t len = _frameLen - 1;
+    if (!view.parse(&_frame[1], len)) {
+        _stats.dropped++;
+        return;
+    }
+    _pendingLen = AX25FrameBuilder::appendFcs(&_frame[1], len, AX25_MAX_FRAME_LEN);
+    if (_pendingLen == 0) {
+        _stats.dropped++;
+        return;
+    }
+    _pending = true;
+    if (!submitPending()) {
+        _stats.stalls++;
+    }
+}
+
+bool KissTnc::submitPending() {
+    if (!_engine->submit(&_frame[1], _pendingLen)) {
+        return false;
+    }
+    _pending = false;
+    _stats.frames_in++;
+    return true;
+}
+
+void KissTnc::applyCommand(uint8_t command, uint8_t value) {
+    const ProtocolConfig& timing = _protocol->config();
+    switch (command) {
+        case KISS_CMD_TXDELAY:
+            _protocol->setTiming(value * 10, timing.tail_ms);
+            break;
+        case KISS_CMD_TXTAIL:
+            _protocol->setTiming(timing.preamble_ms, value * 10);
+            break;
+        case KISS_CMD_P:
+            _persistence = value;
+            break;
+        case KISS_CMD_SLOTTIME:
+            _slotMs = value * 10;
+            break;
+        case KISS_CMD_FULLDUPLEX:
+            _fullDuplex = (value != 0);
+            break;
+        default:
+            return;     // SETHW and unknown commands
+    }
+    _engine->setChannelAccess(_persistence, _slotMs, _fullDuplex);
+    _stats.commands++;
+}
+
+void KissTnc::taskEntry(void* arg) {
+    KissTnc* tnc = static_cast<KissTnc*>(arg);
+    for (;;) {
+        tnc->service();
+    }
+}
+
+// ============================================================================
+// Radio to host
+// ============================================================================
+bool KissTnc::sendFrame(const uint8_t* frame, size_t len) {
+    if (!_transport || !frame || len == 0 || len > AX25_MAX_FRAME_LEN) {
+        return false;
+    }
+
+    HAL::lockTake(_txLock);
+    size_t pos = 0;
+    _out[pos++] = KISS_FEND;
+    _out[pos++] = KISS_CMD_DATA;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = frame[i];
+        if (b == KISS_FEND) {
+            _out[pos++] = KISS_FESC;
+            _out[pos++] = KISS_TFEND;
+        } else if (b == KISS_FESC) {
+            _out[pos++] = KISS_FESC;
+            _out[pos++] = KISS_TFESC;
+        } else {
+            _out[pos++] = b;
+        }
+    }
+    _out[pos++] = KISS_FEND;
+    bool ok = _transport->write(_out, pos) == pos;
+    if (ok) {
+        _stats.frames_out++;
+    }
+    HAL::lockGive(_txLock);
+    return ok;
+}
+
+} // namespace APRS
@@ -0,0 +1,177 @@
+#ifndef APRS_KISS_H
+#define APRS_KISS_H
+
+#include "APRS_HAL.h"
+#include "APRS_Protocol.h"
+#include "APRS_TxEngine.h"
+
+namespace APRS {
+
+// ============================================================================
+// KISS Constants
+// ============================================================================
+#define KISS_FEND           0xC0    // Frame end
+#define KISS_FESC           0xDB    // Frame escape
+#define KISS_TFEND          0xDC    // Transposed FEND
+#define KISS_TFESC          0xDD    // Transposed FESC
+
+#define KISS_CMD_DATA       0x00    // AX.25 frame (no FCS)
+#define KISS_CMD_TXDELAY    0x01    // Preamble, 10 ms units
+#define KISS_CMD_P          0x02    // p-persistence, 0-255
+#define KISS_CMD_SLOTTIME   0x03    // Slot time, 10 ms units
+#define KISS_CMD_TXTAIL     0x04    // Tail, 10 ms units
+#define KISS_CMD_FULLDUPLEX 0x05    // Non-zero: ignore the channel
+#define KISS_CMD_SETHW      0x06    // Hardware specific (ignored)
+#define KISS_CMD_RETURN     0xFF    // Exit KISS (ignored: always KISS)
+
+#define KISS_DEFAULT_P      63      // Persistence until the host sets P
+#define KISS_DEFAULT_SLOT   10      // Slot time until the host sets SLOTTIME
+
+// ============================================================================
+// Transport
+// ============================================================================
+
+/**
+ * Byte stream to the host: a UART, a TCP socket or a host pty
+ */
+class KissTransport {
+public:
+    virtual ~KissTransport() {}
+
+    /**
+     * Read whatever is available, waiting up to timeout_ms for the first byte
+     * @return Bytes read (0 on timeout)
+     */
+    virtual size_t read(uint8_t* data, size_t max, uint32_t timeout_ms) = 0;
+
+    /**
+     * Write all bytes
+     * @return Bytes written
+     */
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+};
+
+// ============================================================================
+// KISS TNC Configuration
+// ============================================================================
+struct KissConfig {
+    bool use_task = true;           // false: caller drains with service()
+    int8_t core = 1;                // Core for the KISS task (-1: no affinity)
+    uint8_t priority = 2;           // KISS task priority
+    uint32_t stack_bytes = 3072;    // KISS task stack
+};
+
+// ============================================================================
+// KISS TNC Statistics
+// ============================================================================
+struct KissStats {
+    uint32_t frames_in = 0;         // Data frames queued for transmission
+    uint32_t frames_out = 0;        // Received frames sent to the host
+    uint32_t commands = 0;          // Parameter commands applied
+    uint32_t dropped = 0;           // Malformed, oversize or other-port frames
+    uint32_t stalls = 0;            // Frames that waited for queue room
+};
+
+// ============================================================================
+// KISS TNC
+// ============================================================================
+
+/**
+ * KISS framing between a host and the TX engine
+ *
+ * Data frames from the host get an FCS and go to the TxEngine queue;
+ * TXDELAY and TXTAIL set the Protocol preamble and tail, P, SLOTTIME and
+ * FullDuplex the engine's channel access. sendFrame() passes received
+ * frames back to the host.
+ *
+ * Modulation runs on the TX task, so the host can send frames back to back
+ * while one is on the air. When the queue is full the TNC stops reading the
+ * transport until a slot frees up: bytes wait in the transport (UART FIFO,
+ * socket buffer) instead of being dropped.
+ */
+class KissTnc {
+public:
+    KissTnc();
+
+    /**
+     * Start the TNC
+     *
+     * @param transport Host byte stream (must outlive the TNC)
+     * @param protocol Protocol that takes TXDELAY/TXTAIL
+     * @param engine Started TX engine that takes data frames
+     * @param config TNC configuration
+     * @return true on success
+     */
+    bool begin(KissTransport* transport, Protocol* protocol, TxEngine* engine,
+               const KissConfig& config);
+
+    /**
+     * True once begin() succeeded
+     */
+    bool isStarted() const { return _transport != nullptr; }
+
+    /**
+     * True if a KISS task reads the transport (false: call service())
+     */
+    bool isRunning() const { return _task != nullptr; }
+
+    /**
+     * Read and decode one chunk from the transport on the calling task
+     * @return true if any bytes were processed
+     */
+    bool service();
+
+    /**
+     * Send a frame to the host as a KISS data frame (one transport write)
+     *
+     * @param frame AX.25 frame without FCS, e.g. from the Demodulator
+     * @param len Frame length
+     * @return true if written
+     */
+    bool sendFrame(const uint8_t* frame, size_t len);
+
+    const KissStats& stats() const { return _stats; }
+
+private:
+    static const size_t RX_CHUNK = 128;
+
+    KissTransport* _transport;
+    Protocol* _protocol;
+    TxEngine* _engine;
+    KissConfig _config;
+    KissStats _stats;
+    HAL::Task _task;
+    HAL::Lock _txLock;
+
+    // Channel access as last set by the host
+    uint8_t _persistence;
+    uint16_t _slotMs;
+    bool _fullDuplex;
+
+    // Bytes read from the transport, not yet decoded
+    uint8_t _rx[RX_CHUNK];
+    size_t _rxPos;
+    size_t _rxLen;
+
+    // Frame being decoded: type byte, then the AX.25 frame plus room for FCS
+    uint8_t _frame[1 + AX25_MAX_FRAME_LEN];
+    size_t _frameLen;
+    bool _escape;
+    bool _overflow;
+    bool _pending;                  // _frame holds a data frame awaiting queue room
+    size_t _pendingLen;
+
+    // Escaped frame to the host
+    uint8_t _out[2 * (1 + AX25_MAX_FRAME_LEN) + 2];
+
+    void receiveByte(uint8_t b);
+    void endFrame();
+    void applyCommand(uint8_t command, uint8_t value);
+    bool submitPending();
+
+    static void taskEntry(void* arg);
+};
+
+} // namespace APRS
+
+#endif // APRS_KISS_H
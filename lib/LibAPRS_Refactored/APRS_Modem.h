@@ -0,0 +1,221 @@
+#ifndef APRS_MODEM_H
+#define APRS_MODEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// Modem Limits
+// ============================================================================
+#define MODEM_MAX_SAMPLES_PER_BIT   384     // Block modulator buffer (one write)
+#define MODEM_MAX_BLOCK_PHASES      64
+#define DDS_TABLE_BITS              10
+#define DDS_TABLE_LEN               (1 << DDS_TABLE_BITS)
+#define SAMPLE_SIN_LEN              4096    // Sample modulator phase per cycle
+
+// ============================================================================
+// Modem Profile
+// ============================================================================
+
+/**
+ * Everything the modulator needs for one sample rate / baud / tone pair,
+ * computed at compile time by Modem<> and read by Protocol at run time
+ */
+struct ModemProfile {
+    uint32_t sample_rate;       // Hz
+    uint16_t baud;
+    uint16_t mark_freq;         // Hz
+    uint16_t space_freq;        // Hz
+    uint16_t samples_per_bit;
+    uint16_t mark_inc;          // Sample modulator (SAMPLE_SIN_LEN per cycle)
+    uint16_t space_inc;
+    uint32_t dds_mark_inc;      // DDS modulator (2^32 per cycle)
+    uint32_t dds_space_inc;
+    uint8_t block_phases;       // Distinct phases at a bit boundary
+    uint8_t block_step[2];      // Phase slots a mark / space bit advances
+    const uint8_t* wave8;       // Block bits [tone][phase][sample], 8-bit
+    const uint16_t* wave16;     // Same, value in the high byte
+    const int16_t* dds_table;   // DDS_TABLE_LEN + 1 entries, Q8 amplitude 127
+};
+
+// ============================================================================
+// Compile-time helpers
+// ============================================================================
+namespace ModemMath {
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+constexpr uint32_t lcm(uint32_t a, uint32_t b) {
+    return a / gcd(a, b) * b;
+}
+
+constexpr uint64_t divRound(uint64_t dividend, uint64_t divisor) {
+    return (dividend + divisor / 2) / divisor;
+}
+
+constexpr long roundHalfAway(double v) {
+    return v >= 0 ? (long)(v + 0.5) : -(long)(-v + 0.5);
+}
+
+// Taylor series of sin(x) for |x| <= pi/2; term n+1 = -term n * x^2 / ((2n)(2n+1))
+constexpr double sinSeries(double x2, double term, double sum, int n) {
+    return n > 14 ? sum : sinSeries(x2, -term * x2 / ((2.0 * n) * (2.0 * n + 1.0)), sum + term, n + 1);
+}
+
+constexpr double sinReduced(double x) {
+    return sinSeries(x * x, x, 0.0, 1);
+}
+
+/**
+ * sin(2 pi num / den) for 0 <= num < den, folded onto [-pi/2, pi/2] in
+ * exact integer arithmetic first
+ */
+constexpr double sinTurns(uint64_t num, uint64_t den) {
+    return (4 * num < den) ? sinReduced(6.283185307179586 * (double)num / (double)den)
+         : (4 * num < 3 * den) ? sinReduced(6.283185307179586 * ((double)den - 2.0 * (double)num) / (2.0 * (double)den))
+         : sinReduced(6.283185307179586 * ((double)num - (double)den) / (double)den);
+}
+
+// Index lists for table initializers (log depth, so long tables stay
+// within the template recursion limit)
+template <size_t... I> struct IndexList {
+    typedef IndexList type;
+};
+
+template <class A, class B> struct ConcatIndices;
+
+template <size_t... A, size_t... B>
+struct ConcatIndices<IndexList<A...>, IndexList<B...> > : IndexList<A..., (sizeof...(A) + B)...> {};
+
+template <size_t N>
+struct MakeIndices : ConcatIndices<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type> {};
+
+template <> struct MakeIndices<0> : IndexList<> {};
+template <> struct MakeIndices<1> : IndexList<0> {};
+
+// ============================================================================
+// DDS sine table (shared by every modem)
+// ============================================================================
+template <typename Indices = typename MakeIndices<DDS_TABLE_LEN + 1>::type> struct DdsTable;
+
+template <size_t... I>
+struct DdsTable<IndexList<I...> > {
+    static constexpr int16_t TABLE[sizeof...(I)] = {
+        (int16_t)roundHalfAway(127.0 * 256.0 * sinTurns(I % DDS_TABLE_LEN, DDS_TABLE_LEN))...
+    };
+};
+
+template <size_t... I>
+constexpr int16_t DdsTable<IndexList<I...> >::TABLE[sizeof...(I)];
+
+} // namespace ModemMath
+
+// ============================================================================
+// AFSK Modem
+// ============================================================================
+
+/**
+ * AFSK modem parameters resolved at compile time
+ *
+ * Samples per bit, phase increments and the per-bit waveform tables of the
+ * block modulator are constexpr, so each instantiation costs flash only
+ * (2 * BLOCK_PHASES * SAMPLES_PER_BIT bytes for each sample format) and
+ * nothing at start-up. Combinations that do not give a whole number of
+ * samples per bit, or that put a tone above Nyquist, do not compile.
+ * Pass &Modem<...>::PROFILE in the protocol configuration.
+ */
+template <uint32_t SampleRate, uint32_t Baud, uint32_t Mark, uint32_t Space>
+struct Modem {
+    static constexpr uint32_t SAMPLE_RATE = SampleRate;
+    static constexpr uint32_t BAUD = Baud;
+    static constexpr uint32_t MARK_FREQ = Mark;
+    static constexpr uint32_t SPACE_FREQ = Space;
+    static constexpr uint32_t SAMPLES_PER_BIT = SampleRate / Baud;
+
+    static_assert(Baud > 0 && SampleRate % Baud == 0, "samples per bit must be an integer");
+    static_assert(SAMPLES_PER_BIT >= 4 && SAMPLES_PER_BIT <= MODEM_MAX_SAMPLES_PER_BIT,
+                  "samples per bit out of range");
+    static_assert(Mark != Space && 2 * Mark < SampleRate && 2 * Space < SampleRate,
+                  "tones must be distinct and below Nyquist");
+
+    // A bit of tone f advances the phase by f / Baud cycles, so the phase at
+    // every bit boundary is a multiple of 1 / BLOCK_PHASES of a cycle
+    static constexpr uint32_t BLOCK_PHASES = ModemMath::lcm(Baud / ModemMath::gcd(Mark, Baud),
+                                                            Baud / ModemMath::gcd(Space, Baud));
+    static_assert(BLOCK_PHASES <= MODEM_MAX_BLOCK_PHASES, "too many block modulator phases");
+
+    static constexpr size_t WAVE_LEN = 2 * BLOCK_PHASES * SAMPLES_PER_BIT;
+
+    /**
+     * Block table sample i ([tone][phase][sample] flattened): phase slot
+     * plus k samples of the tone, in exact turns
+     */
+    static constexpr uint8_t waveSample(size_t i) {
+        return (uint8_t)ModemMath::roundHalfAway(
+            128.0 + 127.0 * ModemMath::sinTurns(
+                ((uint64_t)(i / SAMPLES_PER_BIT % BLOCK_PHASES) * SampleRate
+                 + (uint64_t)(i / (BLOCK_PHASES * SAMPLES_PER_BIT) ? Space : Mark)
+                   * (i % SAMPLES_PER_BIT) * BLOCK_PHASES) % ((uint64_t)BLOCK_PHASES * SampleRate),
+                (uint64_t)BLOCK_PHASES * SampleRate));
+    }
+
+    template <typename Indices> struct Tables;
+
+    template <size_t... I>
+    struct Tables<ModemMath::IndexList<I...> > {
+        static constexpr uint8_t WAVE8[sizeof...(I)] = { waveSample(I)... };
+        static constexpr uint16_t WAVE16[sizeof...(I)] = { (uint16_t)(waveSample(I) << 8)... };
+    };
+
+    typedef Tables<typename ModemMath::MakeIndices<WAVE_LEN>::type> Wave;
+
+    static constexpr ModemProfile PROFILE = {
+        SampleRate,
+        (uint16_t)Baud,
+        (uint16_t)Mark,
+        (uint16_t)Space,
+        (uint16_t)SAMPLES_PER_BIT,
+        (uint16_t)ModemMath::divRound((uint64_t)SAMPLE_SIN_LEN * Mark, SampleRate),
+        (uint16_t)ModemMath::divRound((uint64_t)SAMPLE_SIN_LEN * Space, SampleRate),
+        (uint32_t)ModemMath::divRound((uint64_t)Mark << 32, SampleRate),
+        (uint32_t)ModemMath::divRound((uint64_t)Space << 32, SampleRate),
+        (uint8_t)BLOCK_PHASES,
+        { (uint8_t)(Mark * BLOCK_PHASES / Baud % BLOCK_PHASES),
+          (uint8_t)(Space * BLOCK_PHASES / Baud % BLOCK_PHASES) },
+        Wave::WAVE8,
+        Wave::WAVE16,
+        ModemMath::DdsTable<>::TABLE
+    };
+};
+
+template <uint32_t R, uint32_t B, uint32_t M, uint32_t S>
+constexpr ModemProfile Modem<R, B, M, S>::PROFILE;
+
+template <uint32_t R, uint32_t B, uint32_t M, uint32_t S>
+template <size_t... I>
+constexpr uint8_t Modem<R, B, M, S>::Tables<ModemMath::IndexList<I...> >::WAVE8[sizeof...(I)];
+
+template <uint32_t R, uint32_t B, uint32_t M, uint32_t S>
+template <size_t... I>
+constexpr uint16_t Modem<R, B, M, S>::Tables<ModemMath::IndexList<I...> >::WAVE16[sizeof...(I)];
+
+// ============================================================================
+// Bell 202 (VHF APRS, 1200 baud)
+// ============================================================================
+typedef Modem<105600, 1200, 1200, 2200> Bell202;        // 88 samples/bit (default)
+typedef Modem<26400, 1200, 1200, 2200> Bell202_26k;     // 22 samples/bit
+typedef Modem<13200, 1200, 1200, 2200> Bell202_13k;     // 11 samples/bit
+
+// ============================================================================
+// HF APRS (300 baud, 1600/1800 Hz into SSB audio)
+// ============================================================================
+typedef Modem<105600, 300, 1600, 1800> Hf300;           // 352 samples/bit
+typedef Modem<13200, 300, 1600, 1800> Hf300_13k;        // 44 samples/bit
+
+} // namespace APRS
+
+#endif // APRS_MODEM_H
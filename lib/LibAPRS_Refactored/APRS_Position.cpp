@@ -54,4 +54,240 @@ bool convertLongitude(float lon, char* buffer) {
     return true;
 }
 
+// ============================================================================
+// Position Reports
+//
+// Float inputs are converted to integers once (microdegrees, 1/100 knot,
+// feet); the encoding itself is integer arithmetic and table lookups.
+// ============================================================================
+
+namespace {
+
+const char BASE91_ZERO = 33;                    // '!'
+const uint32_t COMPRESSED_CS_MAX = 91 * 91 - 1;
+const uint32_t COMPRESSED_SPEED_CODES = 90;
+
+// Compression type byte: current fix, NMEA source, origin "other tracker"
+const uint8_t COMPRESSION_CURRENT = 0x20;
+const uint8_t COMPRESSION_GGA = 2 << 3;         // cs is altitude
+const uint8_t COMPRESSION_RMC = 3 << 3;         // cs is course/speed
+const uint8_t COMPRESSION_TRACKER = 6;
+
+// ln(2) / ln(1.002), scaled by 1e5: altitude code per octave of feet
+const uint64_t ALTITUDE_CODES_PER_OCTAVE = 34692005;
+const uint64_t ALTITUDE_CODES_SCALE = 100000ull << 16;
+
+// Mic-E: a destination digit with its flag bit set, and the info offset
+const char MICE_FLAG = 'P';                     // 'P'-'Y' for 0-9
+const char MICE_CUSTOM = 'A';                   // 'A'-'J' for 0-9
+const char MICE_CURRENT = '`';                  // Current GPS data
+const uint8_t MICE_OFFSET = 28;
+const int32_t MICE_ALTITUDE_ZERO = 10000;       // Meters, 3 Base91 digits
+const uint32_t MICE_ALTITUDE_MAX = 91 * 91 * 91 - 1;
+
+int32_t roundToInt(double v) {
+    return (int32_t)(v < 0 ? v - 0.5 : v + 0.5);
+}
+
+// |degrees| in 1/100 minute from microdegrees
+uint32_t hundredthsOfMinute(int32_t microdegrees) {
+    uint32_t ud = (uint32_t)((microdegrees < 0) ? -microdegrees : microdegrees);
+    return (uint32_t)(((uint64_t)ud * 6 + 500) / 1000);
+}
+
+// Most significant digit first, value < 91^digits
+void writeBase91(uint32_t value, char* out, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)(BASE91_ZERO + value % 91);
+        value /= 91;
+    }
+}
+
+void writeDecimal(uint32_t value, char* out, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+// log2(x) in Q16 for x >= 1: integer part from the top bit, then one
+// fraction bit per squaring of the mantissa
+uint32_t log2Q16(uint32_t x) {
+    uint32_t top = 0;
+    while ((x >> top) > 1) {
+        top++;
+    }
+    uint32_t result = top << 16;
+    uint64_t y = ((uint64_t)x << 30) >> top;    // Mantissa in [1, 2), Q30
+    for (uint32_t bit = 1u << 15; bit != 0; bit >>= 1) {
+        y = (y * y) >> 30;
+        if (y >= (2ull << 30)) {
+            y >>= 1;
+            result |= bit;
+        }
+    }
+    return result;
+}
+
+// Nearest compressed speed code (1.08^s - 1 knots)
+uint32_t speedCode(float speed_knots) {
+    const uint32_t* up = PositionMath::SpeedTable<>::SPEED_UP;
+    int32_t centiknots = roundToInt(speed_knots * 100.0f);
+    uint32_t lo = 0, hi = COMPRESSED_SPEED_CODES - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if ((int32_t)up[mid] <= centiknots) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Nearest compressed altitude code (1.002^cs feet)
+uint32_t altitudeCode(float altitude_m) {
+    int32_t feet = roundToInt(altitude_m / 0.3048f);
+    if (feet <= 1) {
+        return 0;
+    }
+    uint64_t cs = ((uint64_t)log2Q16((uint32_t)feet) * ALTITUDE_CODES_PER_OCTAVE +
+                   ALTITUDE_CODES_SCALE / 2) / ALTITUDE_CODES_SCALE;
+    return (cs > COMPRESSED_CS_MAX) ? COMPRESSED_CS_MAX : (uint32_t)cs;
+}
+
+} // namespace
+
+size_t encodeCompressedPosition(const PositionReport& report, char table,
+                                char symbol, char* out) {
+    if (!isValidLatitude(report.lat) || !isValidLongitude(report.lon)) {
+        return 0;
+    }
+    
+    // 380926 and 190463 steps per degree span 91^4 codes pole to pole and
+    // around the globe
+    int64_t lat = roundToInt((double)report.lat * 1000000.0);
+    int64_t lon = roundToInt((double)report.lon * 1000000.0);
+    uint32_t y = (uint32_t)((380926 * (90000000 - lat) + 500000) / 1000000);
+    uint32_t x = (uint32_t)((190463 * (180000000 + lon) + 500000) / 1000000);
+    
+    out[0] = (table >= '0' && table <= '9') ? (char)('a' + table - '0') : table;
+    writeBase91(y, &out[1], 4);
+    writeBase91(x, &out[5], 4);
+    out[9] = symbol;
+    
+    uint8_t type = COMPRESSION_CURRENT | COMPRESSION_TRACKER;
+    if (report.hasCourseSpeed()) {
+        uint32_t course = (uint32_t)(report.course % 360);
+        out[10] = (char)(BASE91_ZERO + ((course + 2) / 4) % 90);
+        out[11] = (char)(BASE91_ZERO + speedCode(report.speed_knots));
+        type |= COMPRESSION_RMC;
+    } else if (report.has_altitude) {
+        writeBase91(altitudeCode(report.altitude_m), &out[10], 2);
+        type |= COMPRESSION_GGA;
+    } else {
+        out[10] = ' ';
+        out[11] = ' ';
+    }
+    out[12] = (char)(BASE91_ZERO + type);
+    return POSITION_COMPRESSED_LEN;
+}
+
+size_t encodeCourseSpeed(int16_t course, float speed_knots, char* out) {
+    uint32_t cse = (course > 0) ? (uint32_t)(course % 360) : 0;
+    int32_t spd = roundToInt(speed_knots);
+    writeDecimal(cse == 0 ? 360 : cse, out, 3);
+    out[3] = '/';
+    writeDecimal((spd < 0) ? 0 : (spd > 999) ? 999 : (uint32_t)spd, &out[4], 3);
+    return POSITION_COURSE_SPEED_LEN;
+}
+
+size_t encodeMicE(const PositionReport& report, MicEMessage message, char table,
+                  char symbol, char* dest, char* info) {
+    if (!isValidLatitude(report.lat) || !isValidLongitude(report.lon)) {
+        return 0;
+    }
+    
+    int32_t lat_ud = roundToInt((double)report.lat * 1000000.0);
+    int32_t lon_ud = roundToInt((double)report.lon * 1000000.0);
+    uint32_t lat = hundredthsOfMinute(lat_ud);
+    uint32_t lon = hundredthsOfMinute(lon_ud);
+    lon = (lon >= 180 * 6000) ? 180 * 6000 - 1 : lon;  // 180 is 179 59.99
+    uint32_t lon_deg = lon / 6000;
+    uint32_t lon_min = (lon / 100) % 60;
+    
+    // Destination: DDMMHH latitude digits. Message bits A-C (1 for M0,
+    // 0 for emergency) on the first three, then N, +100 and W flags.
+    uint8_t code = (uint8_t)message;
+    bool custom = message >= MicEMessage::Custom0 && message <= MicEMessage::Custom6;
+    uint8_t bits = (message == MicEMessage::Emergency) ? 0 : (uint8_t)(7 - (custom ? code - 7 : code));
+    writeDecimal(lat / 6000 * 10000 + (lat / 100) % 60 * 100 + lat % 100, dest, 6);
+    for (int i = 0; i < 3; i++) {
+        if (bits & (4 >> i)) {
+            dest[i] = (char)(dest[i] - '0' + (custom ? MICE_CUSTOM : MICE_FLAG));
+        }
+    }
+    bool flags[3] = { lat_ud >= 0, lon_deg < 10 || lon_deg >= 100, lon_ud < 0 };
+    for (int i = 0; i < 3; i++) {
+        if (flags[i]) {
+            dest[3 + i] = (char)(dest[3 + i] - '0' + MICE_FLAG);
+        }
+    }
+    dest[MICE_DEST_LEN] = '\0';
+    
+    // Longitude: degrees 0-9 as 90-99 and 100-109 as 80-89, both with the
+    // +100 flag; minutes 0-9 as 60-69
+    uint32_t d = (lon_deg < 10) ? lon_deg + 90 : (lon_deg < 100) ? lon_deg :
+                 (lon_deg < 110) ? lon_deg - 20 : lon_deg - 100;
+    info[0] = MICE_CURRENT;
+    info[1] = (char)(MICE_OFFSET + d);
+    info[2] = (char)(MICE_OFFSET + ((lon_min < 10) ? lon_min + 60 : lon_min));
+    info[3] = (char)(MICE_OFFSET + lon % 100);
+    
+    // Speed (knots) SP = tens, DC = units * 10 + course / 100, SE = course
+    // % 100. SP 0-3 is sent as 80-83 and DC 0-3 as 4-7 (course + 400):
+    // decoders take both modulo.
+    uint32_t speed = 0;
+    uint32_t course = 0;
+    if (report.hasCourseSpeed()) {
+        int32_t knots = roundToInt(report.speed_knots);
+        speed = (knots > 799) ? 799 : (uint32_t)knots;
+        course = (uint32_t)(report.course % 360);
+        course = (course == 0) ? 360 : course;
+    }
+    uint32_t sp = speed / 10;
+    uint32_t dc = speed % 10 * 10 + course / 100;
+    info[4] = (char)(MICE_OFFSET + ((sp < 4) ? sp + 80 : sp));
+    info[5] = (char)(MICE_OFFSET + ((dc < 4) ? dc + 4 : dc));
+    info[6] = (char)(MICE_OFFSET + course % 100);
+    info[7] = symbol;
+    info[8] = table;
+    size_t len = MICE_INFO_LEN;
+    
+    // Altitude: meters above -10000, then '}'
+    if (report.has_altitude) {
+        int32_t altitude = roundToInt(report.altitude_m) + MICE_ALTITUDE_ZERO;
+        altitude = (altitude < 0) ? 0 : altitude;
+        writeBase91(((uint32_t)altitude > MICE_ALTITUDE_MAX) ? MICE_ALTITUDE_MAX : (uint32_t)altitude,
+                    &info[len], 3);
+        info[len + 3] = '}';
+        len += MICE_ALTITUDE_LEN;
+    }
+    return len;
+}
+
+size_t encodeAltitude(float altitude_m, char* out) {
+    int32_t feet = roundToInt(altitude_m / 0.3048f);
+    out[0] = '/';
+    out[1] = 'A';
+    out[2] = '=';
+    if (feet < 0) {
+        out[3] = '-';
+        writeDecimal((feet < -99999) ? 99999 : (uint32_t)-feet, &out[4], 5);
+    } else {
+        writeDecimal((feet > 999999) ? 999999 : (uint32_t)feet, &out[3], 6);
+    }
+    return POSITION_ALTITUDE_LEN;
+}
+
 } // namespace APRS
@@ -2,6 +2,8 @@
 #define APRS_POSITION_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include "APRS_Modem.h"
 
 /**
  * APRS Position Utilities
@@ -12,6 +14,8 @@
  * APRS Format:
  * - Latitude:  DDMM.MMN (8 chars) e.g., "4906.14N" = 49.1023° North
  * - Longitude: DDDMM.MML (9 chars) e.g., "12238.19W" = -122.6365° West
+ * - Compressed: /YYYYXXXX$csT (13 chars, Base91), see encodeCompressedPosition()
+ * - Mic-E: latitude in the destination address, see encodeMicE()
  */
 
 namespace APRS {
@@ -54,6 +58,131 @@ inline bool isValidLongitude(float lon) {
     return lon >= -180.0f && lon <= 180.0f;
 }
 
+// ============================================================================
+// Position Reports
+// ============================================================================
+#define POSITION_COMPRESSED_LEN   13    // Table, YYYY, XXXX, symbol, c, s, T
+#define POSITION_COURSE_SPEED_LEN 7     // ccc/sss
+#define POSITION_ALTITUDE_LEN     9     // /A=aaaaaa
+#define MICE_DEST_LEN             6     // Destination callsign characters
+#define MICE_INFO_LEN             9     // Type, d m h, SP DC SE, symbol, table
+#define MICE_ALTITUDE_LEN         4     // xxx}
+
+/**
+ * Position report formats
+ */
+enum class PositionFormat : uint8_t {
+    Uncompressed,   // DDMM.MMN/DDDMM.MMW$, then PHG or ccc/sss and /A=
+    Compressed,     // /YYYYXXXX$csT, course/speed or altitude in cs
+    MicE            // Latitude in the destination, `dmhSDE$/ and xxx}
+};
+
+/**
+ * Mic-E message codes, carried in the first three destination characters
+ */
+enum class MicEMessage : uint8_t {
+    OffDuty,        // M0
+    EnRoute,        // M1
+    InService,      // M2
+    Returning,      // M3
+    Committed,      // M4
+    Special,        // M5
+    Priority,       // M6
+    Custom0,        // C0-C6: meaning agreed between stations
+    Custom1,
+    Custom2,
+    Custom3,
+    Custom4,
+    Custom5,
+    Custom6,
+    Emergency
+};
+
+/**
+ * A fix to report; course/speed and altitude are optional
+ */
+struct PositionReport {
+    float lat = 0.0f;           // Decimal degrees, positive north
+    float lon = 0.0f;           // Decimal degrees, positive east
+    int16_t course = -1;        // Degrees true (0-359), negative if unknown
+    float speed_knots = -1.0f;  // Negative if unknown
+    bool has_altitude = false;
+    float altitude_m = 0.0f;    // Above mean sea level
+
+    bool hasCourseSpeed() const { return course >= 0 && speed_knots >= 0.0f; }
+};
+
+namespace PositionMath {
+
+constexpr double pow108(size_t n) { return n == 0 ? 1.0 : 1.08 * pow108(n - 1); }
+
+// Compressed speed code s stands for 1.08^s - 1 knots. Speeds at or above
+// SPEED_UP[s] (1.08^(s + 1/2) - 1, in 1/100 knot) code to s + 1 or more:
+// the nearest code on the logarithmic scale.
+template <typename Indices = typename ModemMath::MakeIndices<89>::type> struct SpeedTable;
+
+template <size_t... I>
+struct SpeedTable<ModemMath::IndexList<I...> > {
+    static constexpr uint32_t SPEED_UP[sizeof...(I)] = {
+        (uint32_t)((pow108(I) * 1.0392304845413265 - 1.0) * 100.0 + 0.5)...
+    };
+};
+
+template <size_t... I>
+constexpr uint32_t SpeedTable<ModemMath::IndexList<I...> >::SPEED_UP[sizeof...(I)];
+
+} // namespace PositionMath
+
+/**
+ * Encode a compressed position (APRS 1.0.1 chapter 9), integer math only
+ * 
+ * Latitude and longitude are Base91 in 4 bytes each (about 0.3 m). The cs
+ * bytes carry course and speed when the report has both, otherwise the
+ * altitude, otherwise nothing (c is a space). A digit overlay table
+ * ('0'-'9') is sent as 'a'-'j'.
+ * 
+ * @param out At least POSITION_COMPRESSED_LEN bytes (not terminated)
+ * @return POSITION_COMPRESSED_LEN, or 0 if the coordinates are out of range
+ */
+size_t encodeCompressedPosition(const PositionReport& report, char table,
+                                char symbol, char* out);
+
+/**
+ * Encode a course/speed data extension "ccc/sss": course 001-360 (north
+ * is 360), speed in knots
+ * 
+ * @param out At least POSITION_COURSE_SPEED_LEN bytes (not terminated)
+ * @return POSITION_COURSE_SPEED_LEN
+ */
+size_t encodeCourseSpeed(int16_t course, float speed_knots, char* out);
+
+/**
+ * Encode an altitude comment "/A=aaaaaa" in feet ("/A=-aaaaa" below sea
+ * level)
+ * 
+ * @param out At least POSITION_ALTITUDE_LEN bytes (not terminated)
+ * @return POSITION_ALTITUDE_LEN
+ */
+size_t encodeAltitude(float altitude_m, char* out);
+
+/**
+ * Encode a Mic-E report (APRS 1.0.1 chapter 10), integer math only
+ * 
+ * The destination callsign carries the latitude digits, the message code,
+ * N/S, the longitude offset and E/W; the information field the longitude,
+ * speed and course, symbol and, when the report has one, the altitude.
+ * Unknown course/speed are sent as 0. Byte values below 0x20 are avoided
+ * where the format allows it.
+ * 
+ * @param dest Receives the destination callsign (MICE_DEST_LEN characters
+ *             and a terminator; SSID 0)
+ * @param info At least MICE_INFO_LEN + MICE_ALTITUDE_LEN bytes (not
+ *             terminated)
+ * @return Information field length, or 0 if the coordinates are out of range
+ */
+size_t encodeMicE(const PositionReport& report, MicEMessage message, char table,
+                  char symbol, char* dest, char* info);
+
 } // namespace APRS
 
 #endif // APRS_POSITION_H
@@ -1,9 +1,7 @@
-#include <Arduino.h>
 #include "APRS_Protocol.h"
-#include <driver/gpio.h>
-#include <driver/i2s.h>
+#include "APRS_AX25.h"
+#include "APRS_HAL.h"
 #include <string.h>
-#include <ctype.h>
 
 namespace APRS {
 
@@ -21,51 +19,54 @@ static const uint8_t SIN_TABLE[] = {
     176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131
 };
 
-#define SIN_LEN (512 * 8)  // 4096 with oversampling
 #define TRUE_SIN_LEN 512
-#define OVERSAMPLING 8
-
-// Calculate phase increments for MARK and SPACE frequencies
-#define DIV_ROUND(dividend, divisor) (((dividend) + (divisor) / 2) / (divisor))
-#define MARK_INC (uint16_t)(DIV_ROUND(SIN_LEN * (uint32_t)MARK_FREQ, SAMPLERATE))
-#define SPACE_INC (uint16_t)(DIV_ROUND(SIN_LEN * (uint32_t)SPACE_FREQ, SAMPLERATE))
-#define SWITCH_TONE(inc) (((inc) == MARK_INC) ? SPACE_INC : MARK_INC)
-
-// CRC-CCITT table
-static const uint16_t CRC_CCITT_TABLE[] = {
-    0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
-    0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
-    0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
-    0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
-    0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
-    0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
-    0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
-    0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
-    0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
-    0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
-    0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
-    0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
-    0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
-    0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
-    0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
-    0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
-    0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
-    0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
-    0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
-    0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
-    0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
-    0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
-    0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
-    0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
-    0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
-    0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
-    0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
-    0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
-    0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
-    0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
-    0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
-    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
-};
+#define OVERSAMPLING (SAMPLE_SIN_LEN / TRUE_SIN_LEN)
+
+// ============================================================================
+// Sample formats
+//
+// The modulators are templates over the sink's sample type: uint8_t for
+// SampleFormat::U8, uint16_t (value in the high byte) for U8Msb16.
+// ============================================================================
+static inline void putSample(uint8_t* out, uint8_t value) {
+    *out = value;
+}
+
+static inline void putSample(uint16_t* out, uint8_t value) {
+    *out = (uint16_t)value << 8;
+}
+
+// Block modulator bit waveforms ([tone][phase][sample], built by Modem<>)
+static inline const uint8_t* bitWave(const uint8_t*, const ModemProfile& m, uint8_t tone, uint8_t phase) {
+    return m.wave8 + ((size_t)tone * m.block_phases + phase) * m.samples_per_bit;
+}
+
+static inline const uint16_t* bitWave(const uint16_t*, const ModemProfile& m, uint8_t tone, uint8_t phase) {
+    return m.wave16 + ((size_t)tone * m.block_phases + phase) * m.samples_per_bit;
+}
+
+// ============================================================================
+// Fractional-phase DDS
+//
+// 32-bit phase accumulator (2^32 = one cycle) with a 1024-entry full-wave
+// table and linear interpolation. The increments resolve the tones to
+// sample_rate / 2^32 (about 25 uHz at 105.6 kHz) instead of the ~10 Hz
+// error of the sample modulator's increments.
+// ============================================================================
+#define DDS_FRAC_BITS (32 - DDS_TABLE_BITS)
+
+// ============================================================================
+// IL2P FEC level (always baseline in builds without APRS_IL2P, where no
+// framing other than Ax25 exists)
+// ============================================================================
+static inline bool il2pMaxFec(Framing framing) {
+#if APRS_IL2P
+    return framing == Framing::Il2pMaxFec;
+#else
+    (void)framing;
+    return false;
+#endif
+}
 
 // ============================================================================
 // Sine sample lookup with interpolation
@@ -82,63 +83,42 @@ uint8_t Protocol::sinSample(uint16_t phase) {
 // CRC calculation
 // ============================================================================
 uint16_t Protocol::updateCRC(uint8_t byte, uint16_t crc) {
-    return (crc >> 8) ^ CRC_CCITT_TABLE[(crc ^ byte) & 0xff];
+    return Crc16::updateByte(byte, crc);
 }
 
 // ============================================================================
-// FIFO Operations
+// PTT Control
 // ============================================================================
-bool Protocol::fifoIsEmpty() const {
-    return _fifo_head == _fifo_tail;
-}
-
-bool Protocol::fifoIsFull() const {
-    return ((_fifo_head + 1) % FIFO_SIZE) == _fifo_tail;
-}
-
-void Protocol::fifoPush(uint8_t byte) {
-    _fifo[_fifo_head] = byte;
-    _fifo_head = (_fifo_head + 1) % FIFO_SIZE;
-}
-
-uint8_t Protocol::fifoPop() {
-    uint8_t byte = _fifo[_fifo_tail];
-    _fifo_tail = (_fifo_tail + 1) % FIFO_SIZE;
-    return byte;
-}
-
-void Protocol::fifoFlush() {
-    _fifo_head = _fifo_tail = 0;
+void Protocol::setPTT(bool enable) {
+    HAL::pttWrite(_config.ptt_pin, pttLevel(enable));
 }
 
 // ============================================================================
-// I2S Initialization
+// Key-up timing
 // ============================================================================
-void Protocol::initI2S() {
-    i2s_config_t i2s_config = {
-        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN),
-        .sample_rate = SAMPLERATE,
-        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-        .channel_format = I2S_CHANNEL_FMT_ONLY_RIGHT,
-        .communication_format = I2S_COMM_FORMAT_STAND_MSB,
-        .intr_alloc_flags = 0,
-        .dma_buf_count = 2,
-        .dma_buf_len = 300,
-        .use_apll = true,
-        .tx_desc_auto_clear = true,
-        .fixed_mclk = 0
-    };
-    
-    i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL);
-    i2s_set_pin(I2S_NUM_0, NULL);
-    i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);
+void Protocol::setTiming(uint16_t preamble_ms, uint16_t tail_ms) {
+    _config.preamble_ms = preamble_ms;
+    _config.tail_ms = tail_ms;
 }
 
 // ============================================================================
-// PTT Control
+// Modem selection
 // ============================================================================
-void Protocol::setPTT(bool enable) {
-    gpio_set_level((gpio_num_t)_config.ptt_pin, enable ? 0 : 1);  // Active low
+void Protocol::setModem(const ModemProfile* modem) {
+    _nextModem = modem ? modem : &Bell202::PROFILE;
+}
+
+bool Protocol::applyModem() {
+    const ModemProfile* next = _nextModem;
+    if (next == _modem) {
+        return true;
+    }
+    if (next->sample_rate != _modem->sample_rate && !_sink->begin(next->sample_rate)) {
+        return false;
+    }
+    _modem = next;
+    _config.modem = next;
+    return true;
 }
 
 // ============================================================================
@@ -148,136 +128,233 @@ bool Protocol::begin(const ProtocolConfig& config) {
     _config = config;
     
     // Initialize PTT pin
-    gpio_set_direction((gpio_num_t)_config.ptt_pin, GPIO_MODE_OUTPUT);
+    HAL::pttBegin(_config.ptt_pin);
     setPTT(false);
     
-    // Initialize I2S
-    initI2S();
+    // Initialize audio output; the modulators render in its native format
+    // at the modem's rate
+    _modem = _config.modem ? _config.modem : &Bell202::PROFILE;
+    _nextModem = _modem;
+    _sink = _config.sink ? _config.sink : &_halSink;
+    if (!_sink->begin(_modem->sample_rate)) {
+        return false;
+    }
+    _format = _sink->format();
     
     // Initialize state
+    _keyed = false;
     _transmitting = false;
     _phaseAcc = 0;
-    _phaseInc = MARK_INC;
-    fifoFlush();
+    _phaseInc = _modem->mark_inc;
+    _tone = 0;
+    _stats = TxStats();
+    _encoder.begin(_bitstream, TX_BITSTREAM_BITS);
+    _bitPos = 0;
+    _framing = _config.framing;
+    _cache.begin(_cacheEntries, &_cacheWords[0][0], _config.render_cache ? TX_RENDER_CACHE_ENTRIES : 0,
+                 TX_BITSTREAM_WORDS);
     
     return true;
 }
 
+// ============================================================================
+// Advance to the next on-air bit
+//
+// The encoder has already applied stuffing and NRZI: each bit is a tone.
+// ============================================================================
+bool Protocol::nextBit() {
+    if (_bitPos == _encoder.length()) {
+        _transmitting = false;
+        return false;
+    }
+    _tone = _encoder.tone(_bitPos++) ? 1 : 0;
+    _phaseInc = _tone ? _modem->space_inc : _modem->mark_inc;
+    return true;
+}
+
 // ============================================================================
 // Generate AFSK sample
 // ============================================================================
 uint8_t Protocol::generateSample() {
     if (_sampleIndex == 0) {
-        if (_txBit == 0) {
-            if (fifoIsEmpty() && _tailLength == 0) {
-                _transmitting = false;
-                return 128;  // Silence
-            } else {
-                if (!_bitStuff) _bitstuffCount = 0;
-                _bitStuff = true;
-                
-                if (_preambleLength == 0) {
-                    if (fifoIsEmpty()) {
-                        _tailLength--;
-                        _currentOutputByte = HDLC_FLAG;
-                    } else {
-                        _currentOutputByte = fifoPop();
-                    }
-                } else {
-                    _preambleLength--;
-                    _currentOutputByte = HDLC_FLAG;
-                }
-                
-                if (_currentOutputByte == AX25_ESC) {
-                    if (!fifoIsEmpty()) {
-                        _currentOutputByte = fifoPop();
-                    } else {
-                        _transmitting = false;
-                        return 128;
-                    }
-                } else if (_currentOutputByte == HDLC_FLAG || _currentOutputByte == HDLC_RESET) {
-                    _bitStuff = false;
-                }
-            }
-            _txBit = 0x01;
-        }
-        
-        if (_bitStuff && _bitstuffCount >= BIT_STUFF_LEN) {
-            _bitstuffCount = 0;
-            _phaseInc = SWITCH_TONE(_phaseInc);
-        } else {
-            if (_currentOutputByte & _txBit) {
-                _bitstuffCount++;
-            } else {
-                _bitstuffCount = 0;
-                _phaseInc = SWITCH_TONE(_phaseInc);
-            }
-            _txBit <<= 1;
+        if (!nextBit()) {
+            return 128;  // Silence
         }
-        
-        _sampleIndex = SAMPLESPERBIT;
+        _sampleIndex = _modem->samples_per_bit;
     }
     
     _phaseAcc += _phaseInc;
-    _phaseAcc %= SIN_LEN;
+    _phaseAcc %= SAMPLE_SIN_LEN;
     _sampleIndex--;
     
     return sinSample(_phaseAcc);
 }
 
 // ============================================================================
-// Send AFSK modulated data
+// Generate AFSK sample (fractional-phase DDS)
+// ============================================================================
+uint8_t Protocol::generateSampleDds() {
+    if (_sampleIndex == 0) {
+        if (!nextBit()) {
+            return 128;  // Silence
+        }
+        _ddsInc = _tone ? _modem->dds_space_inc : _modem->dds_mark_inc;
+        _sampleIndex = _modem->samples_per_bit;
+    }
+    
+    _ddsPhase += _ddsInc;
+    _sampleIndex--;
+    
+    uint32_t idx = _ddsPhase >> DDS_FRAC_BITS;
+    int32_t frac = (_ddsPhase >> (DDS_FRAC_BITS - 15)) & 0x7FFF;
+    const int16_t* table = _modem->dds_table;
+    int32_t a = table[idx];
+    int32_t v = a + (((table[idx + 1] - a) * frac) >> 15);
+    
+    // Round Q8 to the 8-bit DAC value
+    return (uint8_t)((0x8000 + v + 0x80) >> 8);
+}
+
+// ============================================================================
+// Send AFSK modulated data (per-sample path)
 // ============================================================================
+template <typename Sample>
 void Protocol::sendAFSK() {
     const size_t BUF_SIZE = 256;
-    uint16_t sample_buf[BUF_SIZE];
+    Sample sample_buf[BUF_SIZE];
     
     while (_transmitting) {
-        for (size_t i = 0; i < BUF_SIZE && _transmitting; i++) {
+        size_t count = 0;
+        while (count < BUF_SIZE) {
             uint8_t sample = generateSample();
-            sample_buf[i] = (uint16_t)((int32_t)sample << 8);
+            if (!_transmitting) break;
+            putSample(&sample_buf[count++], sample);
         }
         
-        size_t bytes_written = 0;
-        i2s_write(I2S_NUM_0, sample_buf, BUF_SIZE * sizeof(uint16_t), 
-                 &bytes_written, portMAX_DELAY);
+        if (count > 0) {
+            _stats.samples += _sink->write(sample_buf, count);
+        }
+    }
+}
+
+// ============================================================================
+// Send AFSK modulated data (fractional-phase DDS path)
+// ============================================================================
+template <typename Sample>
+void Protocol::sendAFSKDds() {
+    const size_t BUF_SIZE = 256;
+    Sample sample_buf[BUF_SIZE];
+    
+    while (_transmitting) {
+        size_t count = 0;
+        while (count < BUF_SIZE) {
+            uint8_t sample = generateSampleDds();
+            if (!_transmitting) break;
+            putSample(&sample_buf[count++], sample);
+        }
+        
+        if (count > 0) {
+            _stats.samples += _sink->write(sample_buf, count);
+        }
     }
+}
+
+// ============================================================================
+// Send AFSK modulated data (block path)
+//
+// Each bit is a copy of a precomputed waveform segment selected by tone and
+// starting phase, so the per-sample work is a memcpy. A bit of tone f
+// advances the phase by f / baud cycles, so with exact tones the phase at
+// every bit boundary is one of block_phases slots (6 for Bell 202).
+// ============================================================================
+template <typename Sample>
+void Protocol::sendAFSKBlock() {
+    const size_t BUF_SIZE = MODEM_MAX_SAMPLES_PER_BIT;
+    Sample sample_buf[BUF_SIZE];
+    const ModemProfile& m = *_modem;
+    const size_t spb = m.samples_per_bit;
     
-    // Send silence to clear buffer
-    uint16_t silence[128];
-    for (int i = 0; i < 128; i++) {
-        silence[i] = 0x8000;  // DC offset
+    while (_transmitting) {
+        size_t count = 0;
+        while (count + spb <= BUF_SIZE && nextBit()) {
+            memcpy(&sample_buf[count], bitWave(sample_buf, m, _tone, _blockPhase),
+                   spb * sizeof(Sample));
+            _blockPhase = (_blockPhase + m.block_step[_tone]) % m.block_phases;
+            count += spb;
+        }
+        
+        if (count > 0) {
+            _stats.samples += _sink->write(sample_buf, count);
+        }
     }
-    size_t bytes_written = 0;
-    for (int i = 0; i < 10; i++) {
-        i2s_write(I2S_NUM_0, silence, sizeof(silence), &bytes_written, portMAX_DELAY);
+}
+
+// ============================================================================
+// Modulate the encoded segment with the configured modulator
+// ============================================================================
+void Protocol::modulate() {
+    _stats.bits += _encoder.length();
+    _bitPos = 0;
+    _transmitting = true;
+    bool u8 = (_format == SampleFormat::U8);
+    if (_config.modulator == ModulatorMode::Block) {
+        u8 ? sendAFSKBlock<uint8_t>() : sendAFSKBlock<uint16_t>();
+    } else if (_config.modulator == ModulatorMode::Dds) {
+        u8 ? sendAFSKDds<uint8_t>() : sendAFSKDds<uint16_t>();
+    } else {
+        u8 ? sendAFSK<uint8_t>() : sendAFSK<uint16_t>();
     }
 }
 
 // ============================================================================
-// Put byte into FIFO with HDLC escaping and CRC
+// Send silence (PTT lead and tail)
 // ============================================================================
-void Protocol::putByte(uint8_t byte) {
-    if (byte == HDLC_FLAG || byte == HDLC_RESET || byte == AX25_ESC) {
-        fifoPush(AX25_ESC);
+template <typename Sample>
+void Protocol::sendSilence(uint32_t count) {
+    const size_t BUF_SIZE = 128;
+    Sample silence[BUF_SIZE];
+    for (size_t i = 0; i < BUF_SIZE; i++) {
+        putSample(&silence[i], 128);  // DC offset
+    }
+    for (size_t left = count; left > 0; ) {
+        size_t n = (left < BUF_SIZE) ? left : BUF_SIZE;
+        _stats.samples += _sink->write(silence, n);
+        left -= n;
+    }
+}
+
+void Protocol::sendSilence(uint32_t count) {
+    if (_format == SampleFormat::U8) {
+        sendSilence<uint8_t>(count);
+    } else {
+        sendSilence<uint16_t>(count);
     }
-    _crc = updateCRC(byte, _crc);
-    fifoPush(byte);
 }
 
 // ============================================================================
-// Send AX.25 callsign
+// Encode AX.25 UI frame
 // ============================================================================
-void Protocol::sendCall(const AX25Call& call, bool last) {
-    // Send 6-character call (pad with spaces)
-    for (int i = 0; i < 6; i++) {
-        char c = (i < strlen(call.call)) ? toupper(call.call[i]) : ' ';
-        putByte(c << 1);
+size_t Protocol::encodeFrame(const AX25Call& src,
+                            const AX25Call& dst,
+                            const AX25Call* path,
+                            size_t path_len,
+                            const uint8_t* payload,
+                            size_t payload_len,
+                            uint8_t* out,
+                            size_t capacity) {
+    if (path_len > AX25_MAX_PATH) {
+        return 0;
     }
     
-    // Send SSID byte with address extension bit
-    uint8_t ssid = 0x60 | (call.ssid << 1) | (last ? 0x01 : 0);
-    putByte(ssid);
+    AX25FrameBuilder frame(out, capacity);
+    frame.addAddress(dst);
+    frame.addAddress(src);
+    for (size_t i = 0; i < path_len; i++) {
+        frame.addAddress(path[i]);
+    }
+    frame.addHeader(AX25_CTRL_UI, AX25_PID_NOLAYER3);
+    frame.addInfo(payload, payload_len);
+    return frame.finish();
 }
 
 // ============================================================================
@@ -289,72 +366,283 @@ bool Protocol::sendPacket(const AX25Call& src,
                          size_t path_len,
                          const uint8_t* payload,
                          size_t payload_len) {
-    if (_transmitting) {
+    if (_keyed) {
         return false;  // Already transmitting
     }
     
-    // Clear FIFO
-    fifoFlush();
-    
-    // Initialize CRC
-    _crc = 0xFFFF;
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodeFrame(src, dst, path, path_len, payload, payload_len,
+                             frame, sizeof(frame));
+    if (len == 0) {
+        return false;
+    }
     
-    // Build packet in FIFO
-    // Start flag
-    fifoPush(HDLC_FLAG);
+    return transmitFrame(frame, len);
+}
+
+// ============================================================================
+// Transmit an encoded AX.25 frame
+// ============================================================================
+bool Protocol::transmitFrame(const uint8_t* frame, size_t len) {
+    return transmitFrames(&frame, &len, 1);
+}
+
+// ============================================================================
+// Airtime accounting
+//
+// The public estimates use the modem, timing and framing the next key-up
+// will use (a setModem() still pending included); a key-up in progress
+// accounts with the modem it runs on.
+// ============================================================================
+uint32_t Protocol::airtimeMs(uint32_t bits) const {
+    return airtimeMs(bits, *_nextModem);
+}
+
+uint32_t Protocol::airtimeMs(uint32_t bits, const ModemProfile& modem) const {
+    uint32_t silence = pttSamples(_config.ptt_lead_ms, modem) + pttSamples(_config.ptt_tail_ms, modem);
+    uint64_t us = (uint64_t)bits * 1000000 / modem.baud
+                + (uint64_t)silence * 1000000 / modem.sample_rate;
+    return (uint32_t)((us + 500) / 1000);
+}
+
+// PTT lead and tail are sent as silence, so they are exact to one sample
+uint32_t Protocol::pttSamples(uint16_t ms, const ModemProfile& modem) const {
+    return (uint32_t)(((uint64_t)ms * modem.sample_rate + 500) / 1000);
+}
+
+uint16_t Protocol::preambleFlags(const ModemProfile& modem) const {
+    return ((uint32_t)_config.preamble_ms * modem.baud) / 8000;
+}
+
+uint16_t Protocol::tailFlags(const ModemProfile& modem) const {
+    return ((uint32_t)_config.tail_ms * modem.baud) / 8000;
+}
+
+uint32_t Protocol::keyupOverheadMs() const {
+    return keyupOverheadMs(*_nextModem);
+}
+
+uint32_t Protocol::keyupOverheadMs(const ModemProfile& modem) const {
+    // Preamble, opening flag and tail flags are the only bits a separate
+    // key-up adds; the frame body and its closing flag are sent either way
+    uint32_t flags = preambleFlags(modem) + tailFlags(modem) + 1;
+    return airtimeMs(flags * 8, modem);
+}
+
+uint32_t Protocol::keyupBits(const uint8_t* const* frames, const size_t* lens, size_t count) const {
+    return keyupBits(frames, lens, count, *_nextModem);
+}
+
+uint32_t Protocol::keyupBits(const uint8_t* const* frames, const size_t* lens, size_t count,
+                             const ModemProfile& modem) const {
+    if (!frames || !lens || count == 0) {
+        return 0;
+    }
+    uint32_t bits = (preambleFlags(modem) + 1 + tailFlags(modem)) * 8;
+    bool open = true;           // Last bits sent were a flag
+    for (size_t i = 0; i < count; i++) {
+        if (!frames[i] || lens[i] == 0 || lens[i] > AX25_MAX_FRAME_LEN) {
+            return 0;
+        }
+        if (_config.framing != Framing::Ax25) {
+            size_t bytes = Il2pCodec::frameBytes(frames[i], lens[i], il2pMaxFec(_config.framing));
+            if (bytes == 0) {
+                return 0;
+            }
+            bits += bytes * 8;
+            continue;
+        }
+        size_t block = FX25Codec::blockBytes(_config.fx25, frames[i], lens[i]);
+        if (block > 0) {
+            bits += block * 8;
+            open = false;
+        } else {
+            bits += HdlcEncoder::frameBits(frames[i], lens[i]) + (open ? 8 : 16);
+            open = true;
+        }
+    }
+    return bits;
+}
+
+uint32_t Protocol::packetAirtimeMs(const AX25Call& src,
+                                   const AX25Call& dst,
+                                   const AX25Call* path,
+                                   size_t path_len,
+                                   const uint8_t* payload,
+                                   size_t payload_len) const {
+    uint8_t frame[AX25_MAX_FRAME_LEN];
+    size_t len = encodeFrame(src, dst, path, path_len, payload, payload_len,
+                             frame, sizeof(frame));
+    return frameAirtimeMs(frame, len);
+}
+
+uint32_t Protocol::frameAirtimeMs(const uint8_t* frame, size_t len) const {
+    const ModemProfile& modem = *_nextModem;
+    uint32_t bits = (len > 0) ? keyupBits(&frame, &len, 1, modem) : 0;
+    return (bits > 0) ? airtimeMs(bits, modem) : 0;
+}
+
+// ============================================================================
+// Encode and modulate HDLC flags (IL2P: preamble bytes), one bitstream
+// segment at a time
+// ============================================================================
+bool Protocol::sendFlags(size_t count) {
+    const size_t per_segment = TX_BITSTREAM_BITS / 8;
+    while (count > 0) {
+        size_t n = (count < per_segment) ? count : per_segment;
+        _encoder.clear();
+        bool ok = (_framing == Framing::Ax25) ? _encoder.flags(n) : _encoder.fill(IL2P_PREAMBLE, n, true);
+        if (!ok) {
+            return false;
+        }
+        modulate();
+        count -= n;
+    }
+    return true;
+}
+
+// ============================================================================
+// Encode one frame into the bitstream segment
+//
+// A frame sent before replays its cached tones; anything else is encoded
+// (stuffing and NRZI, FX.25 or IL2P) and its tones are cached, relative to
+// the line tone before them. open tracks whether the line last sent a
+// flag, which a plain AX.25 frame needs in front of it.
+// ============================================================================
+bool Protocol::encodeSegment(const uint8_t* frame, size_t len, FX25Mode fx25, bool& open) {
+    uint32_t key = 0;
+    const RenderCache::Entry* hit = nullptr;
+    if (_cache.isEnabled()) {
+        key = RenderCache::key(frame, len, (uint8_t)(((uint8_t)_framing << 4) | (uint8_t)fx25));
+        hit = _cache.find(key, frame, len);
+    }
+    RenderCache::Kind kind;
+    uint16_t extra = 0;
+    if (hit) {
+        kind = hit->kind;
+        extra = hit->extra;
+    } else if (_framing != Framing::Ax25) {
+        kind = RenderCache::Kind::Il2p;
+    } else {
+        size_t block = FX25Codec::blockBytes(fx25, frame, len);
+        kind = block ? RenderCache::Kind::Fx25 : RenderCache::Kind::Ax25;
+        extra = block ? (uint16_t)(block - len) : 0;
+    }
     
-    // Destination address
-    sendCall(dst, false);
+    if (kind == RenderCache::Kind::Il2p) {
+        _stats.il2p_frames++;
+    } else if (kind == RenderCache::Kind::Fx25) {
+        _stats.fx25_frames++;
+        _stats.fx25_bytes += extra;
+    } else if (!open && !_encoder.flags(1)) {
+        return false;
+    }
+    open = (kind == RenderCache::Kind::Ax25);
     
-    // Source address
-    sendCall(src, path_len == 0);
+    if (hit) {
+        return _encoder.tones(hit->words, hit->bits, hit->stuffed);
+    }
     
-    // Path addresses
-    for (size_t i = 0; i < path_len; i++) {
-        sendCall(path[i], i == path_len - 1);
+    size_t start = _encoder.length();
+    bool start_tone = _encoder.lineTone();
+    uint32_t stuffed = _encoder.stuffedBits();
+    bool ok;
+    if (kind == RenderCache::Kind::Il2p) {
+        size_t bytes = Il2pCodec::encode(frame, len, il2pMaxFec(_framing), _block, sizeof(_block));
+        ok = bytes > 0 && _encoder.raw(_block, bytes, true);
+    } else if (kind == RenderCache::Kind::Fx25) {
+        size_t bytes = FX25Codec::encode(fx25, frame, len, _block, sizeof(_block));
+        ok = bytes > 0 && _encoder.raw(_block, bytes);
+    } else {
+        ok = _encoder.frame(frame, len) && _encoder.flags(1);
+    }
+    if (!ok) {
+        return false;
     }
     
-    // Control and PID
-    putByte(AX25_CTRL_UI);
-    putByte(AX25_PID_NOLAYER3);
+    size_t bits = _encoder.length() - start;
+    RenderCache::Entry* entry = _cache.store(key, frame, len, bits);
+    if (entry) {
+        _encoder.copyTones(start, bits, entry->words, start_tone);
+        entry->kind = kind;
+        entry->extra = extra;
+        entry->stuffed = (uint16_t)(_encoder.stuffedBits() - stuffed);
+    }
+    return true;
+}
+
+// ============================================================================
+// Transmit encoded AX.25 frames in one key-up
+// ============================================================================
+bool Protocol::transmitFrames(const uint8_t* const* frames, const size_t* lens, size_t count) {
+    if (_keyed || !frames || !lens || count == 0) {
+        return false;
+    }
     
-    // Information field
-    for (size_t i = 0; i < payload_len; i++) {
-        putByte(payload[i]);
+    // A modem change waits for a key-up boundary
+    if (!applyModem()) {
+        return false;
     }
     
-    // FCS (CRC) - inverted
-    uint8_t crcl = (_crc & 0xFF) ^ 0xFF;
-    uint8_t crch = (_crc >> 8) ^ 0xFF;
-    fifoPush(crcl);
-    fifoPush(crch);
+    // Reject the whole burst before keying up if any frame cannot be sent
+    if (keyupBits(frames, lens, count, *_modem) == 0) {
+        return false;
+    }
     
-    // End flag
-    fifoPush(HDLC_FLAG);
+    // Reset per-key-up statistics
+    _stats = TxStats();
+    _stats.frames = count;
+    for (size_t i = 0; i < count; i++) {
+        _stats.frame_bytes += lens[i];
+    }
     
-    // Start transmission
-    _transmitting = true;
+    // Start transmission on the mark tone
+    _keyed = true;
     _phaseAcc = 0;
-    _phaseInc = MARK_INC;
+    _phaseInc = _modem->mark_inc;
+    _tone = 0;
     _sampleIndex = 0;
-    _txBit = 0;
-    _bitstuffCount = 0;
-    _bitStuff = true;
-    _preambleLength = (_config.preamble_ms * BITRATE) / 8000;
-    _tailLength = (_config.tail_ms * BITRATE) / 8000;
+    _blockPhase = 0;
+    _ddsPhase = 0;
+    _encoder.begin(_bitstream, TX_BITSTREAM_BITS);
     
-    // Enable PTT
-    setPTT(true);
-    vTaskDelay(pdMS_TO_TICKS(100));  // PTT delay
+    // PTT goes on as the lead-in silence starts to play, so the first
+    // modulated sample leaves the output exactly ptt_lead_ms later (audio
+    // input is suspended while keyed)
+    _sink->txBegin();
+    _sink->pttWrite(_config.ptt_pin, pttLevel(true));
+    sendSilence(pttSamples(_config.ptt_lead_ms, *_modem));
     
-    // Transmit
-    sendAFSK();
+    // Preamble and opening flag, then each frame with its closing flag
+    // (the opening flag of the next). Tone and stuffing state carry over
+    // from one segment to the next. An FX.25 block carries its own flags
+    // and ends in parity, so a plain frame after one gets an opening flag.
+    // IL2P frames carry their own sync word and parity, sent MSB first.
+    FX25Mode fx25 = _config.fx25;
+    _framing = _config.framing;
+    bool open = true;
+    bool ok = sendFlags(preambleFlags(*_modem) + 1);
+    for (size_t i = 0; ok && i < count; i++) {
+        _encoder.clear();
+        ok = encodeSegment(frames[i], lens[i], fx25, open);
+        if (ok) {
+            modulate();
+        }
+    }
+    ok = ok && sendFlags(tailFlags(*_modem));
     
-    // Disable PTT
-    vTaskDelay(pdMS_TO_TICKS(100));
-    setPTT(false);
+    // PTT goes off as the last tail sample finishes playing
+    sendSilence(pttSamples(_config.ptt_tail_ms, *_modem));
+    _sink->pttWrite(_config.ptt_pin, pttLevel(false));
+    _sink->drain();
+    _sink->txEnd();
+    _keyed = false;
     
-    return true;
+    _stats.stuffed_bits = _encoder.stuffedBits();
+    _stats.airtime_ms = airtimeMs(_stats.bits, *_modem);
+    _stats.saved_ms = (count - 1) * keyupOverheadMs(*_modem);
+    
+    return ok;
 }
 
 } // namespace APRS
@@ -1,29 +1,45 @@
 #ifndef APRS_PROTOCOL_H
 #define APRS_PROTOCOL_H
 
+#include "APRS_AudioSink.h"
+#include "APRS_CRC.h"
+#include "APRS_FX25.h"
+#include "APRS_HDLC.h"
+#include "APRS_IL2P.h"
+#include "APRS_RenderCache.h"
+#include "APRS_Modem.h"
 #include <stdint.h>
 #include <stddef.h>
 
 namespace APRS {
 
-// ============================================================================
-// AFSK Constants
-// ============================================================================
-#define MARK_FREQ       1200    // Hz
-#define SPACE_FREQ      2200    // Hz
-#define BITRATE         1200    // bps
-#define SAMPLERATE      105600  // 13200 * 8 oversampling
-#define SAMPLESPERBIT   (SAMPLERATE / BITRATE)
-
 // ============================================================================
 // AX.25 Protocol Constants
 // ============================================================================
 #define AX25_CTRL_UI        0x03
 #define AX25_PID_NOLAYER3   0xF0
 #define HDLC_FLAG           0x7E
-#define HDLC_RESET          0x7F
-#define AX25_ESC            0x1B
 #define BIT_STUFF_LEN       5
+#define AX25_MAX_PATH       8       // Digipeater addresses
+#define AX25_MAX_INFO_LEN   256     // Information field bytes
+#define AX25_MAX_FRAME_LEN  (7 * (2 + AX25_MAX_PATH) + 2 + AX25_MAX_INFO_LEN + 2)
+#define AX25_MIN_FRAME_LEN  (7 * 2 + 1 + 2)  // Two addresses, control, FCS
+#define PTT_LEAD_MS         100     // Default PTT on to the first audio sample
+#define PTT_TAIL_MS         100     // Default last audio sample to PTT off
+
+// Bitstream segment: one worst-case frame (every fifth bit stuffed) plus
+// its closing flag
+#define TX_BITSTREAM_BITS   (AX25_MAX_FRAME_LEN * 8 * (BIT_STUFF_LEN + 1) / BIT_STUFF_LEN + 8)
+#define TX_BITSTREAM_WORDS  ((TX_BITSTREAM_BITS + HDLC_WORD_BITS - 1) / HDLC_WORD_BITS)
+
+// One FX.25 block or IL2P frame, encoded before it is modulated
+#define TX_IL2P_BYTES       IL2P_MAX_FRAME_BYTES(AX25_MAX_FRAME_LEN - 2)
+#define TX_BLOCK_BYTES      ((TX_IL2P_BYTES > FX25_MAX_BLOCK) ? TX_IL2P_BYTES : FX25_MAX_BLOCK)
+
+// Frames whose final bitstream is kept for repeats (see RenderCache)
+#define TX_RENDER_CACHE_ENTRIES 4
+
+static_assert(TX_BLOCK_BYTES * 8 <= TX_BITSTREAM_BITS, "an FX.25 block or IL2P frame must fit one bitstream segment");
 
 // ============================================================================
 // AX.25 Call Structure
@@ -33,13 +49,66 @@ struct AX25Call {
     uint8_t ssid;       // SSID (0-15)
 };
 
+// ============================================================================
+// Modulator Selection
+// ============================================================================
+enum class ModulatorMode : uint8_t {
+    Sample,     // Per-sample DDS (generateSample() for every output sample)
+    Block,      // Whole bits copied from precomputed per-phase waveform tables
+    Dds         // Per-sample 32-bit fractional-phase DDS, interpolated table
+};
+
+// ============================================================================
+// Framing Selection
+//
+// The IL2P framings exist only in builds with APRS_IL2P set (the native
+// host tools): the codec does not yet match a complete type 0 reference
+// frame, so firmware cannot select it.
+// ============================================================================
+#ifndef APRS_IL2P
+#define APRS_IL2P 0
+#endif
+
+enum class Framing : uint8_t {
+    Ax25,       // HDLC flags, bit stuffing and FCS (optionally FX.25)
+#if APRS_IL2P
+    Il2p,       // IL2P, 2-9 parity bytes per payload block
+    Il2pMaxFec  // IL2P, 16 parity bytes per payload block
+#endif
+};
+
 // ============================================================================
 // Protocol Configuration
 // ============================================================================
 struct ProtocolConfig {
-    uint8_t ptt_pin;        // GPIO pin number
-    uint16_t preamble_ms;   // Pre-transmission flags duration
-    uint16_t tail_ms;       // Post-transmission flags duration
+    uint8_t ptt_pin;            // GPIO pin number
+    uint16_t preamble_ms;       // Pre-transmission flags duration
+    uint16_t tail_ms;           // Post-transmission flags duration
+    ModulatorMode modulator;    // AFSK modulator implementation
+    AudioSink* sink;            // Audio output (nullptr: HAL DAC)
+    const ModemProfile* modem;  // Rate and tones (nullptr: Bell202)
+    FX25Mode fx25;              // Forward error correction (Off: plain AX.25)
+    Framing framing;            // On-air framing (FX.25 applies to Ax25 only)
+    bool render_cache;          // Replay the bitstream of repeated frames
+    uint16_t ptt_lead_ms;       // PTT on to the first modulated sample
+    uint16_t ptt_tail_ms;       // Last modulated sample to PTT off
+    bool ptt_active_high;       // PTT asserted by a high level (false: low)
+};
+
+// ============================================================================
+// Transmit Statistics (last key-up)
+// ============================================================================
+struct TxStats {
+    uint32_t frames = 0;        // Frames sent in this key-up
+    uint32_t frame_bytes = 0;   // AX.25 frame bytes, addresses through FCS
+    uint32_t bits = 0;          // On-air bits incl. preamble/tail flags and stuffing
+    uint32_t stuffed_bits = 0;  // Zero bits inserted by bit stuffing
+    uint32_t fx25_frames = 0;   // Frames sent as FX.25 blocks
+    uint32_t fx25_bytes = 0;    // Correlation tag, padding and parity bytes added
+    uint32_t il2p_frames = 0;   // Frames sent with IL2P framing
+    uint32_t samples = 0;       // Audio samples written (incl. PTT lead and tail)
+    uint32_t airtime_ms = 0;    // PTT on to PTT off
+    uint32_t saved_ms = 0;      // Airtime saved versus one key-up per frame
 };
 
 // ============================================================================
@@ -72,53 +141,221 @@ public:
                    const uint8_t* payload,
                    size_t payload_len);
     
+    /**
+     * Encode an AX.25 UI frame (addresses through FCS, no flags or escaping)
+     * 
+     * Touches no Protocol state, so it can run on any task while another
+     * frame is being transmitted.
+     * 
+     * @param out Output buffer
+     * @param capacity Output buffer size (AX25_MAX_FRAME_LEN always fits)
+     * @return Frame length, or 0 if it does not fit
+     */
+    static size_t encodeFrame(const AX25Call& src,
+                              const AX25Call& dst,
+                              const AX25Call* path,
+                              size_t path_len,
+                              const uint8_t* payload,
+                              size_t payload_len,
+                              uint8_t* out,
+                              size_t capacity);
+    
+    /**
+     * Key up and transmit a frame produced by encodeFrame()
+     * 
+     * @param frame Encoded frame (addresses through FCS)
+     * @param len Frame length
+     * @return true on success
+     */
+    bool transmitFrame(const uint8_t* frame, size_t len);
+    
+    /**
+     * Key up once and transmit several frames back to back
+     * 
+     * The preamble and PTT delays are paid once; consecutive frames share a
+     * single HDLC flag and the tail follows the last frame. Modulator phase
+     * and NRZI state run on across frames, so the burst is one continuous
+     * AFSK signal. Each frame is encoded to its on-air bitstream just before
+     * it is modulated; every frame must be at most AX25_MAX_FRAME_LEN.
+     * 
+     * With FX.25 on, each frame that fits a code of the mode goes out as an
+     * FX.25 block (tag, flagged frame, parity) instead; the Reed-Solomon
+     * parity is computed just before the block is modulated.
+     * 
+     * With IL2P framing the preamble and tail are IL2P_PREAMBLE bytes and
+     * each frame goes out as an IL2P frame (sync word, header, payload
+     * blocks) with no flags or bit stuffing.
+     * 
+     * @param frames Encoded frames (addresses through FCS)
+     * @param lens Frame lengths
+     * @param count Number of frames
+     * @return true on success
+     */
+    bool transmitFrames(const uint8_t* const* frames, const size_t* lens, size_t count);
+    
+    /**
+     * Exact on-air bits transmitFrames() would send for these frames:
+     * preamble, flags, stuffed frame bits and tail (0 if any frame is
+     * invalid). Pass the result to airtimeMs() for the key-up airtime.
+     * 
+     * Like the other estimates below, this uses the timing, FX.25 mode,
+     * framing and modem the next key-up will use.
+     */
+    uint32_t keyupBits(const uint8_t* const* frames, const size_t* lens, size_t count) const;
+    
+    /**
+     * Airtime of one key-up carrying the given on-air bits
+     * (PTT lead, modulated bits and PTT tail)
+     */
+    uint32_t airtimeMs(uint32_t bits) const;
+    
+    /**
+     * Airtime sendPacket() would take with these arguments, PTT on to PTT
+     * off, without modulating anything
+     * 
+     * Encodes the frame on the stack and counts its stuffed bits (or its
+     * FX.25/IL2P size); matches TxStats::airtime_ms of the key-up.
+     * 
+     * @return Milliseconds, or 0 if the packet cannot be sent
+     */
+    uint32_t packetAirtimeMs(const AX25Call& src,
+                             const AX25Call& dst,
+                             const AX25Call* path,
+                             size_t path_len,
+                             const uint8_t* payload,
+                             size_t payload_len) const;
+    
+    /**
+     * Airtime transmitFrame() would take for an encoded frame
+     * @return Milliseconds, or 0 if the frame cannot be sent
+     */
+    uint32_t frameAirtimeMs(const uint8_t* frame, size_t len) const;
+    
+    /**
+     * Airtime each extra frame costs when sent in its own key-up rather
+     * than appended to a burst
+     */
+    uint32_t keyupOverheadMs() const;
+    
+    /**
+     * Change preamble (TXDELAY) and tail; applies from the next key-up
+     */
+    void setTiming(uint16_t preamble_ms, uint16_t tail_ms);
+    
+    /**
+     * Change the FX.25 mode; applies from the next key-up
+     */
+    void setFx25(FX25Mode mode) { _config.fx25 = mode; }
+    
+    /**
+     * Change the on-air framing (AX.25 or IL2P); applies from the next key-up
+     */
+    void setFraming(Framing framing) { _config.framing = framing; }
+    
+    const ProtocolConfig& config() const { return _config; }
+    
+    /**
+     * Switch modem (e.g. VHF Bell 202 / HF 300 baud); applies from the next
+     * key-up, like setTiming(). The sink is restarted there if the sample
+     * rate changes.
+     */
+    void setModem(const ModemProfile* modem);
+    
+    /**
+     * Modem in use (sample rate, baud and tones)
+     */
+    const ModemProfile& modem() const { return *_modem; }
+    
     /**
      * Check if transmission is in progress
      */
-    bool isBusy() const { return _transmitting; }
+    bool isBusy() const { return _keyed; }
     
     /**
-     * Set PTT (Push-to-Talk) state
+     * Set PTT (Push-to-Talk) state at once, in the configured polarity
      */
     void setPTT(bool enable);
     
+    /**
+     * Audio output in use (the config's sink or the HAL DAC)
+     */
+    AudioSink* sink() const { return _sink; }
+    
+    /**
+     * Fold one byte into an AX.25 FCS (CRC-CCITT, reflected, start 0xFFFF)
+     * 
+     * Running it over a received frame including its FCS leaves
+     * AX25_CRC_GOOD when the frame is intact. Same as Crc16::updateByte();
+     * use Crc16 for whole buffers.
+     */
+    static uint16_t updateCRC(uint8_t byte, uint16_t crc);
+    
+    /**
+     * Statistics for the most recent key-up
+     */
+    const TxStats& lastStats() const { return _stats; }
+    
+    /**
+     * Render cache hits, misses and evictions since begin()
+     */
+    const RenderCacheStats& renderCacheStats() const { return _cache.stats(); }
+    
 private:
     ProtocolConfig _config;
-    bool _transmitting;
+    HalDacSink _halSink;
+    AudioSink* _sink;
+    SampleFormat _format;
+    const ModemProfile* _modem;
+    const ModemProfile* volatile _nextModem;    // Set by setModem(), taken at key-up
+    bool _keyed;                // PTT cycle in progress
+    bool _transmitting;         // Current frame still modulating
+    TxStats _stats;
     
     // Internal transmission state
     uint16_t _phaseAcc;
     uint16_t _phaseInc;
-    uint8_t _sampleIndex;
-    uint8_t _currentOutputByte;
-    uint8_t _txBit;
-    uint8_t _bitstuffCount;
-    bool _bitStuff;
-    uint16_t _preambleLength;
-    uint16_t _tailLength;
-    uint16_t _crc;
-    
-    // FIFO buffer for packet data
-    static const size_t FIFO_SIZE = 512;
-    uint8_t _fifo[FIFO_SIZE];
-    size_t _fifo_head;
-    size_t _fifo_tail;
+    uint8_t _tone;              // Tone of the current bit (0: mark, 1: space)
+    uint16_t _sampleIndex;
+    uint8_t _blockPhase;        // Block modulator phase slot at bit boundary
+    uint32_t _ddsPhase;         // Fractional DDS accumulator (2^32 = 1 cycle)
+    uint32_t _ddsInc;
+    
+    // On-air bitstream of the segment being modulated (tone per bit)
+    HdlcEncoder _encoder;
+    uint32_t _bitstream[TX_BITSTREAM_WORDS];
+    size_t _bitPos;
+    uint8_t _block[TX_BLOCK_BYTES];    // FX.25 block or IL2P frame being sent
+    Framing _framing;                   // Framing of the key-up in progress
+    
+    // Bitstreams of recently sent frames
+    RenderCache _cache;
+    RenderCache::Entry _cacheEntries[TX_RENDER_CACHE_ENTRIES];
+    uint32_t _cacheWords[TX_RENDER_CACHE_ENTRIES][TX_BITSTREAM_WORDS];
     
     // Helper methods
-    void initI2S();
-    void sendAFSK();
+    bool applyModem();
+    uint16_t preambleFlags(const ModemProfile& modem) const;
+    uint16_t tailFlags(const ModemProfile& modem) const;
+    uint32_t pttSamples(uint16_t ms, const ModemProfile& modem) const;
+    bool pttLevel(bool enable) const { return enable == _config.ptt_active_high; }
+    uint32_t keyupBits(const uint8_t* const* frames, const size_t* lens, size_t count,
+                       const ModemProfile& modem) const;
+    uint32_t airtimeMs(uint32_t bits, const ModemProfile& modem) const;
+    uint32_t keyupOverheadMs(const ModemProfile& modem) const;
+    bool sendFlags(size_t count);
+    bool encodeSegment(const uint8_t* frame, size_t len, FX25Mode fx25, bool& open);
+    void modulate();
+    void sendSilence(uint32_t count);
+    bool nextBit();
     uint8_t generateSample();
-    void putByte(uint8_t byte);
-    void sendCall(const AX25Call& call, bool last);
-    uint16_t updateCRC(uint8_t byte, uint16_t crc);
-    uint8_t sinSample(uint16_t phase);
+    uint8_t generateSampleDds();
     
-    // FIFO operations
-    bool fifoIsEmpty() const;
-    bool fifoIsFull() const;
-    void fifoPush(uint8_t byte);
-    uint8_t fifoPop();
-    void fifoFlush();
+    // Modulators, rendering straight into the sink's sample type
+    template <typename Sample> void sendAFSK();
+    template <typename Sample> void sendAFSKBlock();
+    template <typename Sample> void sendAFSKDds();
+    template <typename Sample> void sendSilence(uint32_t count);
+    uint8_t sinSample(uint16_t phase);
 };
 
 } // namespace APRS
@@ -0,0 +1,59 @@
+#include "APRS_Receiver.h"
+
+namespace APRS {
+
+Receiver::Receiver() : _task(nullptr), _started(false) {
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+bool Receiver::begin(const ReceiverConfig& config, FrameCallback callback, void* user) {
+    if (_started) {
+        return false;
+    }
+
+    _config = config;
+    if (!_demod.begin(_config.sample_rate, callback, user, _config.modem)) {
+        return false;
+    }
+    if (!HAL::captureBegin(_config.pin, _config.sample_rate)) {
+        return false;
+    }
+    _started = true;
+
+    if (_config.use_task) {
+        if (!HAL::taskStart(taskEntry, this, "aprs_rx", _config.stack_bytes,
+                            _config.priority, _config.core, &_task)) {
+            _started = false;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Capture
+// ============================================================================
+bool Receiver::service() {
+    if (!_started) {
+        return false;
+    }
+
+    size_t count = HAL::captureRead(_block, BLOCK_SAMPLES, 100);
+    if (count == 0) {
+        return false;
+    }
+    _demod.process(_block, count);
+    return true;
+}
+
+void Receiver::taskEntry(void* arg) {
+    Receiver* receiver = static_cast<Receiver*>(arg);
+    for (;;) {
+        receiver->service();
+    }
+}
+
+} // namespace APRS
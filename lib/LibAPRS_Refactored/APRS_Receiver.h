@@ -0,0 +1,89 @@
+#ifndef APRS_RECEIVER_H
+#define APRS_RECEIVER_H
+
+#include "APRS_Demodulator.h"
+#include "APRS_HAL.h"
+
+namespace APRS {
+
+// ============================================================================
+// Receiver Configuration
+// ============================================================================
+struct ReceiverConfig {
+    uint8_t pin = 36;               // ADC1 GPIO carrying the radio audio
+    uint32_t sample_rate = RX_SAMPLERATE;
+    const ModemProfile* modem = nullptr;    // Baud and tones (nullptr: Bell202)
+    bool use_task = true;           // false: caller drains with service()
+    int8_t core = 1;                // Core for the RX task (-1: no affinity)
+    uint8_t priority = 3;           // RX task priority
+    uint32_t stack_bytes = 4096;    // RX task stack
+};
+
+// ============================================================================
+// AFSK Receiver
+// ============================================================================
+
+/**
+ * Continuous receive path: ADC capture through the HAL into the
+ * demodulator, on a dedicated RX task.
+ *
+ * Capture pauses while the Protocol is keyed (the ESP32 ADC and DAC share
+ * I2S0) and resumes after the tail, so the receiver hears everything but
+ * its own transmissions. The frame callback runs on the RX task; parse
+ * the frame in place with AX25FrameView.
+ */
+class Receiver {
+public:
+    Receiver();
+
+    /**
+     * Start capture and the RX task
+     *
+     * @param config Receiver configuration
+     * @param callback Called for every frame with a good FCS
+     * @param user Passed to the callback
+     * @return true on success
+     */
+    bool begin(const ReceiverConfig& config, FrameCallback callback, void* user = nullptr);
+
+    /**
+     * True once begin() succeeded
+     */
+    bool isStarted() const { return _started; }
+
+    /**
+     * True if an RX task drains the capture (false: call service())
+     */
+    bool isRunning() const { return _task != nullptr; }
+
+    /**
+     * Demodulate one block of captured audio on the calling task
+     * @return true if any samples were processed
+     */
+    bool service();
+
+    /**
+     * Demodulator counters
+     */
+    const DemodStats& stats() const { return _demod.stats(); }
+
+    /**
+     * Data carrier detect (channel busy), for CSMA before keying up
+     */
+    bool isCarrierDetected() const { return _started && _demod.isCarrierDetected(); }
+
+private:
+    static const size_t BLOCK_SAMPLES = 256;
+
+    ReceiverConfig _config;
+    Demodulator _demod;
+    HAL::Task _task;
+    bool _started;
+    int16_t _block[BLOCK_SAMPLES];
+
+    static void taskEntry(void* arg);
+};
+
+} // namespace APRS
+
+#endif // APRS_RECEIVER_H
@@ -0,0 +1,222 @@
+#include "APRS_ReedSolomon.h"
+#include <string.h>
+
+namespace APRS {
+
+// ============================================================================
+// GF(256) tables
+// ============================================================================
+struct GaloisField {
+    uint8_t exp[2 * RS_SYMBOLS];    // alpha^i, twice over: log sums need no modulo
+    uint8_t log[256];               // log[0] is unused
+
+    GaloisField() {
+        unsigned x = 1;
+        for (unsigned i = 0; i < RS_SYMBOLS; i++) {
+            exp[i] = exp[i + RS_SYMBOLS] = (uint8_t)x;
+            log[x] = (uint8_t)i;
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= RS_GF_POLY;
+            }
+        }
+        log[0] = 0;
+    }
+};
+
+// Built on first use (thread-safe static initialization)
+static const GaloisField& field() {
+    static const GaloisField gf;
+    return gf;
+}
+
+static uint8_t gfMul(const GaloisField& gf, uint8_t a, uint8_t b) {
+    return (a && b) ? gf.exp[gf.log[a] + gf.log[b]] : 0;
+}
+
+static uint8_t gfDiv(const GaloisField& gf, uint8_t a, uint8_t b) {
+    return a ? gf.exp[gf.log[a] + RS_SYMBOLS - gf.log[b]] : 0;
+}
+
+static uint8_t gfPow(const GaloisField& gf, unsigned power) {
+    return gf.exp[power % RS_SYMBOLS];
+}
+
+// Evaluate a polynomial (coefficient i of x^i) at alpha^power
+static uint8_t polyEval(const GaloisField& gf, const uint8_t* poly, int degree, unsigned power) {
+    uint8_t sum = 0;
+    for (int i = 0; i <= degree; i++) {
+        sum ^= gfMul(gf, poly[i], gfPow(gf, power * i));
+    }
+    return sum;
+}
+
+// ============================================================================
+// Generator polynomial
+// ============================================================================
+ReedSolomon::ReedSolomon(uint8_t nroots, uint8_t fcr)
+    : _nroots(nroots), _fcr(fcr) {
+    const GaloisField& gf = field();
+
+    // Product of (x - alpha^(fcr + i)), coefficient j of x^j
+    uint8_t gen[RS_MAX_ROOTS + 1];
+    gen[0] = 1;
+    for (unsigned i = 0; i < _nroots; i++) {
+        uint8_t root = gfPow(gf, _fcr + i);
+        gen[i + 1] = 1;
+        for (unsigned j = i; j > 0; j--) {
+            gen[j] = gen[j - 1] ^ gfMul(gf, gen[j], root);
+        }
+        gen[0] = gfMul(gf, gen[0], root);
+    }
+    for (unsigned j = 0; j <= _nroots; j++) {
+        _genLog[j] = gf.log[gen[j]];
+    }
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+void ReedSolomon::encode(const uint8_t* data, size_t len, uint8_t* parity) const {
+    const GaloisField& gf = field();
+    const unsigned last = _nroots - 1;
+    memset(parity, 0, _nroots);
+    for (size_t i = 0; i < len; i++) {
+        uint8_t feedback = data[i] ^ parity[0];
+        memmove(parity, parity + 1, last);
+        if (feedback) {
+            // alpha^(log feedback + log g_k) without a modulo
+            const uint8_t* scaled = gf.exp + gf.log[feedback];
+            for (unsigned j = 0; j < last; j++) {
+                parity[j] ^= scaled[_genLog[last - j]];
+            }
+            parity[last] = scaled[_genLog[0]];
+        } else {
+            parity[last] = 0;
+        }
+    }
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+void ReedSolomon::syndromes(const uint8_t* block, size_t len, uint8_t* s) const {
+    const GaloisField& gf = field();
+    for (unsigned i = 0; i < _nroots; i++) {
+        uint8_t root = gfPow(gf, _fcr + i);
+        uint8_t sum = block[0];
+        for (size_t j = 1; j < len; j++) {
+            sum = gfMul(gf, sum, root) ^ block[j];
+        }
+        s[i] = sum;
+    }
+}
+
+int ReedSolomon::decode(uint8_t* block, size_t len) const {
+    if (len <= _nroots || len > RS_SYMBOLS) {
+        return -1;
+    }
+    const GaloisField& gf = field();
+
+    uint8_t s[RS_MAX_ROOTS];
+    syndromes(block, len, s);
+    bool clean = true;
+    for (unsigned i = 0; i < _nroots; i++) {
+        clean = clean && s[i] == 0;
+    }
+    if (clean) {
+        return 0;
+    }
+
+    // Berlekamp-Massey: error locator lambda with roots at X^-1
+    uint8_t lambda[RS_MAX_ROOTS + 1] = { 1 };
+    uint8_t prev[RS_MAX_ROOTS + 1] = { 1 };
+    uint8_t saved[RS_MAX_ROOTS + 1];
+    int errors = 0;
+    unsigned shift = 1;
+    uint8_t prev_d = 1;
+    for (unsigned k = 0; k < _nroots; k++) {
+        uint8_t d = s[k];
+        for (int i = 1; i <= errors; i++) {
+            d ^= gfMul(gf, lambda[i], s[k - i]);
+        }
+        if (d == 0) {
+            shift++;
+            continue;
+        }
+        uint8_t scale = gfDiv(gf, d, prev_d);
+        memcpy(saved, lambda, sizeof(saved));
+        for (unsigned i = 0; i + shift <= _nroots; i++) {
+            lambda[i + shift] ^= gfMul(gf, scale, prev[i]);
+        }
+        if (2 * errors <= (int)k) {
+            errors = k + 1 - errors;
+            memcpy(prev, saved, sizeof(prev));
+            prev_d = d;
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+    if (2 * errors > _nroots) {
+        return -1;
+    }
+
+    // Chien search: byte j carries power len - 1 - j
+    uint8_t where[RS_MAX_ROOTS / 2];
+    int found = 0;
+    for (size_t j = 0; j < len && found <= errors; j++) {
+        unsigned power = len - 1 - j;
+        if (polyEval(gf, lambda, errors, RS_SYMBOLS - power) == 0) {
+            if (found == errors) {
+                return -1;
+            }
+            where[found++] = (uint8_t)j;
+        }
+    }
+    if (found != errors) {
+        return -1;
+    }
+
+    // Forney: e = X^(1 - fcr) * omega(X^-1) / lambda'(X^-1)
+    uint8_t omega[RS_MAX_ROOTS];
+    for (unsigned i = 0; i < _nroots; i++) {
+        omega[i] = 0;
+        for (int k = 0; k <= errors && k <= (int)i; k++) {
+            omega[i] ^= gfMul(gf, lambda[k], s[i - k]);
+        }
+    }
+    uint8_t derivative[RS_MAX_ROOTS];
+    for (int i = 0; i < errors; i++) {
+        derivative[i] = (i & 1) ? 0 : lambda[i + 1];
+    }
+    uint8_t value[RS_MAX_ROOTS / 2];
+    for (int e = 0; e < found; e++) {
+        unsigned power = len - 1 - where[e];
+        unsigned inverse = RS_SYMBOLS - power;
+        uint8_t den = polyEval(gf, derivative, errors - 1, inverse);
+        if (den == 0) {
+            return -1;
+        }
+        uint8_t num = polyEval(gf, omega, _nroots - 1, inverse);
+        unsigned scale = (power * (RS_SYMBOLS + 1 - _fcr)) % RS_SYMBOLS;
+        value[e] = gfMul(gf, gfPow(gf, scale), gfDiv(gf, num, den));
+    }
+
+    // Apply, and undo unless the result is a codeword
+    for (int e = 0; e < found; e++) {
+        block[where[e]] ^= value[e];
+    }
+    syndromes(block, len, s);
+    for (unsigned i = 0; i < _nroots; i++) {
+        if (s[i] != 0) {
+            for (int e = 0; e < found; e++) {
+                block[where[e]] ^= value[e];
+            }
+            return -1;
+        }
+    }
+    return found;
+}
+
+} // namespace APRS
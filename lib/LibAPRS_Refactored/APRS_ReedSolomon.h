@@ -0,0 +1,70 @@
+#ifndef APRS_REED_SOLOMON_H
+#define APRS_REED_SOLOMON_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// Reed-Solomon Constants
+// ============================================================================
+#define RS_SYMBOLS          255     // Codeword length of the full code
+#define RS_MAX_ROOTS        64      // Parity bytes per codeword
+#define RS_GF_POLY          0x11D   // x^8 + x^4 + x^3 + x^2 + 1
+
+// ============================================================================
+// Reed-Solomon Codec over GF(2^8)
+// ============================================================================
+
+/**
+ * Systematic Reed-Solomon code over GF(256) with primitive element 2
+ *
+ * The generator has roots alpha^fcr .. alpha^(fcr + nroots - 1); FX.25
+ * uses fcr 1, IL2P fcr 0. The first data byte is the highest-order
+ * coefficient and the parity follows the data, so shortened codes simply
+ * pass fewer data bytes (the missing leading zeros change nothing).
+ *
+ * encode() is an LFSR over log/antilog tables: per data byte one log
+ * lookup and nroots antilog lookups and XORs, with the generator kept in
+ * log form and an antilog table long enough that no modulo is needed.
+ * decode() (Berlekamp-Massey, Chien search, Forney) is only needed on
+ * receive and by the host round-trip checks.
+ */
+class ReedSolomon {
+public:
+    /**
+     * @param nroots Parity bytes (2..RS_MAX_ROOTS)
+     * @param fcr First consecutive root of the generator (log form)
+     */
+    ReedSolomon(uint8_t nroots, uint8_t fcr);
+
+    uint8_t nroots() const { return _nroots; }
+
+    /**
+     * Compute the parity of one codeword
+     * @param data Data bytes (at most RS_SYMBOLS - nroots)
+     * @param len Data length
+     * @param parity Receives nroots bytes
+     */
+    void encode(const uint8_t* data, size_t len, uint8_t* parity) const;
+
+    /**
+     * Correct a codeword in place
+     * @param block Data followed by its nroots parity bytes
+     * @param len Total length (nroots < len <= RS_SYMBOLS)
+     * @return Bytes corrected (0: clean), or -1 if uncorrectable
+     */
+    int decode(uint8_t* block, size_t len) const;
+
+private:
+    uint8_t _nroots;
+    uint8_t _fcr;
+    uint8_t _genLog[RS_MAX_ROOTS + 1];  // Generator coefficients, log form
+
+    void syndromes(const uint8_t* block, size_t len, uint8_t* s) const;
+};
+
+} // namespace APRS
+
+#endif // APRS_REED_SOLOMON_H
@@ -0,0 +1,77 @@
+#include "APRS_RenderCache.h"
+#include <string.h>
+
+namespace APRS {
+
+#define FNV_OFFSET          0x811C9DC5u
+#define FNV_PRIME           0x01000193u
+
+RenderCache::RenderCache()
+    : _entries(nullptr), _count(0), _wordsPerEntry(0), _clock(0) {
+}
+
+void RenderCache::begin(Entry* entries, uint32_t* words, size_t count, size_t words_per_entry) {
+    _entries = entries;
+    _count = (entries && words) ? count : 0;
+    _wordsPerEntry = words_per_entry;
+    for (size_t i = 0; i < _count; i++) {
+        _entries[i].words = words + i * words_per_entry;
+    }
+    clear();
+}
+
+void RenderCache::clear() {
+    for (size_t i = 0; i < _count; i++) {
+        _entries[i].used = 0;
+    }
+    _clock = 0;
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+uint32_t RenderCache::key(const uint8_t* frame, size_t len, uint8_t mode) {
+    uint32_t hash = (FNV_OFFSET ^ mode) * FNV_PRIME;
+    for (size_t i = 0; i + 2 < len; i++) {
+        hash = (hash ^ frame[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+const RenderCache::Entry* RenderCache::find(uint32_t key, const uint8_t* frame, size_t len) {
+    for (size_t i = 0; i < _count; i++) {
+        Entry& e = _entries[i];
+        if (e.used && e.key == key && e.len == len &&
+            e.fcs[0] == frame[len - 2] && e.fcs[1] == frame[len - 1]) {
+            e.used = ++_clock;
+            _stats.hits++;
+            return &e;
+        }
+    }
+    _stats.misses++;
+    return nullptr;
+}
+
+RenderCache::Entry* RenderCache::store(uint32_t key, const uint8_t* frame, size_t len, size_t bits) {
+    if (_count == 0 || bits > capacityBits()) {
+        return nullptr;
+    }
+    Entry* victim = &_entries[0];
+    for (size_t i = 1; i < _count && victim->used; i++) {
+        if (_entries[i].used < victim->used) {
+            victim = &_entries[i];
+        }
+    }
+    if (victim->used) {
+        _stats.evictions++;
+    }
+    victim->key = key;
+    victim->used = ++_clock;
+    victim->len = (uint16_t)len;
+    victim->fcs[0] = frame[len - 2];
+    victim->fcs[1] = frame[len - 1];
+    victim->bits = (uint16_t)bits;
+    return victim;
+}
+
+} // namespace APRS
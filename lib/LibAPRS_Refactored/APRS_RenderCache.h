@@ -0,0 +1,110 @@
+#ifndef APRS_RENDER_CACHE_H
+#define APRS_RENDER_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// Render Cache Statistics
+// ============================================================================
+struct RenderCacheStats {
+    uint32_t hits = 0;          // Frames sent from a cached bitstream
+    uint32_t misses = 0;        // Frames encoded (and stored)
+    uint32_t evictions = 0;     // Stored bitstreams replaced by newer ones
+};
+
+// ============================================================================
+// Encoded-Frame Render Cache
+// ============================================================================
+
+/**
+ * Final on-air bitstreams of recently sent frames
+ *
+ * An entry holds the tones of one frame segment exactly as the encoder
+ * produced them (stuffed frame and closing flag, FX.25 block or IL2P
+ * frame), normalised to start after a mark tone. NRZI only depends on the
+ * tone before the segment, so a hit is replayed by copying the words,
+ * inverted if the line is on the space tone.
+ *
+ * Entries are found by a 32-bit FNV-1a hash of the frame without its FCS
+ * and the framing mode, and confirmed by length and FCS, so a repeat needs
+ * one pass over the bytes instead of stuffing, NRZI and any FEC. The
+ * least recently used entry is replaced. Storage is supplied by the
+ * caller, like HdlcEncoder's.
+ */
+class RenderCache {
+public:
+    enum class Kind : uint8_t {
+        Ax25,           // Stuffed frame and closing flag
+        Fx25,           // FX.25 block (ends in parity, not a flag)
+        Il2p            // IL2P frame
+    };
+
+    struct Entry {
+        uint32_t key;
+        uint32_t used;          // Use counter at the last hit (0: empty)
+        uint16_t len;           // Frame length including FCS
+        uint8_t fcs[2];
+        Kind kind;
+        uint16_t extra;         // FX.25 bytes added
+        uint16_t bits;          // Bitstream length
+        uint16_t stuffed;       // Stuffed bits in the bitstream
+        uint32_t* words;        // Tones, packed like HdlcEncoder's
+    };
+
+    RenderCache();
+
+    /**
+     * Attach storage and empty the cache
+     *
+     * @param entries Entry table
+     * @param words Bit storage, words_per_entry words for each entry
+     * @param count Number of entries (0: cache disabled)
+     * @param words_per_entry Words per entry
+     */
+    void begin(Entry* entries, uint32_t* words, size_t count, size_t words_per_entry);
+
+    /**
+     * Drop every entry (statistics are kept)
+     */
+    void clear();
+
+    bool isEnabled() const { return _count > 0; }
+
+    /**
+     * Cache key of a frame (addresses through FCS) under a framing mode
+     */
+    static uint32_t key(const uint8_t* frame, size_t len, uint8_t mode);
+
+    /**
+     * Entry for a frame, counting a hit or a miss
+     * @return nullptr on a miss
+     */
+    const Entry* find(uint32_t key, const uint8_t* frame, size_t len);
+
+    /**
+     * Entry to fill for a frame that missed: the least recently used one.
+     * The caller writes the tones to words and sets bits, stuffed, kind
+     * and extra.
+     *
+     * @return nullptr if the cache is disabled or the bitstream is too long
+     */
+    Entry* store(uint32_t key, const uint8_t* frame, size_t len, size_t bits);
+
+    const RenderCacheStats& stats() const { return _stats; }
+
+    size_t capacityBits() const { return _wordsPerEntry * 32; }
+
+private:
+    Entry* _entries;
+    size_t _count;
+    size_t _wordsPerEntry;
+    uint32_t _clock;
+    RenderCacheStats _stats;
+};
+
+} // namespace APRS
+
+#endif // APRS_RENDER_CACHE_H
@@ -0,0 +1,285 @@
+#include "APRS_Scheduler.h"
+
+namespace APRS {
+
+Scheduler::Scheduler()
+    : _lock(nullptr), _task(nullptr), _timer(nullptr),
+      _batchBegin(nullptr), _batchEnd(nullptr), _batchArg(nullptr), _count(0) {
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+bool Scheduler::begin(const SchedulerConfig& config) {
+    if (_timer) {
+        return false;
+    }
+
+    _config = config;
+    _lock = HAL::lockCreate();
+    if (!_lock) {
+        return false;
+    }
+    _timer = HAL::timerCreate(timerCallback, this, "aprs_sched");
+    if (!_timer) {
+        return false;
+    }
+
+    if (_config.use_task) {
+        if (!HAL::taskStart(taskEntry, this, "aprs_sched", _config.stack_bytes,
+                            _config.priority, _config.core, &_task)) {
+            HAL::timerStop(_timer);
+            _timer = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Scheduler::onBatch(JobFunction begin, JobFunction end, void* arg) {
+    HAL::lockTake(_lock);
+    _batchBegin = begin;
+    _batchEnd = end;
+    _batchArg = arg;
+    HAL::lockGive(_lock);
+}
+
+// ============================================================================
+// Jobs
+// ============================================================================
+JobId Scheduler::add(const JobConfig& job) {
+    if (!_timer || !job.function) {
+        return -1;
+    }
+
+    HAL::lockTake(_lock);
+    if (_count == SCHEDULER_MAX_JOBS) {
+        HAL::lockGive(_lock);
+        return -1;
+    }
+    JobId id = (JobId)_count++;
+    Job& slot = _jobs[id];
+    slot.config = job;
+    slot.stats = JobStats();
+    release(slot, HAL::micros() + (uint64_t)job.delay_ms * 1000);
+    rearm();
+    HAL::lockGive(_lock);
+    return id;
+}
+
+bool Scheduler::trigger(JobId id, uint32_t delay_ms) {
+    if (id < 0 || (size_t)id >= _count) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    release(_jobs[id], HAL::micros() + (uint64_t)delay_ms * 1000);
+    rearm();
+    HAL::lockGive(_lock);
+    return true;
+}
+
+bool Scheduler::cancel(JobId id) {
+    if (id < 0 || (size_t)id >= _count) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    _jobs[id].armed = false;
+    rearm();
+    HAL::lockGive(_lock);
+    return true;
+}
+
+bool Scheduler::setPeriod(JobId id, uint32_t period_ms) {
+    if (id < 0 || (size_t)id >= _count) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    _jobs[id].config.period_ms = period_ms;
+    HAL::lockGive(_lock);
+    return true;
+}
+
+const char* Scheduler::name(JobId id) const {
+    if (id < 0 || (size_t)id >= _count) {
+        return nullptr;
+    }
+    return _jobs[id].config.name;
+}
+
+JobStats Scheduler::stats(JobId id) const {
+    JobStats result;
+    if (id < 0 || (size_t)id >= _count) {
+        return result;
+    }
+    HAL::lockTake(_lock);
+    result = _jobs[id].stats;
+    HAL::lockGive(_lock);
+    return result;
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+uint32_t Scheduler::service() {
+    if (!_timer) {
+        return UINT32_MAX;
+    }
+
+    bool batch = false;
+    for (;;) {
+        HAL::lockTake(_lock);
+        uint64_t now = HAL::micros();
+        int index = next(now);
+        if (index < 0) {
+            break;                  // Keeps the lock for rearm()
+        }
+
+        Job& job = _jobs[index];
+        uint64_t late_us = now - job.release_us;
+        bool skip = job.config.deadline_ms != 0 && late_us > (uint64_t)job.config.deadline_ms * 1000;
+        if (skip) {
+            job.stats.missed++;
+        } else {
+            uint32_t late = (late_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)late_us;
+            job.stats.runs++;
+            job.stats.late_last_us = late;
+            job.stats.late_total_us += late;
+            if (late > job.stats.late_max_us) {
+                job.stats.late_max_us = late;
+            }
+        }
+        // Schedule the next release first, so the job may trigger() itself
+        advance(job, now);
+        JobFunction function = job.config.function;
+        void* arg = job.config.arg;
+        JobFunction batchBegin = batch ? nullptr : _batchBegin;
+        HAL::lockGive(_lock);
+
+        if (skip) {
+            continue;
+        }
+        if (batchBegin) {
+            batchBegin(_batchArg);
+        }
+        batch = true;
+
+        uint64_t start = HAL::micros();
+        function(arg);
+        uint64_t took = HAL::micros() - start;
+
+        HAL::lockTake(_lock);
+        if (took > _jobs[index].stats.run_max_us) {
+            _jobs[index].stats.run_max_us = (took > UINT32_MAX) ? UINT32_MAX : (uint32_t)took;
+        }
+        HAL::lockGive(_lock);
+    }
+
+    uint32_t wait_ms = rearm();
+    JobFunction batchEnd = batch ? _batchEnd : nullptr;
+    HAL::lockGive(_lock);
+
+    if (batchEnd) {
+        batchEnd(_batchArg);
+    }
+    return wait_ms;
+}
+
+// ============================================================================
+// Release bookkeeping (expects the lock to be held)
+// ============================================================================
+
+/**
+ * Released job to run first: highest priority, then earliest release
+ */
+int Scheduler::next(uint64_t now) const {
+    int best = -1;
+    for (size_t i = 0; i < _count; i++) {
+        const Job& job = _jobs[i];
+        if (!job.armed || job.release_us > now) {
+            continue;
+        }
+        if (best < 0 || job.config.priority > _jobs[best].config.priority ||
+            (job.config.priority == _jobs[best].config.priority && job.release_us < _jobs[best].release_us)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+void Scheduler::release(Job& job, uint64_t nominal_us) {
+    job.nominal_us = nominal_us;
+    job.release_us = nominal_us;
+    if (job.config.jitter_ms != 0) {
+        job.release_us += HAL::random32() % ((uint64_t)job.config.jitter_ms * 1000 + 1);
+    }
+    job.armed = true;
+}
+
+/**
+ * Next release of a job that has just been released: one period on along
+ * the grid. Grid points that have already passed collapse into a single
+ * release now and count as missed.
+ */
+void Scheduler::advance(Job& job, uint64_t now) {
+    if (job.config.period_ms == 0) {
+        job.armed = false;
+        return;
+    }
+
+    uint64_t period_us = (uint64_t)job.config.period_ms * 1000;
+    uint64_t nominal = job.nominal_us + period_us;
+    if (nominal <= now) {
+        uint64_t behind = (now - nominal) / period_us;
+        job.stats.missed += (uint32_t)behind;
+        nominal += behind * period_us;
+    }
+    release(job, nominal);
+}
+
+/**
+ * Arm the timer for the earliest release
+ *
+ * @return Milliseconds until then, rounded up (UINT32_MAX: nothing armed)
+ */
+uint32_t Scheduler::rearm() {
+    bool any = false;
+    uint64_t earliest = 0;
+    for (size_t i = 0; i < _count; i++) {
+        if (_jobs[i].armed && (!any || _jobs[i].release_us < earliest)) {
+            earliest = _jobs[i].release_us;
+            any = true;
+        }
+    }
+    if (!any) {
+        HAL::timerStop(_timer);
+        return UINT32_MAX;
+    }
+
+    HAL::timerArmAt(_timer, earliest);
+    uint64_t now = HAL::micros();
+    if (earliest <= now) {
+        return 0;
+    }
+    uint64_t wait_ms = (earliest - now + 999) / 1000;
+    return (wait_ms >= UINT32_MAX) ? UINT32_MAX - 1 : (uint32_t)wait_ms;
+}
+
+// ============================================================================
+// Task
+// ============================================================================
+void Scheduler::timerCallback(void* arg) {
+    HAL::taskNotify(static_cast<Scheduler*>(arg)->_task);
+}
+
+void Scheduler::taskEntry(void* arg) {
+    Scheduler* scheduler = static_cast<Scheduler*>(arg);
+    for (;;) {
+        HAL::taskWait(scheduler->service());
+    }
+}
+
+} // namespace APRS
@@ -0,0 +1,176 @@
+#ifndef APRS_SCHEDULER_H
+#define APRS_SCHEDULER_H
+
+#include "APRS_HAL.h"
+
+namespace APRS {
+
+// ============================================================================
+// Scheduler Types
+// ============================================================================
+#define SCHEDULER_MAX_JOBS  8
+
+typedef int8_t JobId;               // -1 is never a valid job
+typedef void (*JobFunction)(void* arg);
+
+/**
+ * A periodic or one-shot job
+ *
+ * Periodic releases stay on the grid delay_ms + n * period_ms from add(),
+ * however late a run starts, so the interval never drifts. Jitter moves
+ * each release by a fresh random 0..jitter_ms off that grid. A run that
+ * would start more than deadline_ms late is skipped and counted as missed.
+ */
+struct JobConfig {
+    const char* name = "";
+    JobFunction function = nullptr;
+    void* arg = nullptr;
+    uint32_t period_ms = 0;         // 0: one-shot, run again only by trigger()
+    uint32_t delay_ms = 0;          // First release after add()
+    uint32_t jitter_ms = 0;         // Random delay added to each release
+    uint32_t deadline_ms = 0;       // Skip a run this late (0: never skip)
+    uint8_t priority = 0;           // Higher runs first among released jobs
+};
+
+/**
+ * Per-job timing; lateness is start time minus release time
+ */
+struct JobStats {
+    uint32_t runs = 0;
+    uint32_t missed = 0;            // Skipped: past the deadline, or overrun by the next release
+    uint32_t late_last_us = 0;
+    uint32_t late_max_us = 0;
+    uint64_t late_total_us = 0;     // Over all runs, for the mean
+    uint32_t run_max_us = 0;        // Longest execution
+
+    uint32_t lateMeanUs() const { return runs ? (uint32_t)(late_total_us / runs) : 0; }
+};
+
+struct SchedulerConfig {
+    bool use_task = true;           // false: caller runs jobs with service()
+    int8_t core = 1;                // Core for the scheduler task (-1: no affinity)
+    uint8_t priority = 2;           // Scheduler task priority
+    uint32_t stack_bytes = 4096;    // Scheduler task stack (the jobs run on it)
+};
+
+// ============================================================================
+// Job Scheduler
+// ============================================================================
+
+/**
+ * Timer-driven job scheduler
+ *
+ * Holds up to SCHEDULER_MAX_JOBS jobs and one HAL timer armed for the
+ * earliest release. The timer wakes the scheduler task, which runs every
+ * released job in priority order and sleeps until the next one; nothing
+ * polls. Jobs released together run back to back, between the batch
+ * callbacks (e.g. to send them in one TX burst).
+ *
+ * add(), trigger() and cancel() may be called from any task, including
+ * from a job. On the native HAL there is no task: call service() and
+ * HAL::taskWait() its result, which sleeps the virtual clock until the
+ * timer fires.
+ */
+class Scheduler {
+public:
+    Scheduler();
+
+    /**
+     * Create the timer and start the scheduler task
+     * @return true on success
+     */
+    bool begin(const SchedulerConfig& config = SchedulerConfig());
+
+    /**
+     * True once begin() succeeded
+     */
+    bool isStarted() const { return _timer != nullptr; }
+
+    /**
+     * True if a scheduler task runs the jobs (false: call service())
+     */
+    bool isRunning() const { return _task != nullptr; }
+
+    /**
+     * Add a job; its first release is delay_ms from now
+     * @return Job id, or -1 if the table is full or the job has no function
+     */
+    JobId add(const JobConfig& job);
+
+    /**
+     * Release a job delay_ms from now (replacing its pending release); a
+     * periodic job continues on a grid from there
+     * @return false for an invalid id
+     */
+    bool trigger(JobId id, uint32_t delay_ms = 0);
+
+    /**
+     * Stop releasing a job until trigger()
+     * @return false for an invalid id
+     */
+    bool cancel(JobId id);
+
+    /**
+     * Change a job's period (0: one-shot), effective from its next release
+     * @return false for an invalid id
+     */
+    bool setPeriod(JobId id, uint32_t period_ms);
+
+    /**
+     * Set callbacks around each batch of jobs released together
+     */
+    void onBatch(JobFunction begin, JobFunction end, void* arg);
+
+    /**
+     * Number of jobs added
+     */
+    size_t jobs() const { return _count; }
+
+    /**
+     * Name given to add(), or nullptr for an invalid id
+     */
+    const char* name(JobId id) const;
+
+    /**
+     * Timing of one job
+     */
+    JobStats stats(JobId id) const;
+
+    /**
+     * Run every released job on the calling task and re-arm the timer
+     *
+     * @return Milliseconds until the next release (UINT32_MAX: none)
+     */
+    uint32_t service();
+
+private:
+    struct Job {
+        JobConfig config;
+        bool armed;
+        uint64_t nominal_us;        // Release on the grid, before jitter
+        uint64_t release_us;        // nominal_us plus this release's jitter
+        JobStats stats;
+    };
+
+    SchedulerConfig _config;
+    HAL::Lock _lock;
+    HAL::Task _task;
+    HAL::Timer _timer;
+    JobFunction _batchBegin;
+    JobFunction _batchEnd;
+    void* _batchArg;
+
+    Job _jobs[SCHEDULER_MAX_JOBS];
+    size_t _count;
+
+    int next(uint64_t now) const;
+    void release(Job& job, uint64_t nominal_us);
+    void advance(Job& job, uint64_t now);
+    uint32_t rearm();
+    static void timerCallback(void* arg);
+    static void taskEntry(void* arg);
+};
+
+} // namespace APRS
+
+#endif // APRS_SCHEDULER_H
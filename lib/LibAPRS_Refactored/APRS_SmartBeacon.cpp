@@ -0,0 +1,74 @@
+#include "APRS_SmartBeacon.h"
+
+namespace APRS {
+
+SmartBeacon::SmartBeacon() : _lastMs(0), _lastCourse(-1), _started(false) {
+}
+
+void SmartBeacon::begin(const SmartBeaconConfig& config) {
+    _config = config;
+    _stats = SmartBeaconStats();
+    _lastMs = 0;
+    _lastCourse = -1;
+    _started = false;
+}
+
+uint32_t SmartBeacon::intervalMs(float speed_kmh) const {
+    if (speed_kmh <= _config.slow_speed_kmh) {
+        return (uint32_t)_config.slow_rate_s * 1000;
+    }
+    if (speed_kmh >= _config.fast_speed_kmh) {
+        return (uint32_t)_config.fast_rate_s * 1000;
+    }
+    return (uint32_t)(_config.fast_rate_s * 1000.0f * _config.fast_speed_kmh / speed_kmh);
+}
+
+float SmartBeacon::turnThreshold(float speed_kmh) const {
+    float speed = (speed_kmh > 1.0f) ? speed_kmh : 1.0f;
+    return _config.min_turn_angle + _config.turn_slope / speed;
+}
+
+uint32_t SmartBeacon::dueInMs(uint32_t now, float speed_kmh) const {
+    if (!_started) {
+        return 0;
+    }
+    uint32_t since = now - _lastMs;
+    uint32_t interval = intervalMs(speed_kmh);
+    return (since >= interval) ? 0 : interval - since;
+}
+
+BeaconReason SmartBeacon::update(uint32_t now, float speed_kmh, int16_t course) {
+    bool moving = speed_kmh > _config.slow_speed_kmh;
+    BeaconReason reason = BeaconReason::None;
+
+    if (!_started) {
+        reason = BeaconReason::First;
+    } else {
+        uint32_t since = now - _lastMs;
+        if (moving && course >= 0 && _lastCourse >= 0 &&
+            since >= (uint32_t)_config.min_turn_time_s * 1000) {
+            int change = (course - _lastCourse) % 360;
+            change = (change < 0) ? change + 360 : change;
+            change = (change > 180) ? 360 - change : change;
+            if (change > turnThreshold(speed_kmh)) {
+                reason = BeaconReason::Turn;
+            }
+        }
+        if (reason == BeaconReason::None && since >= intervalMs(speed_kmh)) {
+            reason = BeaconReason::Interval;
+        }
+    }
+
+    switch (reason) {
+    case BeaconReason::First: _stats.first++; break;
+    case BeaconReason::Interval: _stats.interval++; break;
+    case BeaconReason::Turn: _stats.turn++; break;
+    default: return reason;
+    }
+    _started = true;
+    _lastMs = now;
+    _lastCourse = (moving && course >= 0) ? course : -1;
+    return reason;
+}
+
+} // namespace APRS
@@ -0,0 +1,111 @@
+#ifndef APRS_SMART_BEACON_H
+#define APRS_SMART_BEACON_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace APRS {
+
+// ============================================================================
+// SmartBeaconing Parameters
+// ============================================================================
+
+/**
+ * SmartBeaconing parameters (speeds in km/h, times in seconds)
+ *
+ * Parked or slower than slow_speed: one beacon per slow_rate. From
+ * fast_speed up: one per fast_rate. In between the interval shrinks as
+ * fast_rate * fast_speed / speed, so beacons come at about the same
+ * distance apart. A heading change of more than min_turn_angle +
+ * turn_slope / speed since the last beacon sends one early (corner
+ * pegging), at most once per min_turn_time.
+ */
+struct SmartBeaconConfig {
+    uint16_t slow_speed_kmh = 5;
+    uint16_t slow_rate_s = 1800;
+    uint16_t fast_speed_kmh = 90;
+    uint16_t fast_rate_s = 60;
+    uint16_t min_turn_time_s = 15;
+    uint16_t min_turn_angle = 20;   // Degrees
+    uint16_t turn_slope = 240;      // Degrees * km/h
+};
+
+/**
+ * Why a beacon is due
+ */
+enum class BeaconReason : uint8_t {
+    None,
+    First,          // Nothing sent yet
+    Interval,       // The interval for the current speed has passed
+    Turn            // Corner pegging
+};
+
+/**
+ * Beacons decided so far, by reason
+ */
+struct SmartBeaconStats {
+    uint32_t first = 0;
+    uint32_t interval = 0;
+    uint32_t turn = 0;
+};
+
+// ============================================================================
+// SmartBeaconing
+// ============================================================================
+
+/**
+ * Beacon policy driven by GPS speed and course
+ *
+ * Feed every fix to update(); when it returns a reason, send a position
+ * report. Times are HAL::millis() values (wrap-around is handled by
+ * unsigned differences); the component keeps no other clock and does no
+ * I/O, so a host test can replay a track through it.
+ */
+class SmartBeacon {
+public:
+    SmartBeacon();
+
+    /**
+     * Set the parameters and forget the last beacon
+     */
+    void begin(const SmartBeaconConfig& config);
+
+    /**
+     * Decide on a fix; a reason other than None counts as a beacon sent
+     * now with this course
+     *
+     * @param speed_kmh Ground speed (negative if unknown: treated as parked)
+     * @param course Course over ground in degrees (negative if unknown:
+     *               no corner pegging)
+     */
+    BeaconReason update(uint32_t now, float speed_kmh, int16_t course);
+
+    /**
+     * Beacon interval at this speed
+     */
+    uint32_t intervalMs(float speed_kmh) const;
+
+    /**
+     * Heading change that pegs a corner at this speed (degrees)
+     */
+    float turnThreshold(float speed_kmh) const;
+
+    /**
+     * Time until the interval at this speed runs out (0: due)
+     */
+    uint32_t dueInMs(uint32_t now, float speed_kmh) const;
+
+    const SmartBeaconConfig& config() const { return _config; }
+    const SmartBeaconStats& stats() const { return _stats; }
+
+private:
+    SmartBeaconConfig _config;
+    SmartBeaconStats _stats;
+    uint32_t _lastMs;           // millis() of the last beacon
+    int16_t _lastCourse;        // Course of the last beacon, -1 if parked
+    bool _started;
+};
+
+} // namespace APRS
+
+#endif // APRS_SMART_BEACON_H
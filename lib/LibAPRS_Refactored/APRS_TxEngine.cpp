@@ -0,0 +1,453 @@
+#include "APRS_TxEngine.h"
+#include <string.h>
+
+namespace APRS {
+
+TxEngine::TxEngine()
+    : _protocol(nullptr), _lock(nullptr), _task(nullptr),
+      _callback(nullptr), _callbackUser(nullptr),
+      _carrierSense(nullptr), _carrierUser(nullptr),
+      _head(0), _count(0), _inFlight(0), _nextHandle(1), _openGroup(0),
+      _nextGroup(1), _lastTxEnd(0), _historyNext(0) {
+    memset(_history, 0, sizeof(_history));
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+bool TxEngine::begin(Protocol* protocol, const TxEngineConfig& config) {
+    if (!protocol || _protocol) {
+        return false;
+    }
+
+    _config = config;
+    _lock = HAL::lockCreate();
+    if (!_lock) {
+        return false;
+    }
+    _protocol = protocol;
+    _ledger.begin(_config.duty_window_ms);
+
+    if (_config.use_task) {
+        if (!HAL::taskStart(taskEntry, this, "aprs_tx", _config.stack_bytes,
+                            _config.priority, _config.core, &_task)) {
+            _protocol = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TxEngine::onComplete(TxCallback callback, void* user) {
+    HAL::lockTake(_lock);
+    _callback = callback;
+    _callbackUser = user;
+    HAL::lockGive(_lock);
+}
+
+void TxEngine::setChannelAccess(uint8_t persistence, uint16_t slot_ms, bool full_duplex) {
+    HAL::lockTake(_lock);
+    _config.persistence = persistence;
+    _config.slot_ms = slot_ms;
+    _config.full_duplex = full_duplex;
+    HAL::lockGive(_lock);
+}
+
+void TxEngine::setCarrierSense(CarrierSense sense, void* user) {
+    HAL::lockTake(_lock);
+    _carrierSense = sense;
+    _carrierUser = user;
+    HAL::lockGive(_lock);
+}
+
+// ============================================================================
+// Queue
+// ============================================================================
+TxHandle TxEngine::submit(const uint8_t* frame, size_t len, uint8_t coalesce_key,
+                          TxPriority priority) {
+    if (!_protocol || !frame || len == 0 || len > AX25_MAX_FRAME_LEN) {
+        return 0;
+    }
+
+    HAL::lockTake(_lock);
+
+    TxHandle handle = _nextHandle++;
+    if (_nextHandle == 0) _nextHandle = 1;
+
+    // Replace a queued frame with the same key in place
+    TxHandle superseded = 0;
+    Slot* slot = nullptr;
+    if (coalesce_key != 0) {
+        for (size_t i = _inFlight; i < _count; i++) {
+            Slot& s = _slots[(_head + i) % TX_QUEUE_DEPTH];
+            if (s.key == coalesce_key) {
+                superseded = s.handle;
+                slot = &s;
+                break;
+            }
+        }
+    }
+
+    if (!slot) {
+        if (_count == TX_QUEUE_DEPTH) {
+            HAL::lockGive(_lock);
+            return 0;
+        }
+        slot = &_slots[(_head + _count) % TX_QUEUE_DEPTH];
+        slot->group = _openGroup;
+        _count++;
+    }
+
+    slot->handle = handle;
+    slot->key = coalesce_key;
+    slot->priority = priority;
+    slot->len = (uint16_t)len;
+    memcpy(slot->data, frame, len);
+
+    if (superseded) {
+        record(superseded, TxState::Superseded);
+    }
+    HAL::lockGive(_lock);
+
+    if (superseded) {
+        notify(superseded, TxState::Superseded);
+    }
+    HAL::taskNotify(_task);
+    return handle;
+}
+
+bool TxEngine::beginBurst() {
+    if (!_protocol) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    bool ok = (_openGroup == 0);
+    if (ok) {
+        _openGroup = _nextGroup++;
+        if (_nextGroup == 0) _nextGroup = 1;
+    }
+    HAL::lockGive(_lock);
+    return ok;
+}
+
+bool TxEngine::endBurst() {
+    if (!_protocol) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    bool ok = (_openGroup != 0);
+    _openGroup = 0;
+    HAL::lockGive(_lock);
+
+    HAL::taskNotify(_task);
+    return ok;
+}
+
+TxState TxEngine::state(TxHandle handle) const {
+    if (handle == 0 || !_protocol) {
+        return TxState::Unknown;
+    }
+
+    TxState result = TxState::Unknown;
+    HAL::lockTake(_lock);
+    for (size_t i = 0; i < _count; i++) {
+        if (_slots[(_head + i) % TX_QUEUE_DEPTH].handle == handle) {
+            result = (i < _inFlight) ? TxState::Sending : TxState::Queued;
+            break;
+        }
+    }
+    for (size_t i = 0; result == TxState::Unknown && i < TX_HISTORY_LEN; i++) {
+        if (_history[i].handle == handle) {
+            result = _history[i].state;
+        }
+    }
+    HAL::lockGive(_lock);
+    return result;
+}
+
+size_t TxEngine::pending() const {
+    if (!_protocol) {
+        return 0;
+    }
+    HAL::lockTake(_lock);
+    size_t n = _count;
+    HAL::lockGive(_lock);
+    return n;
+}
+
+TxEngineStats TxEngine::stats() const {
+    TxEngineStats result;
+    if (!_protocol) {
+        return result;
+    }
+    HAL::lockTake(_lock);
+    result = _stats;
+    HAL::lockGive(_lock);
+    return result;
+}
+
+DutyCycleStatus TxEngine::dutyCycle() const {
+    DutyCycleStatus result;
+    if (!_protocol) {
+        return result;
+    }
+    HAL::lockTake(_lock);
+    result.window_ms = _ledger.windowMs();
+    result.window = _ledger.totals(HAL::millis());
+    result.limit_permille = (uint16_t)(_config.max_duty_percent * 10);
+    HAL::lockGive(_lock);
+
+    if (result.window_ms > 0) {
+        uint64_t permille = (uint64_t)result.window.airtime_ms * 1000 / result.window_ms;
+        result.duty_permille = (uint16_t)(permille > 1000 ? 1000 : permille);
+    }
+    return result;
+}
+
+// ============================================================================
+// Transmission
+// ============================================================================
+bool TxEngine::service() {
+    if (!_protocol) {
+        return false;
+    }
+
+    HAL::lockTake(_lock);
+    bool ready = readyCount() > 0;
+    uint32_t lastTxEnd = _lastTxEnd;
+    HAL::lockGive(_lock);
+    if (!ready) {
+        return false;
+    }
+
+    // Wait out the gap after the previous key-up and win the channel with
+    // the frames still queued, so a newer frame with the same key can
+    // replace one until the moment it is taken
+    uint32_t idle = HAL::millis() - lastTxEnd;
+    if (lastTxEnd != 0 && idle < _config.gap_ms) {
+        HAL::delayMs(_config.gap_ms - idle);
+    }
+    waitForChannel();
+
+    // Take the head frame, or the whole burst it belongs to. The slots
+    // stay in the queue (marked in flight) until sent, so submit() must
+    // not coalesce into them.
+    HAL::lockTake(_lock);
+    size_t count = readyCount();
+    if (count == 0) {
+        HAL::lockGive(_lock);
+        return false;
+    }
+
+    // A key-up over the duty-cycle budget sheds its Low priority frames
+    // and waits; the frames stay open to coalescing meanwhile
+    TxHandle dropped[TX_QUEUE_DEPTH];
+    size_t ndropped = 0;
+    uint32_t wait = admit(count, dropped, ndropped);
+    if (wait > 0 && promoteUrgent(count)) {
+        count = 1;
+        wait = 0;
+    }
+    if (wait > TX_DUTY_POLL_MS) {
+        wait = TX_DUTY_POLL_MS;
+    }
+    _stats.deferred_ms += wait;
+    if (wait > 0) {
+        count = 0;
+    }
+    _inFlight = count;
+    const uint8_t* frames[TX_QUEUE_DEPTH];
+    size_t lens[TX_QUEUE_DEPTH];
+    TxHandle handles[TX_QUEUE_DEPTH];
+    for (size_t i = 0; i < count; i++) {
+        const Slot& s = _slots[(_head + i) % TX_QUEUE_DEPTH];
+        frames[i] = s.data;
+        lens[i] = s.len;
+        handles[i] = s.handle;
+    }
+    HAL::lockGive(_lock);
+
+    for (size_t i = 0; i < ndropped; i++) {
+        notify(dropped[i], TxState::Dropped);
+    }
+    if (count == 0) {
+        HAL::delayMs(wait);
+        return true;
+    }
+
+    bool ok = _protocol->transmitFrames(frames, lens, count);
+    _lastTxEnd = HAL::millis();
+    if (_lastTxEnd == 0) _lastTxEnd = 1;
+
+    TxState result = ok ? TxState::Sent : TxState::Failed;
+    HAL::lockTake(_lock);
+    _head = (_head + count) % TX_QUEUE_DEPTH;
+    _count -= count;
+    _inFlight = 0;
+    for (size_t i = 0; i < count; i++) {
+        record(handles[i], result);
+    }
+    if (ok) {
+        const TxStats& tx = _protocol->lastStats();
+        _stats.keyups++;
+        _stats.frames += tx.frames;
+        _stats.airtime_ms += tx.airtime_ms;
+        _stats.saved_ms += tx.saved_ms;
+        _stats.bits += tx.bits;
+        _ledger.record(_lastTxEnd, tx.airtime_ms, tx.frames, tx.bits);
+    }
+    HAL::lockGive(_lock);
+
+    for (size_t i = 0; i < count; i++) {
+        notify(handles[i], result);
+    }
+    return true;
+}
+
+// Frames at the head ready to send (expects the lock to be held): the
+// head frame, or the whole burst it belongs to once closed; 0 if none
+size_t TxEngine::readyCount() const {
+    if (_count == 0 || (_slots[_head].group != 0 && _slots[_head].group == _openGroup)) {
+        return 0;
+    }
+    uint8_t group = _slots[_head].group;
+    size_t count = 1;
+    while (group != 0 && count < _count &&
+           _slots[(_head + count) % TX_QUEUE_DEPTH].group == group) {
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+// Duty-cycle limit (admit(), promoteUrgent() and removeSlot() expect the
+// lock to be held)
+// ============================================================================
+
+// Decide on the count frames at the head: returns how long they must wait
+// (0: send now). Low priority frames are removed if the key-up does not
+// fit, and everything if the rest could never fit the budget; their
+// handles go to dropped for notify().
+uint32_t TxEngine::admit(size_t& count, TxHandle* dropped, size_t& ndropped) {
+    if (_config.max_duty_percent == 0) {
+        return 0;
+    }
+    uint32_t budget = (uint32_t)((uint64_t)_config.duty_window_ms * _config.max_duty_percent / 100);
+    uint32_t now = HAL::millis();
+
+    for (int pass = 0; pass < 2 && count > 0; pass++) {
+        const uint8_t* frames[TX_QUEUE_DEPTH];
+        size_t lens[TX_QUEUE_DEPTH];
+        bool urgent = false;
+        for (size_t i = 0; i < count; i++) {
+            const Slot& s = _slots[(_head + i) % TX_QUEUE_DEPTH];
+            frames[i] = s.data;
+            lens[i] = s.len;
+            urgent = urgent || s.priority == TxPriority::Urgent;
+        }
+        uint32_t bits = _protocol->keyupBits(frames, lens, count);
+        if (urgent || bits == 0) {
+            return 0;           // Invalid frames fail in transmitFrames()
+        }
+        uint32_t wait = _ledger.waitMs(now, _protocol->airtimeMs(bits), budget);
+        if (wait == 0 || (pass > 0 && wait != UINT32_MAX)) {
+            return wait;
+        }
+
+        // First pass: drop Low priority frames; second: a key-up that can
+        // never fit the budget
+        for (size_t i = count; i-- > 0;) {
+            const Slot& s = _slots[(_head + i) % TX_QUEUE_DEPTH];
+            if (pass > 0 || s.priority == TxPriority::Low) {
+                dropped[ndropped++] = s.handle;
+                record(s.handle, TxState::Dropped);
+                removeSlot(i);
+                count--;
+                _stats.dropped++;
+            }
+        }
+    }
+    return 0;
+}
+
+// Move the first Urgent frame queued on its own behind the count frames
+// at the head to the front, so a deferred key-up does not hold it back
+bool TxEngine::promoteUrgent(size_t count) {
+    for (size_t i = count; i < _count; i++) {
+        const Slot& s = _slots[(_head + i) % TX_QUEUE_DEPTH];
+        if (s.priority == TxPriority::Urgent && s.group == 0) {
+            Slot urgent = s;
+            removeSlot(i);
+            _head = (_head + TX_QUEUE_DEPTH - 1) % TX_QUEUE_DEPTH;
+            _slots[_head] = urgent;
+            _count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TxEngine::removeSlot(size_t index) {
+    for (size_t i = index; i + 1 < _count; i++) {
+        _slots[(_head + i) % TX_QUEUE_DEPTH] = _slots[(_head + i + 1) % TX_QUEUE_DEPTH];
+    }
+    _count--;
+}
+
+// ============================================================================
+// p-persistence CSMA
+// ============================================================================
+void TxEngine::waitForChannel() {
+    for (;;) {
+        HAL::lockTake(_lock);
+        CarrierSense sense = _carrierSense;
+        void* user = _carrierUser;
+        uint8_t persistence = _config.persistence;
+        uint16_t slot_ms = _config.slot_ms;
+        bool full_duplex = _config.full_duplex;
+        HAL::lockGive(_lock);
+
+        if (full_duplex) {
+            return;
+        }
+        bool busy = sense && sense(user);
+        if (!busy && (persistence == 255 || (HAL::random32() & 0xFF) <= persistence)) {
+            return;
+        }
+        HAL::delayMs(slot_ms);
+    }
+}
+
+void TxEngine::taskEntry(void* arg) {
+    TxEngine* engine = static_cast<TxEngine*>(arg);
+    for (;;) {
+        if (!engine->service()) {
+            HAL::taskWait(UINT32_MAX);
+        }
+    }
+}
+
+// ============================================================================
+// Completion tracking (record() expects the lock to be held)
+// ============================================================================
+void TxEngine::record(TxHandle handle, TxState state) {
+    _history[_historyNext].handle = handle;
+    _history[_historyNext].state = state;
+    _historyNext = (_historyNext + 1) % TX_HISTORY_LEN;
+}
+
+void TxEngine::notify(TxHandle handle, TxState state) {
+    HAL::lockTake(_lock);
+    TxCallback callback = _callback;
+    void* user = _callbackUser;
+    HAL::lockGive(_lock);
+
+    if (callback) {
+        callback(handle, state, user);
+    }
+}
+
+} // namespace APRS
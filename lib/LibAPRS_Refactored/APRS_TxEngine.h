@@ -0,0 +1,264 @@
+#ifndef APRS_TX_ENGINE_H
+#define APRS_TX_ENGINE_H
+
+#include "APRS_Protocol.h"
+#include "APRS_AirtimeLedger.h"
+#include "APRS_HAL.h"
+
+namespace APRS {
+
+// ============================================================================
+// Transmit Queue Types
+// ============================================================================
+#define TX_QUEUE_DEPTH      8       // Frames waiting to be transmitted
+#define TX_HISTORY_LEN      16      // Completed handles remembered by state()
+#define TX_DUTY_POLL_MS     1000    // Longest sleep while deferred by the duty cycle
+
+typedef uint32_t TxHandle;          // 0 is never a valid handle
+
+enum class TxState : uint8_t {
+    Unknown,        // Never issued, or too old to be remembered
+    Queued,         // Waiting in the queue
+    Sending,        // Being modulated now
+    Sent,           // Transmitted
+    Failed,         // Protocol rejected the frame
+    Superseded,     // Replaced in the queue by a newer frame with the same key
+    Dropped         // Low priority, discarded to keep within the duty cycle
+};
+
+/**
+ * What the duty-cycle limit does with a frame whose key-up does not fit
+ * the airtime budget
+ */
+enum class TxPriority : uint8_t {
+    Low,            // Dropped (e.g. telemetry definitions, resent anyway)
+    Normal,         // Deferred until the budget allows it
+    Urgent          // Sent regardless, ahead of deferred frames (still booked)
+};
+
+/**
+ * Completion callback, called once per handle with its final state
+ * (Sent, Failed or Superseded). Runs on the TX task for Sent/Failed and on
+ * the submitting task for Superseded, so keep it short.
+ */
+typedef void (*TxCallback)(TxHandle handle, TxState state, void* user);
+
+/**
+ * Carrier sense: return true while the channel is busy
+ */
+typedef bool (*CarrierSense)(void* user);
+
+struct TxEngineConfig {
+    bool use_task = true;           // false: caller drains with service()
+    int8_t core = 0;                // Core for the TX task (-1: no affinity)
+    uint8_t priority = 5;           // TX task priority
+    uint32_t stack_bytes = 4096;    // TX task stack
+    uint16_t gap_ms = 1000;         // Minimum channel gap between key-ups
+    uint8_t persistence = 255;      // p-persistence: key up in a free slot if
+                                    // random(0..255) <= persistence
+    uint16_t slot_ms = 100;         // p-persistence slot time
+    bool full_duplex = false;       // Key up without waiting for the channel
+    uint8_t max_duty_percent = 0;   // Airtime limit per window (0: no limit)
+    uint32_t duty_window_ms = 600000;   // Rolling window of the limit and ledger
+};
+
+/**
+ * Cumulative engine counters
+ */
+struct TxEngineStats {
+    uint32_t keyups = 0;            // PTT cycles
+    uint32_t frames = 0;            // Frames transmitted
+    uint32_t airtime_ms = 0;        // Total PTT-on time
+    uint32_t saved_ms = 0;          // Airtime saved by bursts
+    uint32_t bits = 0;              // On-air bits sent
+    uint32_t dropped = 0;           // Frames dropped by the duty-cycle limit
+    uint32_t deferred_ms = 0;       // Time key-ups waited for the duty cycle
+};
+
+/**
+ * Airtime ledger over the rolling window, for diagnostics
+ */
+struct DutyCycleStatus {
+    uint32_t window_ms = 0;
+    AirtimeTotals window;           // Key-ups within the window
+    uint16_t duty_permille = 0;     // Share of the window the PTT was on
+    uint16_t limit_permille = 0;    // Configured limit (0: none)
+};
+
+// ============================================================================
+// Asynchronous Transmit Engine
+// ============================================================================
+
+/**
+ * Bounded queue of encoded AX.25 frames drained by a dedicated TX task.
+ *
+ * submit() copies the frame and returns immediately; the TX task keys the
+ * radio and modulates frames one at a time, so the caller never blocks on
+ * I2S. A frame submitted with a non-zero coalesce key replaces any queued
+ * (not yet sending) frame with the same key, keeping its place in line, so
+ * a backlog never transmits stale data.
+ *
+ * Before each key-up the engine waits for a clear channel using
+ * p-persistence: while carrier sense reports a busy channel, or the slot
+ * is not won, it waits slot_ms and tries again.
+ *
+ * Frames submitted between beginBurst() and endBurst() form a burst: the
+ * TX task holds them until the burst is closed and then sends them all in
+ * a single key-up (Protocol::transmitFrames()).
+ *
+ * Every key-up is booked in a rolling airtime ledger. With
+ * max_duty_percent set, a key-up that would take the window over its
+ * budget (Protocol's exact airtime estimate) first loses its Low priority
+ * frames; the rest waits, still open to coalescing, until enough airtime
+ * has left the window. A key-up longer than the whole budget is dropped.
+ * Urgent frames are never held back: one queued behind a deferred key-up
+ * goes first.
+ */
+class TxEngine {
+public:
+    TxEngine();
+
+    /**
+     * Attach to a protocol instance and start the TX task
+     *
+     * @param protocol Initialized protocol (owned by the caller)
+     * @param config Engine configuration
+     * @return true on success
+     */
+    bool begin(Protocol* protocol, const TxEngineConfig& config);
+
+    /**
+     * True once begin() succeeded
+     */
+    bool isStarted() const { return _protocol != nullptr; }
+
+    /**
+     * True if a TX task drains the queue (false: call service())
+     */
+    bool isRunning() const { return _task != nullptr; }
+
+    /**
+     * Queue an encoded frame
+     *
+     * @param frame Frame from Protocol::encodeFrame()
+     * @param len Frame length
+     * @param coalesce_key Non-zero to replace a queued frame with this key
+     * @param priority Treatment under the duty-cycle limit
+     * @return Handle, or 0 if the queue is full or the frame is invalid
+     */
+    TxHandle submit(const uint8_t* frame, size_t len, uint8_t coalesce_key = 0,
+                    TxPriority priority = TxPriority::Normal);
+
+    /**
+     * Start collecting submitted frames into one key-up
+     * @return false if a burst is already open or the engine is not started
+     */
+    bool beginBurst();
+
+    /**
+     * Release the open burst to the TX task
+     * @return false if no burst was open
+     */
+    bool endBurst();
+
+    /**
+     * True between beginBurst() and endBurst()
+     */
+    bool inBurst() const { return _openGroup != 0; }
+
+    /**
+     * Current state of a handle
+     */
+    TxState state(TxHandle handle) const;
+
+    /**
+     * Number of frames queued or being sent
+     */
+    size_t pending() const;
+
+    /**
+     * Set p-persistence CSMA parameters (KISS P, SLOTTIME and FullDuplex)
+     */
+    void setChannelAccess(uint8_t persistence, uint16_t slot_ms, bool full_duplex = false);
+
+    /**
+     * Set the carrier sense used before each key-up (nullptr: none)
+     */
+    void setCarrierSense(CarrierSense sense, void* user);
+
+    /**
+     * Cumulative key-up, frame and airtime counters
+     */
+    TxEngineStats stats() const;
+
+    /**
+     * Airtime, key-ups, frames and bits within the rolling window
+     */
+    DutyCycleStatus dutyCycle() const;
+
+    /**
+     * Set the completion callback
+     */
+    void onComplete(TxCallback callback, void* user);
+
+    /**
+     * Transmit the next queued frame (or closed burst) on the calling task
+     *
+     * While the duty cycle defers the key-up this sleeps up to
+     * TX_DUTY_POLL_MS and returns true without sending.
+     *
+     * @return true if anything was taken from the queue or deferred
+     */
+    bool service();
+
+private:
+    struct Slot {
+        TxHandle handle;
+        uint8_t key;
+        uint8_t group;              // Burst id (0: frame is sent on its own)
+        TxPriority priority;
+        uint16_t len;
+        uint8_t data[AX25_MAX_FRAME_LEN];
+    };
+
+    struct Completed {
+        TxHandle handle;
+        TxState state;
+    };
+
+    Protocol* _protocol;
+    TxEngineConfig _config;
+    HAL::Lock _lock;
+    HAL::Task _task;
+    TxCallback _callback;
+    void* _callbackUser;
+    CarrierSense _carrierSense;
+    void* _carrierUser;
+
+    Slot _slots[TX_QUEUE_DEPTH];
+    size_t _head;
+    size_t _count;                  // Includes the slots being sent
+    size_t _inFlight;               // Slots at the head being sent
+    TxHandle _nextHandle;
+    uint8_t _openGroup;
+    uint8_t _nextGroup;
+    uint32_t _lastTxEnd;
+    TxEngineStats _stats;
+    AirtimeLedger _ledger;
+
+    Completed _history[TX_HISTORY_LEN];
+    size_t _historyNext;
+
+    size_t readyCount() const;
+    void waitForChannel();
+    uint32_t admit(size_t& count, TxHandle* dropped, size_t& ndropped);
+    bool promoteUrgent(size_t count);
+    void removeSlot(size_t index);
+    void record(TxHandle handle, TxState state);
+    void notify(TxHandle handle, TxState state);
+    static void taskEntry(void* arg);
+};
+
+} // namespace APRS
+
+#endif // APRS_TX_ENGINE_H
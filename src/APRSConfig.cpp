@@ -28,11 +28,23 @@ APRSConfig getDefaultAPRSConfig()
     config.frequency = RADIO_FREC;
     config.preamble_ms = DEFAULT_PREAMBLE_MS;
     config.tail_ms = DEFAULT_TAIL_MS;
-    config.update_interval_min = APRS_TX_CYCLE_SECONDS / 60;  // Convert seconds to minutes
+    config.update_interval_min = clampUpdateInterval(APRS_TX_CYCLE_SECONDS / 60);  // Convert seconds to minutes
+    config.smart_beacon = DEFAULT_SMART_BEACON;
+    config.smart_beacon_params = APRS::SmartBeaconConfig();
     
     return config;
 }
 
+/**
+ * Limit an update interval to the range the portal accepts
+ */
+uint16_t clampUpdateInterval(int minutes)
+{
+    if (minutes < UPDATE_INTERVAL_MIN) return UPDATE_INTERVAL_MIN;
+    if (minutes > UPDATE_INTERVAL_MAX) return UPDATE_INTERVAL_MAX;
+    return (uint16_t)minutes;
+}
+
 /**
  * Check if APRS has been configured
  */
@@ -83,7 +95,20 @@ APRSConfig loadAPRSConfig()
     config.frequency = settings_get_float("frequency", RADIO_FREC);
     config.preamble_ms = settings_get_int("preamble_ms", DEFAULT_PREAMBLE_MS);
     config.tail_ms = settings_get_int("tail_ms", DEFAULT_TAIL_MS);
-    config.update_interval_min = settings_get_int("update_min", APRS_TX_CYCLE_SECONDS / 60);
+    // Configs saved before the portal limited it may hold 0, which would
+    // turn the periodic jobs into one-shots
+    config.update_interval_min = clampUpdateInterval(settings_get_int("update_min", APRS_TX_CYCLE_SECONDS / 60));
+    
+    // SmartBeaconing (keys absent on configs saved before it existed)
+    APRS::SmartBeaconConfig& sb = config.smart_beacon_params;
+    config.smart_beacon = settings_get_bool("smart_beacon", DEFAULT_SMART_BEACON);
+    sb.slow_speed_kmh = settings_get_int("sb_slow_kmh", sb.slow_speed_kmh);
+    sb.slow_rate_s = settings_get_int("sb_slow_s", sb.slow_rate_s);
+    sb.fast_speed_kmh = settings_get_int("sb_fast_kmh", sb.fast_speed_kmh);
+    sb.fast_rate_s = settings_get_int("sb_fast_s", sb.fast_rate_s);
+    sb.min_turn_time_s = settings_get_int("sb_turn_s", sb.min_turn_time_s);
+    sb.min_turn_angle = settings_get_int("sb_turn_deg", sb.min_turn_angle);
+    sb.turn_slope = settings_get_int("sb_turn_slope", sb.turn_slope);
     
     return config;
 }
@@ -112,6 +137,16 @@ void saveAPRSConfig(const APRSConfig& config)
     settings_put_int("tail_ms", config.tail_ms);
     settings_put_int("update_min", config.update_interval_min);
     
+    const APRS::SmartBeaconConfig& sb = config.smart_beacon_params;
+    settings_put_bool("smart_beacon", config.smart_beacon);
+    settings_put_int("sb_slow_kmh", sb.slow_speed_kmh);
+    settings_put_int("sb_slow_s", sb.slow_rate_s);
+    settings_put_int("sb_fast_kmh", sb.fast_speed_kmh);
+    settings_put_int("sb_fast_s", sb.fast_rate_s);
+    settings_put_int("sb_turn_s", sb.min_turn_time_s);
+    settings_put_int("sb_turn_deg", sb.min_turn_angle);
+    settings_put_int("sb_turn_slope", sb.turn_slope);
+    
     // Mark configuration as complete
     settings_put_bool("config_done", true);
 }
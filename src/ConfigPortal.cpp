@@ -16,6 +16,7 @@ static WiFiManagerParameter* paramFrequency = nullptr;
 static WiFiManagerParameter* paramPreamble = nullptr;
 static WiFiManagerParameter* paramTail = nullptr;
 static WiFiManagerParameter* paramUpdateInterval = nullptr;
+static WiFiManagerParameter* paramSmartBeacon = nullptr;
 
 // Buffer storage for form field initial values
 static char callsignBuf[10];
@@ -30,6 +31,7 @@ static char frequencyBuf[16];
 static char preambleBuf[8];
 static char tailBuf[8];
 static char updateIntervalBuf[8];
+static char smartBeaconBuf[4];
 
 /**
  * Save callback - called by WiFiManager when user submits form
@@ -63,8 +65,9 @@ static void saveConfigCallback()
         Serial.println(" (empty)");
     }
     
-    // Parse and save APRS configuration
-    APRSConfig config;
+    // Parse and save APRS configuration (start from the stored one so
+    // settings without a form field survive)
+    APRSConfig config = loadAPRSConfig();
     
     // Callsign - convert to uppercase and validate
     strncpy(config.callsign, callsign_input, sizeof(config.callsign) - 1);
@@ -127,9 +130,9 @@ static void saveConfigCallback()
     if (config.tail_ms < 10) config.tail_ms = 10;
     if (config.tail_ms > 500) config.tail_ms = 500;
     
-    config.update_interval_min = atoi(paramUpdateInterval->getValue());
-    if (config.update_interval_min < 1) config.update_interval_min = 1;
-    if (config.update_interval_min > 60) config.update_interval_min = 60;
+    config.update_interval_min = clampUpdateInterval(atoi(paramUpdateInterval->getValue()));
+    
+    config.smart_beacon = atoi(paramSmartBeacon->getValue()) != 0;
     
     // Save to persistent storage
     saveAPRSConfig(config);
@@ -141,6 +144,7 @@ static void saveConfigCallback()
     Serial.printf("  Frequency: %.4f MHz\n", config.frequency);
     Serial.printf("  Timing: preamble=%dms tail=%dms\n", config.preamble_ms, config.tail_ms);
     Serial.printf("  Update interval: %d minutes\n", config.update_interval_min);
+    Serial.printf("  SmartBeaconing: %s\n", config.smart_beacon ? "on" : "off");
 }
 
 /**
@@ -168,6 +172,7 @@ bool startConfigPortal(int timeoutSeconds)
     snprintf(preambleBuf, sizeof(preambleBuf), "%d", config.preamble_ms);
     snprintf(tailBuf, sizeof(tailBuf), "%d", config.tail_ms);
     snprintf(updateIntervalBuf, sizeof(updateIntervalBuf), "%d", config.update_interval_min);
+    snprintf(smartBeaconBuf, sizeof(smartBeaconBuf), "%d", config.smart_beacon ? 1 : 0);
     
     // Create WiFiManager instance
     WiFiManager wm;
@@ -187,6 +192,7 @@ bool startConfigPortal(int timeoutSeconds)
     delete paramPreamble;
     delete paramTail;
     delete paramUpdateInterval;
+    delete paramSmartBeacon;
     
     // Add custom parameters with helpful placeholders and patterns
     WiFiManagerParameter customHeading("<h2>APRS Configuration</h2>");
@@ -225,6 +231,8 @@ bool startConfigPortal(int timeoutSeconds)
                                    "type='number' min='10' max='500'");
     paramUpdateInterval = new WiFiManagerParameter("update_interval", "Update Interval (minutes, 1-60)", updateIntervalBuf, 8,
                                              "type='number' min='1' max='60'");
+    paramSmartBeacon = new WiFiManagerParameter("smart_beacon", "SmartBeaconing (1=on, 0=fixed interval)", smartBeaconBuf, 4,
+                                          "type='number' min='0' max='1'");
     
     // Add all parameters
     wm.addParameter(paramCallsign);
@@ -239,6 +247,7 @@ bool startConfigPortal(int timeoutSeconds)
     wm.addParameter(paramPreamble);
     wm.addParameter(paramTail);
     wm.addParameter(paramUpdateInterval);
+    wm.addParameter(paramSmartBeacon);
     
     // Generate portal SSID
     String portalSSID;
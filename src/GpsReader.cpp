@@ -0,0 +1,204 @@
+#include "GpsReader.h"
+
+GpsReader::GpsReader()
+    : _port(UART_NUM_MAX),
+      _events(nullptr),
+      _task(nullptr) {
+    portMUX_INITIALIZE(&_mux);
+}
+
+bool GpsReader::begin(uart_port_t port, int rx_pin, int tx_pin, uint32_t baud, const GpsFix& fallback) {
+    if (_task) {
+        return false;
+    }
+    _port = port;
+    _fix = fallback;
+    _fix.valid = false;
+
+    uart_config_t config = {};
+    config.baud_rate = (int)baud;
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    config.source_clk = UART_SCLK_APB;
+
+    if (uart_driver_install(_port, GPS_RX_BUFFER, 0, GPS_EVENT_QUEUE, &_events, 0) != ESP_OK) {
+        return false;
+    }
+    if (uart_param_config(_port, &config) != ESP_OK ||
+        uart_set_pin(_port, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        uart_driver_delete(_port);
+        return false;
+    }
+
+    // An event per '\n'; the driver queues each newline's position
+    uart_enable_pattern_det_baud_intr(_port, '\n', 1, 9, 0, 0);
+    uart_pattern_queue_reset(_port, GPS_EVENT_QUEUE);
+    uart_flush_input(_port);
+
+    if (xTaskCreatePinnedToCore(taskEntry, "gps", GPS_TASK_STACK, this, GPS_TASK_PRIORITY, &_task,
+                                GPS_TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        uart_driver_delete(_port);
+        return false;
+    }
+    return true;
+}
+
+GpsFix GpsReader::fix() const {
+    portENTER_CRITICAL(&_mux);
+    GpsFix result = _fix;
+    portEXIT_CRITICAL(&_mux);
+    return result;
+}
+
+GpsStats GpsReader::stats() const {
+    portENTER_CRITICAL(&_mux);
+    GpsStats result = _stats;
+    portEXIT_CRITICAL(&_mux);
+    return result;
+}
+
+// ============================================================================
+// Task
+// ============================================================================
+
+void GpsReader::taskEntry(void* arg) {
+    GpsReader* reader = static_cast<GpsReader*>(arg);
+    uart_event_t event;
+    for (;;) {
+        if (xQueueReceive(reader->_events, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        switch (event.type) {
+        case UART_PATTERN_DET:
+            reader->readLines();
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            // Bytes are gone mid-sentence: drop what is buffered and resync
+            // on the next newline (the partial sentence would fail its
+            // checksum anyway)
+            portENTER_CRITICAL(&reader->_mux);
+            if (event.type == UART_FIFO_OVF) {
+                reader->_stats.fifo_overflows++;
+            } else {
+                reader->_stats.buffer_full++;
+            }
+            portEXIT_CRITICAL(&reader->_mux);
+            uart_flush_input(reader->_port);
+            xQueueReset(reader->_events);
+            break;
+        default:
+            break;              // UART_DATA: wait for the newline
+        }
+    }
+}
+
+/**
+ * Read every complete line the driver has queued a newline for
+ */
+void GpsReader::readLines() {
+    size_t buffered = 0;
+    uart_get_buffered_data_len(_port, &buffered);
+
+    int pos = uart_pattern_pop_pos(_port);
+    if (pos < 0) {
+        // The event came but its position did not fit the pattern queue
+        portENTER_CRITICAL(&_mux);
+        _stats.pattern_overflows++;
+        portEXIT_CRITICAL(&_mux);
+        uart_flush_input(_port);
+        return;
+    }
+
+    for (; pos >= 0; pos = uart_pattern_pop_pos(_port)) {
+        // pos counts from the read pointer, newline included at pos
+        size_t len = (size_t)pos + 1;
+        bool fits = len <= sizeof(_line);
+        size_t got = 0;
+        while (got < len) {
+            // A line too long to keep is read in pieces over _line and dropped
+            size_t chunk = len - got;
+            if (chunk > sizeof(_line)) {
+                chunk = sizeof(_line);
+            }
+            uint8_t* dest = (uint8_t*)_line + (fits ? got : 0);
+            int n = uart_read_bytes(_port, dest, chunk, pdMS_TO_TICKS(20));
+            if (n <= 0) {
+                break;
+            }
+            got += (size_t)n;
+        }
+
+        portENTER_CRITICAL(&_mux);
+        _stats.lines++;
+        if (!fits) {
+            _stats.long_lines++;
+        }
+        if (buffered > _stats.buffered_peak) {
+            _stats.buffered_peak = buffered;
+        }
+        portEXIT_CRITICAL(&_mux);
+
+        if (fits && got == len) {
+            parseLine(_line, len);
+        }
+    }
+}
+
+void GpsReader::parseLine(const char* line, size_t len) {
+    uint32_t failed = _gps.failedChecksum();
+    uint32_t passed = _gps.passedChecksum();
+    bool complete = false;
+    for (size_t i = 0; i < len; i++) {
+        if (_gps.encode(line[i])) {
+            complete = true;
+        }
+    }
+
+    portENTER_CRITICAL(&_mux);
+    _stats.sentences += _gps.passedChecksum() - passed;
+    _stats.checksum_errors += _gps.failedChecksum() - failed;
+    portEXIT_CRITICAL(&_mux);
+
+    // RMC and GGA with a fix carry a position; the others only add to the
+    // next fix. Sentences without a fix end a valid one once it is stale.
+    // (_fix is only written on this task.)
+    bool stale = _fix.valid && _gps.location.age() >= GPS_FIX_MAX_AGE_MS;
+    if (complete && (_gps.location.isUpdated() || stale)) {
+        publish();
+    }
+}
+
+/**
+ * Copy what TinyGPSPlus holds into a new fix. Course and speed come from
+ * RMC and altitude from GGA, so the fix takes each only while it is
+ * recent; a fix never mixes in values from an old epoch. Without a valid
+ * position the last one is kept, marked invalid.
+ */
+void GpsReader::publish() {
+    GpsFix next = fix();
+    next.valid = _gps.location.isValid() && _gps.location.age() < GPS_FIX_MAX_AGE_MS;
+    if (next.valid) {
+        next.lat = (float)_gps.location.lat();
+        next.lon = (float)_gps.location.lng();
+    }
+    next.has_alt = _gps.altitude.isValid() && _gps.altitude.age() < GPS_FIX_MAX_AGE_MS;
+    if (next.has_alt) {
+        next.alt = (float)_gps.altitude.meters();
+    }
+    bool moving = _gps.course.isValid() && _gps.speed.isValid() &&
+                  _gps.course.age() < GPS_FIX_MAX_AGE_MS && _gps.speed.age() < GPS_FIX_MAX_AGE_MS;
+    next.course = moving ? (int16_t)_gps.course.deg() : -1;
+    next.speed = moving ? (float)_gps.speed.knots() : -1.0f;
+    next.satellites = _gps.satellites.isValid() ? (uint8_t)_gps.satellites.value() : 0;
+    next.time_ms = millis();
+    next.sequence++;
+
+    portENTER_CRITICAL(&_mux);
+    _fix = next;
+    portEXIT_CRITICAL(&_mux);
+}
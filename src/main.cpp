@@ -1,5 +1,7 @@
 #include "APRSConfig.h"
 #include "ConfigPortal.h"
+#include "GpsReader.h"
+#include "KissSerialTransport.h"
 #include "RadioManager.h"
 #include "Settings.h"
 #include "hardware_config.h"
@@ -7,7 +9,6 @@
 #include <Adafruit_BME280.h>
 #include <Adafruit_Sensor.h>
 #include <Arduino.h>
-#include <TinyGPSPlus.h>
 #include <WiFi.h>
 #include <Wire.h>
 
@@ -19,19 +20,20 @@
 // Global Objects
 // ============================================================================
 APRS::APRSClient aprs;
+APRS::Receiver receiver;
+APRS::SmartBeacon smartBeacon;
+KissSerialTransport kissTransport(Serial);
 RadioManager radio;
-TinyGPSPlus gps;
+GpsReader gpsReader;
 Adafruit_BME280 bme;
 
 // ============================================================================
 // State Variables
 // ============================================================================
-unsigned long lastTransmission = 0;
-unsigned int transmissionCount = 0;
-bool gpsValid = false;
-float lastLat = 0.0;
-float lastLon = 0.0;
-float lastAlt = 0.0;
+// Beacon jobs (see setupScheduler())
+APRS::Scheduler scheduler;
+unsigned long lastPosition = 0;
+bool positionSent = false;
 
 // Global APRS config - must persist so pointers remain valid
 APRSConfig g_aprsConfig;
@@ -47,19 +49,22 @@ void setupSerial() {
    Serial.println("\n\n=================================");
    Serial.println("ESP32 APRS Tracker");
    Serial.println("=================================");
-   Serial.printf("[BOARD] UARTs: Console=UART0(USB), GPS=UART2(%d/%d@%d), Radio=UART1(%d/%d@%d)\n", GPS_RX, GPS_TX,
+   Serial.printf("[BOARD] UARTs: Console=UART0(USB), GPS=UART1(%d/%d@%d), Radio=UART2(%d/%d@%d)\n", GPS_RX, GPS_TX,
                  GPS_BAUDRATE, RADIO_RX, RADIO_TX, RADIO_BAUDRATE);
 
-   // === Serial 2: GPS Module ===
-   Serial.println("Initializing GPS (Serial1)...");
-   Serial1.begin(GPS_BAUDRATE, SERIAL_8N1, GPS_RX, GPS_TX);
-   while (!Serial1) { /* wait */
+   // === UART1: GPS Module (own task, see GpsReader) ===
+   Serial.println("Initializing GPS (UART1)...");
+   GpsFix home; // Position sent until the GPS locks
+   home.lat = 49.102421f;
+   home.lon = -122.653579f;
+   home.alt = 100.0f;
+   if (gpsReader.begin((uart_port_t)GPS_UART_NUM, GPS_RX, GPS_TX, GPS_BAUDRATE, home)) {
+      Serial.printf("✓ GPS reader: %d byte ring buffer, woken per NMEA line\n", GPS_RX_BUFFER);
+   } else {
+      Serial.println("✗ GPS reader initialization FAILED!");
    }
-   Serial1.flush();
-   delay(500);
-   Serial.println("✓ GPS Serial initialized");
 
-   // === Serial 1: Radio Module (DRA818) ===
+   // === Serial2 (UART2): Radio Module (DRA818) ===
    Serial.println("Initializing Radio (Serial2)...");
    Serial2.begin(RADIO_BAUDRATE, SERIAL_8N1, RADIO_RX, RADIO_TX);
    while (!Serial2) { /* wait */
@@ -126,6 +131,33 @@ void setupRadio() {
    }
 }
 
+void onTxComplete(APRS::TxHandle handle, APRS::TxState state, void* user) {
+   (void)user;
+   const char* result = (state == APRS::TxState::Sent)         ? "sent"
+                        : (state == APRS::TxState::Superseded) ? "superseded by newer data"
+                        : (state == APRS::TxState::Dropped)    ? "dropped (duty cycle)"
+                                                               : "FAILED";
+   Serial.printf("[TX] Packet #%u %s\n", (unsigned)handle, result);
+}
+
+void onFrameReceived(const uint8_t* frame, size_t len, void* user) {
+   (void)user;
+   if (aprs.kissStarted()) {
+      aprs.kissForward(frame, len);
+   }
+
+   APRS::AX25FrameView view;
+   char line[400]; // 10 addresses + 256 byte info field
+   if (view.parse(frame, len) && view.format(line, sizeof(line)) > 0) {
+      Serial.printf("[RX] %s\n", line);
+   }
+}
+
+bool carrierBusy(void* user) {
+   (void)user;
+   return receiver.isCarrierDetected();
+}
+
 void setupAPRS() {
    Serial.println("\nInitializing APRS...");
 
@@ -142,65 +174,94 @@ void setupAPRS() {
    aprsConfig.preamble_ms = g_aprsConfig.preamble_ms;
    aprsConfig.tail_ms = g_aprsConfig.tail_ms;
    aprsConfig.ptt_pin = RADIO_PTT;
-
-   if (aprs.begin(aprsConfig)) {
+   aprsConfig.ptt_active_high = !PTT_ACTIVE_LOW;
+   aprsConfig.ptt_lead_ms = APRS_PTT_PRE_MS;
+   aprsConfig.ptt_tail_ms = APRS_PTT_TAIL_MS;
+   aprsConfig.modem = &APRS::APRS_TX_MODEM::PROFILE;
+   aprsConfig.fx25 = APRS::FX25Mode::APRS_TX_FX25;
+   aprsConfig.framing = APRS::Framing::APRS_TX_FRAMING;
+   aprsConfig.position_format = APRS::PositionFormat::APRS_POSITION_FORMAT;
+   aprsConfig.mic_e_message = APRS::MicEMessage::APRS_MIC_E_MESSAGE;
+#if RADIO_AUDIO_SIGMA_DELTA
+   static APRS::SigmaDeltaSink audioSink(RADIO_AUDIO_OUT);
+   aprsConfig.sink = &audioSink;
+#endif
+
+   // Background TX task: queued packets no longer block loop()
+   APRS::TxEngineConfig txConfig;
+   txConfig.core = 0;     // Arduino loop() runs on core 1
+   txConfig.gap_ms = 1000; // Channel gap between consecutive key-ups
+   txConfig.max_duty_percent = APRS_TX_MAX_DUTY_PERCENT;
+   txConfig.duty_window_ms = APRS_TX_DUTY_WINDOW_S * 1000UL;
+
+   if (aprs.begin(aprsConfig) && aprs.startTxEngine(txConfig)) {
+      aprs.onTxComplete(onTxComplete);
       Serial.println("✓ APRS initialized");
       Serial.printf("  Callsign: %s-%d\n", aprsConfig.callsign, aprsConfig.ssid);
       Serial.printf("  Path: %s-%d,%s-%d\n", aprsConfig.path1, aprsConfig.path1_ssid, aprsConfig.path2,
                     aprsConfig.path2_ssid);
       Serial.printf("  Symbol: %c (table %c)\n", aprsConfig.symbol, aprsConfig.symbol_table);
+      Serial.printf("  Modem: %u bd, %u Hz\n", aprs.modem().baud, (unsigned)aprs.modem().sample_rate);
+      if (g_aprsConfig.smart_beacon) {
+         const APRS::SmartBeaconConfig& sb = g_aprsConfig.smart_beacon_params;
+         smartBeacon.begin(sb);
+         Serial.printf("  SmartBeaconing: %u km/h / %u s .. %u km/h / %u s, turn %u deg + %u/v\n",
+                       sb.slow_speed_kmh, sb.slow_rate_s, sb.fast_speed_kmh, sb.fast_rate_s, sb.min_turn_angle,
+                       sb.turn_slope);
+      }
    } else {
       Serial.println("✗ APRS initialization FAILED!");
+      return;
    }
-}
 
-// ============================================================================
-// GPS Processing
-// ============================================================================
+   // Receive path: capture pauses while the TX task has the radio keyed
+   APRS::ReceiverConfig rxConfig;
+   rxConfig.pin = RADIO_AUDIO_IN;
+   rxConfig.core = 1; // Alongside loop() and GPS parsing
+   if (receiver.begin(rxConfig, onFrameReceived)) {
+      Serial.printf("✓ APRS receiver on GPIO%d @ %d Hz\n", RADIO_AUDIO_IN, RX_SAMPLERATE);
+      aprs.setCarrierSense(carrierBusy);
+   } else {
+      Serial.println("✗ APRS receiver initialization FAILED!");
+   }
 
-void updateGPS() {
-   while (Serial1.available() > 0) {
-      char c = Serial1.read();
-      if (gps.encode(c)) {
-         if (gps.location.isValid()) {
-            gpsValid = true;
-            lastLat = gps.location.lat();
-            lastLon = gps.location.lng();
-
-            if (gps.altitude.isValid()) {
-               lastAlt = gps.altitude.meters();
-            }
-
-            // Print GPS info occasionally
-            static unsigned long lastPrint = 0;
-            if (millis() - lastPrint > 10000) { // Every 10 seconds
-               lastPrint = millis();
-               Serial.printf("\n[GPS] Lat: %.6f, Lon: %.6f, Alt: %.1fm, Sats: %d\n", lastLat, lastLon, lastAlt,
-                             gps.satellites.value());
-            }
-         } else {
-            gpsValid = false;
-         }
-      }
+#if KISS_ON_CONSOLE
+   // Host frames join the tracker's own packets in the TX queue
+   if (aprs.startKiss(&kissTransport)) {
+      Serial.println("✓ KISS TNC on console");
+   } else {
+      Serial.println("✗ KISS TNC initialization FAILED!");
    }
+#endif
 }
 
 // ============================================================================
 // APRS Transmission
 // ============================================================================
 
-void sendAPRSPosition() {
+void sendAPRSPosition(const GpsFix& fix) {
    Serial.println("\n--- Sending APRS Position ---");
 
    String comment = "ESP32-Tracker";
-   if (!gpsValid) {
+   if (!fix.valid) {
       comment += " GPS-INVALID";
    }
 
-   if (aprs.sendPosition(lastLat, lastLon, comment.c_str(), 1, 1, 1, 0)) {
-      Serial.println("✓ Position sent successfully");
+   APRS::PositionReport report;
+   report.lat = fix.lat;
+   report.lon = fix.lon;
+   if (fix.valid) {
+      report.course = fix.course;
+      report.speed_knots = fix.speed;
+      report.has_altitude = fix.has_alt;
+      report.altitude_m = fix.alt;
+   }
+
+   APRS::TxHandle handle = aprs.queuePosition(report, comment.c_str());
+   if (handle) {
+      Serial.printf("✓ Position queued (#%u)\n", (unsigned)handle);
    } else {
-      Serial.println("✗ Position transmission failed");
+      Serial.println("✗ Position could not be queued");
    }
 }
 
@@ -213,7 +274,7 @@ void sendAPRSTelemetry() {
    telem.analog[1] = bme.readTemperature();
    telem.analog[2] = bme.readPressure() / 100.0; // Convert Pa to mbar
    telem.analog[3] = bme.readHumidity();
-   telem.analog[4] = lastAlt;
+   telem.analog[4] = gpsReader.fix().alt;
    telem.digital = 0; // No digital channels used
 
    Serial.printf("  Battery: %.2fV\n", telem.analog[0]);
@@ -222,47 +283,170 @@ void sendAPRSTelemetry() {
    Serial.printf("  Humidity: %.1f%%\n", telem.analog[3]);
    Serial.printf("  Altitude: %.1fm\n", telem.analog[4]);
 
-   if (aprs.sendTelemetry(telem)) {
-      Serial.println("✓ Telemetry sent successfully");
+   APRS::TxHandle handle = aprs.queueTelemetry(telem);
+   if (handle) {
+      Serial.printf("✓ Telemetry queued (#%u)\n", (unsigned)handle);
    } else {
-      Serial.println("✗ Telemetry transmission failed");
+      Serial.println("✗ Telemetry could not be queued");
    }
 }
 
-void transmitAPRS() {
-   unsigned long now = millis();
+// ============================================================================
+// Beacon Scheduling
+//
+// Jobs run on the scheduler task, woken by its timer at each release;
+// releases stay on a fixed grid, so intervals do not drift with TX time.
+// Jobs released together are queued as one burst (one key-up).
+// ============================================================================
+
+void beginBatch(void* arg) {
+   (void)arg;
+   aprs.beginBurst();
+}
 
-   // Use global config for update interval
-   unsigned long tx_interval_ms = g_aprsConfig.update_interval_min * 60 * 1000; // Convert minutes to ms
+void endBatch(void* arg) {
+   (void)arg;
+   aprs.endBurst();
+}
 
-   // Check if it's time to transmit
-   if (now - lastTransmission < tx_interval_ms && lastTransmission != 0) {
-      return; // Not time yet
+/**
+ * With SmartBeaconing and a fix: runs at the GPS rate and sends when
+ * SmartBeacon says so. Otherwise: runs on the update interval and sends.
+ */
+void positionJob(void* arg) {
+   (void)arg;
+   GpsFix fix = gpsReader.fix(); // Latest complete fix, parsed on the GPS task
+   unsigned long now = millis();
+   unsigned long interval_ms = g_aprsConfig.update_interval_min * 60000UL;
+
+   if (g_aprsConfig.smart_beacon) {
+      if (fix.valid) {
+         float speed_kmh = (fix.speed < 0) ? -1.0f : fix.speed * 1.852f; // SmartBeacon works in km/h
+         APRS::BeaconReason reason = smartBeacon.update(now, speed_kmh, fix.course);
+         if (reason == APRS::BeaconReason::None) {
+            return;
+         }
+         if (reason == APRS::BeaconReason::Turn) {
+            Serial.printf("\n[BEACON] Turn at %.0f km/h\n", speed_kmh);
+         }
+      } else if (positionSent && now - lastPosition < interval_ms) {
+         return; // No fix: fixed interval
+      }
    }
 
-   Serial.println("\n=====================================");
-   Serial.printf("Transmission #%d\n", transmissionCount + 1);
-   Serial.println("=====================================");
+   if (fix.valid) {
+      Serial.printf("\n[BEACON] Fix #%u, %u ms old\n", (unsigned)fix.sequence, (unsigned)(now - fix.time_ms));
+   }
+   sendAPRSPosition(fix);
+   lastPosition = now;
+   positionSent = true;
+}
 
-   // Send position
-   sendAPRSPosition();
-   delay(2000); // Wait between packets
+void telemetryJob(void* arg) {
+   (void)arg;
+   sendAPRSTelemetry();
+}
 
-   // Send telemetry definitions
+void definitionsJob(void* arg) {
+   (void)arg;
    Serial.println("\n--- Sending Telemetry Definitions ---");
-   if (aprs.sendTelemetryDefinitions()) {
-      Serial.println("✓ Telemetry definitions sent");
+   if (aprs.queueTelemetryDefinitions()) {
+      Serial.println("✓ Telemetry definitions queued");
    }
-   delay(1000);
+}
 
-   // Send telemetry data
-   sendAPRSTelemetry();
+void statusJob(void* arg) {
+   (void)arg;
+   static const char status[] = ">" APRS_STATUS_TEXT;
+   if (aprs.queueRawPacket((const uint8_t*)status, sizeof(status) - 1)) {
+      Serial.println("\n✓ Status queued");
+   }
+}
 
-   lastTransmission = now;
-   transmissionCount++;
+void reportJob(void* arg) {
+   (void)arg;
+   APRS::TxEngineStats txStats = aprs.txEngineStats();
+   Serial.printf("\nTX totals: %u key-ups, %u frames, %u ms on air, %u ms saved by bursts\n",
+                 (unsigned)txStats.keyups, (unsigned)txStats.frames, (unsigned)txStats.airtime_ms,
+                 (unsigned)txStats.saved_ms);
+   APRS::DutyCycleStatus duty = aprs.dutyCycle();
+   Serial.printf("Duty cycle: %u.%u%% of the last %u min (limit %u%%), %u key-ups, %u frames dropped\n",
+                 duty.duty_permille / 10, duty.duty_permille % 10, (unsigned)(duty.window_ms / 60000),
+                 duty.limit_permille / 10, (unsigned)duty.window.keyups, (unsigned)txStats.dropped);
+
+   GpsFix fix = gpsReader.fix();
+   GpsStats gpsStats = gpsReader.stats();
+   Serial.printf("GPS: %s %.6f %.6f, %u sats, fix #%u %u ms old\n", fix.valid ? "fix" : "no fix", fix.lat, fix.lon,
+                 fix.satellites, (unsigned)fix.sequence, (unsigned)(millis() - fix.time_ms));
+   Serial.printf("NMEA: %u lines, %u bad checksums, %u too long; overflows: FIFO %u, buffer %u, pattern %u; "
+                 "peak %u/%d bytes\n",
+                 (unsigned)gpsStats.lines, (unsigned)gpsStats.checksum_errors, (unsigned)gpsStats.long_lines,
+                 (unsigned)gpsStats.fifo_overflows, (unsigned)gpsStats.buffer_full,
+                 (unsigned)gpsStats.pattern_overflows, (unsigned)gpsStats.buffered_peak, GPS_RX_BUFFER);
+
+   Serial.println("Jobs: runs, missed, late mean/max ms, run max ms");
+   for (size_t i = 0; i < scheduler.jobs(); i++) {
+      APRS::JobStats stats = scheduler.stats((APRS::JobId)i);
+      Serial.printf("  %-12s %5u %3u %7.1f %7.1f %7.1f\n", scheduler.name((APRS::JobId)i), (unsigned)stats.runs,
+                    (unsigned)stats.missed, stats.lateMeanUs() / 1000.0, stats.late_max_us / 1000.0,
+                    stats.run_max_us / 1000.0);
+   }
+}
 
-   Serial.printf("\nNext transmission in %d minutes\n", g_aprsConfig.update_interval_min);
-   Serial.println("=====================================\n");
+void setupScheduler() {
+   APRS::SchedulerConfig schedConfig;
+   schedConfig.core = 1;          // With the GPS task, which preempts it per NMEA line
+   schedConfig.priority = 2;      // Above loop(), below the GPS task
+   schedConfig.stack_bytes = 6144; // Jobs format reports and read the BME280
+   if (!scheduler.begin(schedConfig)) {
+      Serial.println("✗ Scheduler initialization FAILED!");
+      return;
+   }
+   scheduler.onBatch(beginBatch, endBatch, nullptr);
+
+   uint32_t interval_ms = g_aprsConfig.update_interval_min * 60000UL;
+
+   APRS::JobConfig job;
+   job.name = "position";
+   job.function = positionJob;
+   job.period_ms = g_aprsConfig.smart_beacon ? GPS_UPDATE_INTERVAL_MS : interval_ms;
+   job.priority = 3;
+   scheduler.add(job);
+
+   job = APRS::JobConfig();
+   job.name = "telemetry";
+   job.function = telemetryJob;
+   job.period_ms = interval_ms;
+   job.priority = 2;
+   scheduler.add(job);
+
+   job = APRS::JobConfig();
+   job.name = "definitions";
+   job.function = definitionsJob;
+   job.period_ms = interval_ms * APRS_DEFINITIONS_EVERY_N;
+   job.deadline_ms = interval_ms; // Stale by the next telemetry: skip
+   job.priority = 1;
+   scheduler.add(job);
+
+   job = APRS::JobConfig();
+   job.name = "status";
+   job.function = statusJob;
+   job.delay_ms = APRS_STATUS_DELAY_S * 1000UL;
+   job.jitter_ms = APRS_STATUS_JITTER_S * 1000UL;
+   job.priority = 1;
+   scheduler.add(job);
+
+   job = APRS::JobConfig();
+   job.name = "report";
+   job.function = reportJob;
+   job.period_ms = APRS_REPORT_INTERVAL_S * 1000UL;
+   job.delay_ms = job.period_ms;
+   scheduler.add(job);
+
+   Serial.printf("✓ Scheduler: %u jobs, positions every %u s%s, telemetry every %u min\n",
+                 (unsigned)scheduler.jobs(), (unsigned)(interval_ms / 1000),
+                 g_aprsConfig.smart_beacon ? " (SmartBeaconing with a fix)" : "",
+                 (unsigned)g_aprsConfig.update_interval_min);
 }
 
 // ============================================================================
@@ -275,6 +459,9 @@ void setup() {
    esp_bt_controller_disable();
 
    // Initialize serial first for logging
+#if KISS_ON_CONSOLE
+   Serial.setRxBufferSize(KISS_RX_BUFFER); // Host frames queue here while the TX queue is full
+#endif
    Serial.begin(CONSOLE_BAUDRATE);
    delay(500);
 
@@ -344,23 +531,13 @@ void setup() {
    setupSensors();
    setupRadio();
    setupAPRS();
+   setupScheduler();
 
    Serial.println("\n✓ All systems initialized!");
    Serial.println("Waiting for GPS lock...\n");
-
-   // Set default position (will be overwritten when GPS locks)
-   lastLat = 49.102421;
-   lastLon = -122.653579;
-   lastAlt = 100.0;
 }
 
 void loop() {
-   // Update GPS data
-   updateGPS();
-
-   // Transmit when ready
-   transmitAPRS();
-
-   // Small delay to prevent watchdog issues
-   delay(100);
+   // Nothing to poll: GPS, beacons, TX and RX each run on their own task
+   delay(1000);
 }
@@ -0,0 +1,248 @@
+/**
+ * SmartBeaconing command for the native host driver
+ *
+ * smartbeacon  Replay a synthetic drive (parked, town with corners and a
+ *              traffic light, highway, cloverleaf exit, country bends,
+ *              parked) at one fix per second through SmartBeacon and
+ *              through fixed-interval beaconing. Reports beacons per leg,
+ *              airtime, and track fidelity: how far each true fix lies
+ *              from the line a map draws between the beacons around it,
+ *              while moving and while parked.
+ */
+#include "commands.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+struct Leg {
+   const char* name;
+   uint32_t seconds;
+   float speed_kmh;
+   float turn_deg;        // Heading change spread evenly over the leg
+};
+
+const Leg ROUTE[] = {
+   { "parked", 900, 0, 0 },
+   { "town", 60, 40, 0 },
+   { "right turn", 6, 20, 90 },
+   { "town", 90, 40, 0 },
+   { "red light", 40, 0, 0 },
+   { "town", 60, 40, 0 },
+   { "left turn", 6, 20, -90 },
+   { "town", 45, 40, 0 },
+   { "on-ramp", 30, 50, 120 },
+   { "highway", 300, 100, 0 },
+   { "long curve", 120, 100, 30 },
+   { "highway", 300, 100, 0 },
+   { "cloverleaf", 40, 40, 270 },
+   { "country", 120, 80, 0 },
+   { "bends", 10, 60, 45 },
+   { "bends", 10, 60, -45 },
+   { "country", 180, 80, 0 },
+   { "town", 40, 30, 0 },
+   { "right turn", 5, 20, 90 },
+   { "town", 40, 30, 0 },
+   { "right turn", 5, 20, 90 },
+   { "town", 40, 30, 0 },
+   { "parked", 900, 0, 0 },
+};
+const size_t LEGS = sizeof(ROUTE) / sizeof(ROUTE[0]);
+
+struct Fix {
+   uint32_t ms;
+   double x;              // Meters east
+   double y;              // Meters north
+   float speed_kmh;
+   int16_t course;        // As the GPS reports it (noisy), -1 when parked
+   size_t leg;
+};
+
+/**
+ * One fix per second along ROUTE; the reported course carries +-2 degrees
+ * of noise, as a GPS would
+ */
+std::vector<Fix> drive(unsigned seed) {
+   std::vector<Fix> track;
+   double x = 0.0;
+   double y = 0.0;
+   double heading = 0.0;
+   uint32_t ms = 0;
+   for (size_t l = 0; l < LEGS; l++) {
+      const Leg& leg = ROUTE[l];
+      for (uint32_t s = 0; s < leg.seconds; s++) {
+         heading = fmod(heading + leg.turn_deg / leg.seconds + 360.0, 360.0);
+         double step = leg.speed_kmh / 3.6;
+         x += step * sin(heading * PI / 180.0);
+         y += step * cos(heading * PI / 180.0);
+         ms += 1000;
+
+         Fix fix;
+         fix.ms = ms;
+         fix.x = x;
+         fix.y = y;
+         fix.speed_kmh = leg.speed_kmh;
+         int noise = (int)(rand_r(&seed) % 5) - 2;
+         fix.course = (leg.speed_kmh > 0) ? (int16_t)(((int)lround(heading) + noise + 360) % 360) : -1;
+         fix.leg = l;
+         track.push_back(fix);
+      }
+   }
+   return track;
+}
+
+double segmentDistance(const Fix& p, const Fix& a, const Fix& b) {
+   double dx = b.x - a.x;
+   double dy = b.y - a.y;
+   double len2 = dx * dx + dy * dy;
+   double t = (len2 > 0.0) ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0.0;
+   t = (t < 0.0) ? 0.0 : (t > 1.0) ? 1.0 : t;
+   double ex = a.x + t * dx - p.x;
+   double ey = a.y + t * dy - p.y;
+   return sqrt(ex * ex + ey * ey);
+}
+
+struct Result {
+   std::vector<size_t> beacons;   // Indices into the track
+   uint32_t turns;
+   double max_m;                  // Moving fixes
+   double mean_m;
+   double parked_m;               // Largest while parked
+};
+
+/**
+ * Deviation of every fix from the drawn segment between the beacons
+ * before and after it (the last beacon itself once none follows)
+ */
+void fidelity(const std::vector<Fix>& track, Result& result) {
+   result.max_m = 0.0;
+   result.mean_m = 0.0;
+   result.parked_m = 0.0;
+   size_t moving = 0;
+   size_t next = 0;
+   for (size_t i = 0; i < track.size(); i++) {
+      while (next < result.beacons.size() && result.beacons[next] < i) {
+         next++;
+      }
+      const Fix& before = track[result.beacons[(next > 0) ? next - 1 : 0]];
+      const Fix& after = track[result.beacons[(next < result.beacons.size()) ? next : result.beacons.size() - 1]];
+      double d = segmentDistance(track[i], before, after);
+      if (track[i].speed_kmh > 0) {
+         result.max_m = fmax(result.max_m, d);
+         result.mean_m += d;
+         moving++;
+      } else {
+         result.parked_m = fmax(result.parked_m, d);
+      }
+   }
+   result.mean_m /= (moving > 0) ? moving : 1;
+}
+
+Result smart(const std::vector<Fix>& track, const APRS::SmartBeaconConfig& config) {
+   APRS::SmartBeacon beacon;
+   beacon.begin(config);
+   Result result;
+   for (size_t i = 0; i < track.size(); i++) {
+      if (beacon.update(track[i].ms, track[i].speed_kmh, track[i].course) != APRS::BeaconReason::None) {
+         result.beacons.push_back(i);
+      }
+   }
+   result.turns = beacon.stats().turn;
+   fidelity(track, result);
+   return result;
+}
+
+Result fixed(const std::vector<Fix>& track, uint32_t interval_s) {
+   Result result;
+   for (size_t i = 0; i < track.size(); i += interval_s) {
+      result.beacons.push_back(i);
+   }
+   result.turns = 0;
+   fidelity(track, result);
+   return result;
+}
+
+} // namespace
+
+int cmdSmartBeacon(int argc, char** argv) {
+   int fixed_s = (argc > 0) ? atoi(argv[0]) : 300;
+   if (fixed_s <= 0) {
+      fprintf(stderr, "interval must be positive\n");
+      return 2;
+   }
+
+   std::vector<Fix> track = drive(1);
+   APRS::SmartBeaconConfig config;
+   Result sb = smart(track, config);
+
+   // Fixed intervals: the configured one, the fast rate, and the one that
+   // spends as many beacons as SmartBeaconing did
+   uint32_t budget_s = (uint32_t)(track.size() / sb.beacons.size());
+   struct Row {
+      char name[24];
+      Result result;
+   } rows[4];
+   snprintf(rows[0].name, sizeof(rows[0].name), "smart");
+   rows[0].result = sb;
+   snprintf(rows[1].name, sizeof(rows[1].name), "fixed %d s", fixed_s);
+   rows[1].result = fixed(track, fixed_s);
+   snprintf(rows[2].name, sizeof(rows[2].name), "fixed %u s", (unsigned)config.fast_rate_s);
+   rows[2].result = fixed(track, config.fast_rate_s);
+   snprintf(rows[3].name, sizeof(rows[3].name), "fixed %u s (same n)", (unsigned)budget_s);
+   rows[3].result = fixed(track, budget_s);
+
+   // Airtime of one compressed report with course/speed/altitude
+   APRS::Config client_config = defaultConfig();
+   client_config.position_format = APRS::PositionFormat::Compressed;
+   APRS::APRSClient aprs;
+   APRS::PositionReport report;
+   report.lat = 49.102421f;
+   report.lon = -122.653579f;
+   report.course = 87;
+   report.speed_knots = 52.0f;
+   report.has_altitude = true;
+   report.altitude_m = 120.0f;
+   uint32_t airtime_ms = aprs.begin(client_config) ? aprs.positionAirtimeMs(report, "ESP32-Tracker") : 0;
+
+   // Beacons per leg
+   printf("%-12s %6s %9s %9s %9s\n", "leg", "time s", "smart", rows[1].name, rows[2].name);
+   for (size_t l = 0; l < LEGS; l++) {
+      uint32_t counts[3] = { 0, 0, 0 };
+      for (int r = 0; r < 3; r++) {
+         for (size_t b = 0; b < rows[r].result.beacons.size(); b++) {
+            counts[r] += track[rows[r].result.beacons[b]].leg == l;
+         }
+      }
+      printf("%-12s %6u %9u %9u %9u\n", ROUTE[l].name, (unsigned)ROUTE[l].seconds, (unsigned)counts[0],
+             (unsigned)counts[1], (unsigned)counts[2]);
+   }
+
+   printf("\n%-20s %7s %6s %10s %10s %10s %10s\n", "policy", "beacons", "turns", "max dev m", "mean dev m",
+          "parked m", "airtime s");
+   for (int r = 0; r < 4; r++) {
+      const Result& result = rows[r].result;
+      printf("%-20s %7zu %6u %10.0f %10.1f %10.0f %10.1f\n", rows[r].name, result.beacons.size(),
+             (unsigned)result.turns, result.max_m, result.mean_m, result.parked_m,
+             result.beacons.size() * airtime_ms / 1000.0);
+   }
+   printf("(deviation of moving fixes from the drawn track; parked: largest while stopped, until a beacon "
+          "reports the stop)\n");
+   printf("\n%zu fixes over %.0f min; smart: slow %u km/h / %u s, fast %u km/h / %u s, turn %u deg + %u/v "
+          "after %u s\n",
+          track.size(), track.size() / 60.0, (unsigned)config.slow_speed_kmh, (unsigned)config.slow_rate_s,
+          (unsigned)config.fast_speed_kmh, (unsigned)config.fast_rate_s, (unsigned)config.min_turn_angle,
+          (unsigned)config.turn_slope, (unsigned)config.min_turn_time_s);
+
+   // With the same number of beacons SmartBeaconing must draw the closer
+   // track, and it must not need the fast rate's beacon count
+   bool ok = airtime_ms > 0 && sb.turns > 0 && sb.max_m < rows[3].result.max_m &&
+             sb.mean_m < rows[3].result.mean_m && sb.beacons.size() < rows[2].result.beacons.size();
+   if (!ok) {
+      fprintf(stderr, "smartbeacon: no better than fixed-interval beaconing\n");
+   }
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * Render cache command for the native host driver
+ *
+ * cache    Send the same frames, alone and inside bursts, with the render
+ *          cache on and off under each framing. The captured audio must be
+ *          identical and the hit, miss and eviction counters as expected;
+ *          then time repeated key-ups of the tracker's position both ways.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+size_t buildFrame(const char* info, uint8_t* frame) {
+   APRS::AX25Call src = { "NOCALL", 9 };
+   APRS::AX25Call dst = { "APZMDR", 0 };
+   APRS::AX25Call path[2] = { { "WIDE1", 1 }, { "WIDE2", 2 } };
+   return APRS::Protocol::encodeFrame(src, dst, path, 2, (const uint8_t*)info, strlen(info), frame,
+                                      AX25_MAX_FRAME_LEN);
+}
+
+struct FramingCase {
+   const char* name;
+   APRS::Framing framing;
+   APRS::FX25Mode fx25;
+};
+
+const FramingCase FRAMINGS[] = {
+   { "ax25", APRS::Framing::Ax25, APRS::FX25Mode::Off },
+   { "ax25+fx25/16", APRS::Framing::Ax25, APRS::FX25Mode::Check16 },
+   { "ax25+fx25/64", APRS::Framing::Ax25, APRS::FX25Mode::Check64 },
+   { "il2p", APRS::Framing::Il2p, APRS::FX25Mode::Off },
+   { "il2p maxfec", APRS::Framing::Il2pMaxFec, APRS::FX25Mode::Off },
+};
+
+APRS::ProtocolConfig protocolConfig(const FramingCase& f, bool cache) {
+   APRS::ProtocolConfig config = {
+      .ptt_pin = 33,
+      .preamble_ms = 350,
+      .tail_ms = 50,
+      .modulator = APRS::ModulatorMode::Block,
+      .sink = nullptr,
+      .modem = nullptr,
+      .fx25 = f.fx25,
+      .framing = f.framing,
+      .render_cache = cache,
+      .ptt_lead_ms = PTT_LEAD_MS,
+      .ptt_tail_ms = PTT_TAIL_MS,
+      .ptt_active_high = false
+   };
+   return config;
+}
+
+/**
+ * Position three times, a burst of position, position, telemetry,
+ * position, the telemetry alone, then five new frames (one more than the
+ * cache holds) and the position again. Returns the captured samples.
+ */
+bool sendSequence(const FramingCase& f, bool cache, std::vector<uint16_t>& samples,
+                  APRS::RenderCacheStats& stats) {
+   uint8_t frames[7][AX25_MAX_FRAME_LEN];
+   size_t lens[7];
+   lens[0] = buildFrame("=4906.15N/12239.21WnPHG1110ESP32-Tracker", frames[0]);
+   lens[1] = buildFrame("T#000,3.700,21.500,1013.200,45.000,100.000,00000000", frames[1]);
+   for (int i = 2; i < 7; i++) {
+      char info[32];
+      snprintf(info, sizeof(info), ">status %d", i);
+      lens[i] = buildFrame(info, frames[i]);
+   }
+
+   APRS::HAL::Native::reset();
+   APRS::Protocol protocol;
+   if (!protocol.begin(protocolConfig(f, cache))) {
+      return false;
+   }
+   const uint8_t* burst[4] = { frames[0], frames[0], frames[1], frames[0] };
+   size_t burst_lens[4] = { lens[0], lens[0], lens[1], lens[0] };
+   bool ok = true;
+   for (int i = 0; i < 3; i++) {
+      ok = ok && protocol.transmitFrame(frames[0], lens[0]);
+   }
+   ok = ok && protocol.transmitFrames(burst, burst_lens, 4);
+   ok = ok && protocol.transmitFrame(frames[1], lens[1]);
+   for (int i = 2; i < 7; i++) {
+      ok = ok && protocol.transmitFrame(frames[i], lens[i]);
+   }
+   ok = ok && protocol.transmitFrame(frames[0], lens[0]);
+   samples = APRS::HAL::Native::samples();
+   stats = protocol.renderCacheStats();
+   return ok;
+}
+
+/**
+ * Seconds for `iterations` key-ups of the position frame, capture off
+ */
+double timeKeyups(const FramingCase& f, bool cache, int iterations) {
+   uint8_t frame[AX25_MAX_FRAME_LEN];
+   size_t len = buildFrame("=4906.15N/12239.21WnPHG1110ESP32-Tracker", frame);
+   APRS::HAL::Native::reset();
+   APRS::Protocol protocol;
+   protocol.begin(protocolConfig(f, cache));
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; i++) {
+      protocol.transmitFrame(frame, len);
+   }
+   std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+   return wall.count();
+}
+
+} // namespace
+
+int cmdCache(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 200;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   const size_t nframings = sizeof(FRAMINGS) / sizeof(FRAMINGS[0]);
+   bool ok = true;
+   printf("%-14s %6s %6s %9s %8s\n", "framing", "hits", "misses", "evictions", "audio");
+   for (size_t f = 0; f < nframings; f++) {
+      std::vector<uint16_t> cached;
+      std::vector<uint16_t> plain;
+      APRS::RenderCacheStats on;
+      APRS::RenderCacheStats off;
+      if (!sendSequence(FRAMINGS[f], true, cached, on) || !sendSequence(FRAMINGS[f], false, plain, off)) {
+         fprintf(stderr, "cache: %s send failed\n", FRAMINGS[f].name);
+         return 1;
+      }
+      // Hits: two repeats, three in the burst and the telemetry. Misses:
+      // position, telemetry, five status frames, and the position again
+      // once the status frames pushed it out
+      bool same = cached == plain;
+      bool counts = on.hits == 6 && on.misses == 8 && on.evictions == 4 && off.hits == 0 && off.misses == 0;
+      printf("%-14s %6u %6u %9u %8s\n", FRAMINGS[f].name, (unsigned)on.hits, (unsigned)on.misses,
+             (unsigned)on.evictions, same ? "same" : "DIFFERS");
+      ok = ok && same && counts;
+   }
+
+   printf("\n%d key-ups of the position frame (block modulator, capture off)\n", iterations);
+   printf("%-14s %12s %12s %9s\n", "framing", "plain us", "cached us", "saved");
+   APRS::HAL::Native::setCapture(false);
+   for (size_t f = 0; f < nframings; f++) {
+      double plain = timeKeyups(FRAMINGS[f], false, iterations);
+      double cached = timeKeyups(FRAMINGS[f], true, iterations);
+      printf("%-14s %12.1f %12.1f %8.1f%%\n", FRAMINGS[f].name, plain * 1e6 / iterations,
+             cached * 1e6 / iterations, 100.0 * (plain - cached) / plain);
+   }
+   APRS::HAL::Native::setCapture(true);
+
+   if (!ok) {
+      fprintf(stderr, "\nRender cache check failed\n");
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef NATIVE_COMMANDS_H
+#define NATIVE_COMMANDS_H
+
+#include <APRS.h>
+#include <string>
+#include <vector>
+
+/**
+ * Shared helpers and command entry points for the native host driver.
+ * Each command receives the arguments that follow its name.
+ */
+
+// ============================================================================
+// Shared helpers (main.cpp)
+// ============================================================================
+
+/**
+ * Tracker configuration used by every host command
+ */
+APRS::Config defaultConfig(APRS::ModulatorMode modulator = APRS::ModulatorMode::Block);
+
+/**
+ * Telemetry values used by every host command
+ */
+APRS::TelemetryData sampleTelemetry();
+
+/**
+ * Parse "sample", "block" or "dds"
+ * @return false for an unknown name
+ */
+bool parseModulator(const char* name, APRS::ModulatorMode& mode);
+
+/**
+ * Parse a modem name: "105k", "26k" or "13k" (Bell 202 at that sample
+ * rate), "hf300" or "hf300-13k" (300 baud HF)
+ * @return false for an unknown name
+ */
+bool parseModem(const char* name, const APRS::ModemProfile*& modem);
+
+/**
+ * Send a position and a telemetry report
+ * @return false if either failed
+ */
+bool sendReports(APRS::APRSClient& aprs);
+
+/**
+ * Demodulate everything the native HAL has captured so far (decode.cpp)
+ *
+ * Resets the HAL, so call it after the transmissions of interest.
+ * @param frames Receives each frame without FCS
+ * @param modem Baud and tones to receive (nullptr: Bell 202)
+ * @return false if the receiver could not start
+ */
+bool decodeRendered(std::vector<std::string>& frames, const APRS::ModemProfile* modem = nullptr);
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+int cmdSpectrum(int argc, char** argv);   // spectrum.cpp
+int cmdDecode(int argc, char** argv);     // decode.cpp
+int cmdLoopback(int argc, char** argv);   // decode.cpp
+int cmdKiss(int argc, char** argv);       // kiss.cpp
+int cmdKissTest(int argc, char** argv);   // kiss.cpp
+int cmdGolden(int argc, char** argv);     // golden.cpp
+int cmdFx25(int argc, char** argv);       // fx25.cpp
+int cmdIl2p(int argc, char** argv);       // il2p.cpp
+int cmdCache(int argc, char** argv);      // cache.cpp
+int cmdCrc(int argc, char** argv);        // crc.cpp
+int cmdPosition(int argc, char** argv);   // position.cpp
+int cmdSmartBeacon(int argc, char** argv); // beacon.cpp
+int cmdSchedule(int argc, char** argv);   // scheduler.cpp
+
+#endif // NATIVE_COMMANDS_H
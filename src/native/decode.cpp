@@ -0,0 +1,294 @@
+/**
+ * Receive-path commands for the native host driver
+ *
+ * decode   Feed a WAV file through the HAL capture input into a Receiver
+ *          (Bell 202, or the tones and baud of a named modem) and print
+ *          every frame it decodes.
+ * loopback Render a tracker cycle with our own modulator, optionally add
+ *          white noise, decode it and check every frame came back intact.
+ *          Also reports demodulator cost per sample and as a share of one
+ *          core at RX_SAMPLERATE.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <APRS_Receiver.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ============================================================================
+// Audio helpers
+// ============================================================================
+
+uint32_t readLE(const uint8_t* p, int n) {
+   uint32_t v = 0;
+   for (int i = n - 1; i >= 0; i--) {
+      v = (v << 8) | p[i];
+   }
+   return v;
+}
+
+/**
+ * Read a mono 8-bit unsigned or 16-bit signed PCM WAV file
+ */
+bool readWav(const char* path, std::vector<int16_t>& out, uint32_t& rate) {
+   FILE* f = fopen(path, "rb");
+   if (!f) {
+      return false;
+   }
+   std::vector<uint8_t> data;
+   uint8_t buf[4096];
+   size_t n;
+   while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+      data.insert(data.end(), buf, buf + n);
+   }
+   fclose(f);
+
+   if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) {
+      return false;
+   }
+
+   uint16_t channels = 0;
+   uint16_t bits = 0;
+   rate = 0;
+   for (size_t pos = 12; pos + 8 <= data.size();) {
+      uint32_t size = readLE(&data[pos + 4], 4);
+      size_t body = pos + 8;
+      if (body + size > data.size()) {
+         size = (uint32_t)(data.size() - body);
+      }
+      if (memcmp(&data[pos], "fmt ", 4) == 0 && size >= 16) {
+         channels = (uint16_t)readLE(&data[body + 2], 2);
+         rate = readLE(&data[body + 4], 4);
+         bits = (uint16_t)readLE(&data[body + 14], 2);
+      } else if (memcmp(&data[pos], "data", 4) == 0) {
+         if (channels != 1 || (bits != 8 && bits != 16)) {
+            return false;
+         }
+         size_t step = bits / 8;
+         out.clear();
+         for (size_t i = 0; i + step <= size; i += step) {
+            if (bits == 8) {
+               out.push_back((int16_t)(((int)data[body + i] - 128) << 8));
+            } else {
+               out.push_back((int16_t)readLE(&data[body + i], 2));
+            }
+         }
+         return rate > 0;
+      }
+      pos = body + size + (size & 1);
+   }
+   return false;
+}
+
+/**
+ * Convert to RX_SAMPLERATE: box-filter decimation for integer ratios,
+ * linear interpolation otherwise
+ */
+std::vector<int16_t> resample(const std::vector<int16_t>& in, uint32_t rate) {
+   std::vector<int16_t> out;
+   if (rate % RX_SAMPLERATE == 0) {
+      uint32_t factor = rate / RX_SAMPLERATE;
+      for (size_t i = 0; i + factor <= in.size(); i += factor) {
+         int32_t acc = 0;
+         for (uint32_t k = 0; k < factor; k++) {
+            acc += in[i + k];
+         }
+         out.push_back((int16_t)(acc / (int32_t)factor));
+      }
+   } else {
+      double step = (double)rate / RX_SAMPLERATE;
+      for (double t = 0.0; t + 1.0 < in.size(); t += step) {
+         size_t i = (size_t)t;
+         double frac = t - i;
+         out.push_back((int16_t)lround(in[i] * (1.0 - frac) + in[i + 1] * frac));
+      }
+   }
+   return out;
+}
+
+/**
+ * Add white Gaussian noise at the given RMS level relative to full scale
+ */
+void addNoise(std::vector<int16_t>& x, double rms) {
+   srand(1);
+   for (size_t i = 0; i < x.size(); i++) {
+      double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+      double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+      double g = sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+      double v = x[i] + g * rms * 32767.0;
+      x[i] = (int16_t)(v > 32767.0 ? 32767 : v < -32768.0 ? -32768 : v);
+   }
+}
+
+// ============================================================================
+// Frame collection
+// ============================================================================
+
+struct Collected {
+   std::vector<std::string> frames;
+   bool print;
+};
+
+void onFrame(const uint8_t* frame, size_t len, void* user) {
+   Collected* c = static_cast<Collected*>(user);
+   c->frames.push_back(std::string((const char*)frame, len));
+   if (c->print) {
+      APRS::AX25FrameView view;
+      char line[512];
+      if (view.parse(frame, len) && view.format(line, sizeof(line)) > 0) {
+         printf("  t=%9.1f ms  %s\n", APRS::HAL::Native::nowMicros() / 1000.0, line);
+      } else {
+         printf("  t=%9.1f ms  (%zu byte frame, bad address field)\n", APRS::HAL::Native::nowMicros() / 1000.0, len);
+      }
+   }
+}
+
+/**
+ * Run audio at RX_SAMPLERATE through a Receiver on this thread
+ */
+bool runReceiver(const std::vector<int16_t>& audio, Collected& collected, APRS::DemodStats& stats, double& wall_s,
+                 const APRS::ModemProfile* modem) {
+   APRS::HAL::Native::reset();
+   APRS::Receiver receiver;
+   APRS::ReceiverConfig config;
+   config.use_task = false;
+   config.modem = modem;
+   if (!receiver.begin(config, onFrame, &collected)) {
+      fprintf(stderr, "Receiver::begin() failed\n");
+      return false;
+   }
+   APRS::HAL::Native::feedCapture(audio.data(), audio.size());
+
+   auto start = std::chrono::steady_clock::now();
+   while (receiver.service()) {
+   }
+   std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+   wall_s = wall.count();
+   stats = receiver.stats();
+   return true;
+}
+
+/**
+ * Everything the native HAL captured from the DAC, at RX_SAMPLERATE
+ */
+std::vector<int16_t> renderedAudio() {
+   std::vector<int16_t> audio;
+   const std::vector<uint16_t>& dac = APRS::HAL::Native::samples();
+   audio.reserve(dac.size());
+   for (size_t i = 0; i < dac.size(); i++) {
+      audio.push_back((int16_t)(((int)(dac[i] >> 8) - 128) << 8));
+   }
+   return resample(audio, APRS::HAL::Native::sampleRate());
+}
+
+void printStats(const APRS::DemodStats& stats, double wall_s) {
+   double audio_s = (double)stats.samples / RX_SAMPLERATE;
+   printf("\n%u samples (%.1f s), %u frames, %u FCS errors, %u overruns\n", (unsigned)stats.samples, audio_s,
+          (unsigned)stats.frames, (unsigned)stats.fcs_errors, (unsigned)stats.overruns);
+   if (stats.samples > 0 && wall_s > 0.0) {
+      printf("demodulator: %.1f ns/sample, %.3f%% of one core in real time\n", wall_s * 1e9 / stats.samples,
+             100.0 * wall_s / audio_s);
+   }
+}
+
+} // namespace
+
+bool decodeRendered(std::vector<std::string>& frames, const APRS::ModemProfile* modem) {
+   Collected collected;
+   collected.print = false;
+   APRS::DemodStats stats;
+   double wall_s = 0.0;
+   if (!runReceiver(renderedAudio(), collected, stats, wall_s, modem)) {
+      return false;
+   }
+   frames.swap(collected.frames);
+   return true;
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+int cmdDecode(int argc, char** argv) {
+   if (argc < 1) {
+      fprintf(stderr, "decode: WAV file required\n");
+      return 2;
+   }
+   const APRS::ModemProfile* modem = nullptr;
+   if (argc > 1 && !parseModem(argv[1], modem)) {
+      fprintf(stderr, "Unknown modem '%s'\n", argv[1]);
+      return 2;
+   }
+
+   std::vector<int16_t> raw;
+   uint32_t rate = 0;
+   if (!readWav(argv[0], raw, rate)) {
+      fprintf(stderr, "Cannot read %s (mono 8/16-bit PCM WAV expected)\n", argv[0]);
+      return 1;
+   }
+   printf("%s: %zu samples @ %u Hz -> %u Hz\n\n", argv[0], raw.size(), rate, RX_SAMPLERATE);
+
+   Collected collected;
+   collected.print = true;
+   APRS::DemodStats stats;
+   double wall_s = 0.0;
+   if (!runReceiver(resample(raw, rate), collected, stats, wall_s, modem)) {
+      return 1;
+   }
+   printStats(stats, wall_s);
+   return 0;
+}
+
+int cmdLoopback(int argc, char** argv) {
+   APRS::ModulatorMode modulator = APRS::ModulatorMode::Block;
+   if (argc > 0 && !parseModulator(argv[0], modulator)) {
+      fprintf(stderr, "Unknown modulator '%s'\n", argv[0]);
+      return 2;
+   }
+   double noise = (argc > 1) ? atof(argv[1]) : 0.0;
+   APRS::Config config = defaultConfig(modulator);
+   if (argc > 2 && !parseModem(argv[2], config.modem)) {
+      fprintf(stderr, "Unknown modem '%s'\n", argv[2]);
+      return 2;
+   }
+
+   // Render one tracker cycle, keeping the encoded frames for comparison
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   if (!aprs.begin(config)) {
+      fprintf(stderr, "APRSClient::begin() failed\n");
+      return 1;
+   }
+   aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+   aprs.sendTelemetryDefinitions();
+   aprs.sendTelemetry(sampleTelemetry());
+   const size_t sent = 4;   // Position, PARM, UNIT, telemetry
+
+   std::vector<int16_t> audio = renderedAudio();
+   if (noise > 0.0) {
+      addNoise(audio, noise);
+   }
+
+   Collected collected;
+   collected.print = true;
+   APRS::DemodStats stats;
+   double wall_s = 0.0;
+   if (!runReceiver(audio, collected, stats, wall_s, config.modem)) {
+      return 1;
+   }
+   printStats(stats, wall_s);
+
+   if (collected.frames.size() != sent) {
+      printf("FAIL: decoded %zu of %zu frames\n", collected.frames.size(), sent);
+      return 1;
+   }
+   printf("OK: all %zu frames decoded\n", sent);
+   return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * FX.25 commands for the native host driver
+ *
+ * fx25     Round-trip random frames through every FX.25 code: up to the
+ *          code's capacity of byte errors (and tag bit errors) must come
+ *          back as the original frame, more must never yield a wrong one.
+ *          Then time the Reed-Solomon encoder per parity size against one
+ *          bit time, and send a tracker cycle in each mode to check that
+ *          plain AX.25 receivers still decode it.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <APRS_ReedSolomon.h>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+struct CodeResult {
+   uint32_t frames = 0;
+   uint32_t recovered = 0;      // Within capacity and decoded intact
+   uint32_t rejected = 0;       // Beyond capacity and refused
+   uint32_t wrong = 0;          // Any frame returned that differs from the original
+};
+
+const APRS::FX25Mode MODES[] = { APRS::FX25Mode::Check16, APRS::FX25Mode::Check32, APRS::FX25Mode::Check64 };
+const char* const MODE_NAMES[] = { "check16", "check32", "check64" };
+
+/**
+ * XOR a nonzero value into `count` distinct bytes of block[first, first + span)
+ */
+void corrupt(uint8_t* block, size_t first, size_t span, int count, unsigned& seed) {
+   bool hit[RS_SYMBOLS] = { false };
+   for (int e = 0; e < count; e++) {
+      size_t at;
+      do {
+         at = rand_r(&seed) % span;
+      } while (hit[at]);
+      hit[at] = true;
+      block[first + at] ^= (uint8_t)(1 + rand_r(&seed) % 255);
+   }
+}
+
+/**
+ * Random UI frame with 0-2 digipeaters; short info fields are favoured so
+ * the smallest codes get frames too
+ */
+size_t randomFrame(unsigned& seed, uint8_t* frame) {
+   size_t path_len = rand_r(&seed) % 3;
+   size_t info_len = 1 + rand_r(&seed) % ((rand_r(&seed) & 1) ? 32 : AX25_MAX_INFO_LEN);
+   APRS::AX25Call src = { "NOCALL", 9 };
+   APRS::AX25Call dst = { "APZMDR", 0 };
+   APRS::AX25Call path[2] = { { "WIDE1", 1 }, { "WIDE2", 2 } };
+   uint8_t info[AX25_MAX_INFO_LEN];
+   for (size_t i = 0; i < info_len; i++) {
+      info[i] = (uint8_t)rand_r(&seed);
+   }
+   return APRS::Protocol::encodeFrame(src, dst, path, path_len, info, info_len, frame, AX25_MAX_FRAME_LEN);
+}
+
+bool roundTrip(int trials, unsigned seed) {
+   std::map<std::pair<int, int>, CodeResult> results;     // By parity bytes, then block size
+   uint32_t tag_ok = 0;
+   uint32_t tag_trials = 0;
+   uint32_t plain = 0;
+
+   for (int t = 0; t < trials; t++) {
+      for (size_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++) {
+         uint8_t frame[AX25_MAX_FRAME_LEN];
+         size_t len = randomFrame(seed, frame);
+         const APRS::FX25Code* code = APRS::FX25Codec::pick(MODES[m], frame, len);
+         uint8_t block[FX25_MAX_BLOCK];
+         size_t block_len = APRS::FX25Codec::encode(MODES[m], frame, len, block, sizeof(block));
+         if (!code) {
+            plain++;        // Too long for any code: goes out as plain AX.25
+            if (block_len != 0) {
+               return false;
+            }
+            continue;
+         }
+         if (block_len != (size_t)FX25_CTAG_LEN + code->n) {
+            return false;
+         }
+
+         CodeResult& r = results[std::make_pair(code->n - code->k, (int)code->n)];
+         r.frames++;
+         int capacity = (code->n - code->k) / 2;
+
+         // Within capacity, data and parity errors, up to FX25_TAG_ERRORS tag bits
+         uint8_t rx[FX25_MAX_BLOCK];
+         uint8_t out[AX25_MAX_FRAME_LEN];
+         int errors = rand_r(&seed) % (capacity + 1);
+         memcpy(rx, block, block_len);
+         corrupt(rx, FX25_CTAG_LEN, code->n, errors, seed);
+         int tag_bits = rand_r(&seed) % (FX25_TAG_ERRORS + 1);
+         for (int b = 0; b < tag_bits; b++) {
+            rx[rand_r(&seed) % FX25_CTAG_LEN] ^= (uint8_t)(1u << (rand_r(&seed) % 8));
+         }
+         int corrected = -1;
+         size_t got = APRS::FX25Codec::decode(rx, block_len, out, sizeof(out), &corrected);
+         bool intact = got == len && memcmp(out, frame, len) == 0;
+         if (intact && corrected == errors) {
+            r.recovered++;
+         } else if (got != 0 && !intact) {
+            r.wrong++;
+         }
+         tag_trials++;
+         tag_ok += intact ? 1 : 0;
+
+         // Beyond capacity: refused, never a different frame
+         memcpy(rx, block, block_len);
+         corrupt(rx, FX25_CTAG_LEN, code->n, capacity + 1 + rand_r(&seed) % 4, seed);
+         got = APRS::FX25Codec::decode(rx, block_len, out, sizeof(out));
+         if (got == 0) {
+            r.rejected++;
+         } else if (got != len || memcmp(out, frame, len) != 0) {
+            r.wrong++;
+         }
+      }
+   }
+
+   printf("%-10s %5s %7s %10s %10s %6s\n", "code", "fix", "frames", "recovered", "rejected", "wrong");
+   bool ok = true;
+   for (std::map<std::pair<int, int>, CodeResult>::const_iterator it = results.begin(); it != results.end(); ++it) {
+      int parity = it->first.first;
+      int n = it->first.second;
+      const CodeResult& r = it->second;
+      char name[16];
+      snprintf(name, sizeof(name), "RS(%d,%d)", n, n - parity);
+      printf("%-10s %5d %7u %10u %10u %6u\n", name, parity / 2, (unsigned)r.frames,
+             (unsigned)r.recovered, (unsigned)r.rejected, (unsigned)r.wrong);
+      ok = ok && r.recovered == r.frames && r.wrong == 0;
+   }
+   printf("%u frames too long for a code went out as plain AX.25; %u/%u decoded with tag bit errors\n",
+          (unsigned)plain, (unsigned)tag_ok, (unsigned)tag_trials);
+   return ok && tag_ok == tag_trials && results.size() == 11;
+}
+
+void benchmark(int iterations) {
+   printf("\n%-8s %6s %12s %14s %14s\n", "parity", "data", "ns/block", "of 1200 bd bit", "of 300 bd bit");
+   const uint8_t roots[] = { 16, 32, 64 };
+   uint32_t check = 0;
+   for (size_t r = 0; r < sizeof(roots) / sizeof(roots[0]); r++) {
+      APRS::ReedSolomon rs(roots[r], FX25_RS_FCR);
+      size_t k = RS_SYMBOLS - roots[r];
+      uint8_t data[RS_SYMBOLS];
+      uint8_t parity[RS_MAX_ROOTS];
+      for (size_t i = 0; i < k; i++) {
+         data[i] = (uint8_t)(i * 37 + 11);
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (int n = 0; n < iterations; n++) {
+         data[0] = (uint8_t)n;
+         rs.encode(data, k, parity);
+         check += parity[0];
+      }
+      std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+      double ns = wall.count() * 1e9 / iterations;
+      printf("%-8u %6zu %12.0f %13.2f%% %13.2f%%\n", (unsigned)roots[r], k, ns,
+             100.0 * ns / (1e9 / APRS::Bell202::BAUD), 100.0 * ns / (1e9 / APRS::Hf300::BAUD));
+   }
+   printf("(checksum %u)\n", (unsigned)check);
+}
+
+bool loopback() {
+   printf("\n%-8s %7s %9s %8s %11s %7s\n", "mode", "fx25", "bits", "added B", "airtime ms", "decode");
+   bool ok = true;
+   for (size_t m = 0; m <= sizeof(MODES) / sizeof(MODES[0]); m++) {
+      APRS::HAL::Native::reset();
+      APRS::Config config = defaultConfig();
+      config.fx25 = (m == 0) ? APRS::FX25Mode::Off : MODES[m - 1];
+      APRS::APRSClient aprs;
+      if (!aprs.begin(config)) {
+         fprintf(stderr, "fx25: client failed to start\n");
+         return false;
+      }
+
+      APRS::TxStats total;
+      bool sent = aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+      total = aprs.lastTxStats();
+      sent = sent && aprs.sendTelemetry(sampleTelemetry());
+      const APRS::TxStats& tx = aprs.lastTxStats();
+      total.fx25_frames += tx.fx25_frames;
+      total.fx25_bytes += tx.fx25_bytes;
+      total.bits += tx.bits;
+      total.airtime_ms += tx.airtime_ms;
+
+      // Plain AX.25 receivers skip the tag and parity and decode the frame
+      std::vector<std::string> frames;
+      bool decoded = sent && decodeRendered(frames) && frames.size() == 2;
+      bool expected = total.fx25_frames == ((m == 0) ? 0u : 2u);
+      ok = ok && decoded && expected;
+      printf("%-8s %7u %9u %8u %11u %7s\n", (m == 0) ? "off" : MODE_NAMES[m - 1], (unsigned)total.fx25_frames,
+             (unsigned)total.bits, (unsigned)total.fx25_bytes, (unsigned)total.airtime_ms,
+             decoded ? "ok" : "FAIL");
+   }
+
+   // Mixed burst: a frame too long for any code goes out plain between two
+   // FX.25 blocks and needs its own opening flag
+   APRS::HAL::Native::reset();
+   APRS::Protocol protocol;
+   APRS::ProtocolConfig pconfig = {
+      .ptt_pin = 33,
+      .preamble_ms = 350,
+      .tail_ms = 50,
+      .modulator = APRS::ModulatorMode::Block,
+      .sink = nullptr,
+      .modem = nullptr,
+      .fx25 = APRS::FX25Mode::Check16,
+      .framing = APRS::Framing::Ax25,
+      .render_cache = false,
+      .ptt_lead_ms = PTT_LEAD_MS,
+      .ptt_tail_ms = PTT_TAIL_MS,
+      .ptt_active_high = false
+   };
+   unsigned seed = 3;
+   uint8_t frames[3][AX25_MAX_FRAME_LEN];
+   size_t lens[3];
+   const uint8_t* ptrs[3];
+   for (size_t i = 0; i < 3; i++) {
+      do {
+         lens[i] = randomFrame(seed, frames[i]);
+      } while ((APRS::FX25Codec::pick(pconfig.fx25, frames[i], lens[i]) == nullptr) != (i == 1));
+      ptrs[i] = frames[i];
+   }
+   std::vector<std::string> decoded;
+   bool burst_ok = protocol.begin(pconfig) && protocol.transmitFrames(ptrs, lens, 3);
+   uint32_t expected_bits = protocol.keyupBits(ptrs, lens, 3);
+   const APRS::TxStats& tx = protocol.lastStats();
+   burst_ok = burst_ok && tx.bits == expected_bits && tx.fx25_frames == 2 && decodeRendered(decoded) &&
+              decoded.size() == 3;
+   printf("%-8s %7u %9u %8u %11u %7s\n", "mixed", (unsigned)tx.fx25_frames, (unsigned)tx.bits,
+          (unsigned)tx.fx25_bytes, (unsigned)tx.airtime_ms, burst_ok ? "ok" : "FAIL");
+   return ok && burst_ok;
+}
+
+} // namespace
+
+int cmdFx25(int argc, char** argv) {
+   int trials = (argc > 0) ? atoi(argv[0]) : 2000;
+   unsigned seed = (argc > 1) ? (unsigned)atoi(argv[1]) : 1;
+   if (trials <= 0) {
+      fprintf(stderr, "trials must be positive\n");
+      return 2;
+   }
+
+   bool codec_ok = roundTrip(trials, seed);
+   benchmark(trials * 10);
+   bool loop_ok = loopback();
+
+   if (!codec_ok || !loop_ok) {
+      fprintf(stderr, "\nFX.25 %s failed\n", codec_ok ? "loopback" : "round trip");
+      return 1;
+   }
+   return 0;
+}
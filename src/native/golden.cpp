@@ -0,0 +1,106 @@
+/**
+ * Golden renders for the native host driver
+ *
+ * golden   Render the same position and telemetry reports with the block
+ *          modulator for each shipped modem and write them as
+ *          golden_<modem>.wav. Each render is checked three ways: its
+ *          CRC-32 against the value recorded here, against the same reports
+ *          sent by one long-lived client switched with setModem(), and by
+ *          demodulating it with a receiver for that modem.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <stdio.h>
+#include <string>
+
+namespace {
+
+struct Golden {
+   const char* name;
+   const APRS::ModemProfile* modem;
+   uint32_t samples;
+   uint32_t crc;        // CRC-32 of the 8-bit WAV samples
+};
+
+const Golden GOLDEN[] = {
+   { "105k", &APRS::Bell202::PROFILE, 237336, 0x5512dba4 },
+   { "13k", &APRS::Bell202_13k::PROFILE, 29667, 0x374ed7b3 },
+   { "hf300", &APRS::Hf300::PROFILE, 569184, 0x3d4b8daf },
+   { "hf300-13k", &APRS::Hf300_13k::PROFILE, 71148, 0x85d4b453 },
+};
+
+/**
+ * CRC-32 (IEEE, reflected) of the DAC values in the captured samples
+ */
+uint32_t captureCrc() {
+   const std::vector<uint16_t>& samples = APRS::HAL::Native::samples();
+   uint32_t crc = 0xFFFFFFFF;
+   for (size_t i = 0; i < samples.size(); i++) {
+      crc ^= samples[i] >> 8;
+      for (int b = 0; b < 8; b++) {
+         crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+      }
+   }
+   return ~crc;
+}
+
+} // namespace
+
+int cmdGolden(int argc, char** argv) {
+   std::string dir = (argc > 0) ? argv[0] : ".";
+
+   // Switched through every modem in turn, starting from the default
+   APRS::HAL::Native::reset();
+   APRS::APRSClient switched;
+   if (!switched.begin(defaultConfig())) {
+      fprintf(stderr, "golden: client failed to start\n");
+      return 1;
+   }
+
+   printf("%-10s %8s %5s %9s %10s %8s %8s %7s\n", "modem", "rate", "baud", "samples", "crc", "golden", "switch",
+          "decode");
+   bool all_ok = true;
+   for (size_t g = 0; g < sizeof(GOLDEN) / sizeof(GOLDEN[0]); g++) {
+      const Golden& golden = GOLDEN[g];
+
+      APRS::HAL::Native::reset();
+      APRS::Config config = defaultConfig();
+      config.modem = golden.modem;
+      APRS::APRSClient aprs;
+      uint16_t sequence = aprs.getTelemetrySequence();
+      if (!aprs.begin(config) || !sendReports(aprs)) {
+         fprintf(stderr, "%s: render failed\n", golden.name);
+         return 1;
+      }
+      uint32_t samples = APRS::HAL::Native::samples().size();
+      uint32_t crc = captureCrc();
+      std::string path = dir + "/golden_" + golden.name + ".wav";
+      if (!APRS::HAL::Native::writeWav(path.c_str())) {
+         fprintf(stderr, "Failed to write %s\n", path.c_str());
+         return 1;
+      }
+      bool golden_ok = samples == golden.samples && crc == golden.crc;
+
+      std::vector<std::string> frames;
+      bool decode_ok = decodeRendered(frames, golden.modem) && frames.size() == 2;
+
+      // Same reports after a runtime switch must render identically
+      APRS::HAL::Native::reset();
+      switched.setModem(golden.modem);
+      switched.setTelemetrySequence(sequence);
+      bool switch_ok = sendReports(switched) && APRS::HAL::Native::samples().size() == samples &&
+                       captureCrc() == crc && APRS::HAL::Native::sampleRate() == golden.modem->sample_rate;
+
+      all_ok = all_ok && golden_ok && switch_ok && decode_ok;
+      printf("%-10s %8u %5u %9u   %08x %8s %8s %7s\n", golden.name, (unsigned)golden.modem->sample_rate,
+             (unsigned)golden.modem->baud, (unsigned)samples, (unsigned)crc, golden_ok ? "ok" : "CHANGED",
+             switch_ok ? "ok" : "FAIL", decode_ok ? "ok" : "FAIL");
+   }
+
+   if (!all_ok) {
+      fprintf(stderr, "\nA render changed, differs after setModem() or did not decode\n");
+      return 1;
+   }
+   printf("\nWrote %s/golden_*.wav\n", dir.c_str());
+   return 0;
+}
@@ -0,0 +1,335 @@
+/**
+ * KISS TNC commands for the native host driver
+ *
+ * kiss     Run the TNC on a pseudo-terminal so host KISS software
+ *          (kissattach, Dire Wolf's kissutil, Xastir) can drive the real
+ *          KissTnc/TxEngine/Protocol code. Optionally writes everything it
+ *          modulated to a WAV file on Ctrl-C.
+ * kisstest Stream back-to-back frames, escapes and parameter commands into
+ *          the TNC in random chunk sizes, more frames than the TX queue
+ *          holds, then demodulate the audio and check every frame went out
+ *          intact and in order. The decoded frames go back through
+ *          sendFrame() and are unescaped again as the host would.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// ============================================================================
+// Transports
+// ============================================================================
+
+/**
+ * Master side of a pseudo-terminal; the host opens the slave path
+ */
+class PtyTransport : public APRS::KissTransport {
+public:
+   PtyTransport() : _master(-1), _slave(-1) {}
+
+   ~PtyTransport() {
+      if (_slave >= 0) {
+         close(_slave);
+      }
+      if (_master >= 0) {
+         close(_master);
+      }
+   }
+
+   bool open() {
+      _master = posix_openpt(O_RDWR | O_NOCTTY);
+      if (_master < 0 || grantpt(_master) != 0 || unlockpt(_master) != 0) {
+         return false;
+      }
+      const char* name = ptsname(_master);
+      if (!name) {
+         return false;
+      }
+      _path = name;
+
+      // Raw mode for the host; holding the slave open also keeps reads on
+      // the master from failing before the host connects
+      _slave = ::open(name, O_RDWR | O_NOCTTY);
+      if (_slave < 0) {
+         return false;
+      }
+      struct termios tio;
+      if (tcgetattr(_slave, &tio) == 0) {
+         cfmakeraw(&tio);
+         tcsetattr(_slave, TCSANOW, &tio);
+      }
+      return true;
+   }
+
+   const char* path() const { return _path.c_str(); }
+
+   size_t read(uint8_t* data, size_t max, uint32_t timeout_ms) override {
+      struct pollfd pfd = { _master, POLLIN, 0 };
+      if (poll(&pfd, 1, (int)timeout_ms) <= 0) {
+         return 0;
+      }
+      ssize_t n = ::read(_master, data, max);
+      return n > 0 ? (size_t)n : 0;
+   }
+
+   size_t write(const uint8_t* data, size_t len) override {
+      size_t done = 0;
+      while (done < len) {
+         ssize_t n = ::write(_master, data + done, len - done);
+         if (n <= 0) {
+            break;
+         }
+         done += n;
+      }
+      return done;
+   }
+
+private:
+   int _master;
+   int _slave;
+   std::string _path;
+};
+
+/**
+ * Replays a byte stream in random chunk sizes and records what is written
+ */
+class MemoryTransport : public APRS::KissTransport {
+public:
+   MemoryTransport(const std::vector<uint8_t>& input, unsigned seed) : _input(input), _pos(0), _seed(seed) {}
+
+   bool drained() const { return _pos == _input.size(); }
+   const std::vector<uint8_t>& output() const { return _output; }
+
+   size_t read(uint8_t* data, size_t max, uint32_t timeout_ms) override {
+      if (drained()) {
+         APRS::HAL::delayMs(timeout_ms);
+         return 0;
+      }
+      size_t n = 1 + rand_r(&_seed) % 64;
+      n = std::min(n, std::min(max, _input.size() - _pos));
+      memcpy(data, &_input[_pos], n);
+      _pos += n;
+      return n;
+   }
+
+   size_t write(const uint8_t* data, size_t len) override {
+      _output.insert(_output.end(), data, data + len);
+      return len;
+   }
+
+private:
+   std::vector<uint8_t> _input;
+   size_t _pos;
+   unsigned _seed;
+   std::vector<uint8_t> _output;
+};
+
+// ============================================================================
+// Host-side KISS framing
+// ============================================================================
+
+void kissAppend(std::vector<uint8_t>& out, uint8_t type, const uint8_t* data, size_t len) {
+   out.push_back(KISS_FEND);
+   out.push_back(type);
+   for (size_t i = 0; i < len; i++) {
+      if (data[i] == KISS_FEND) {
+         out.push_back(KISS_FESC);
+         out.push_back(KISS_TFEND);
+      } else if (data[i] == KISS_FESC) {
+         out.push_back(KISS_FESC);
+         out.push_back(KISS_TFESC);
+      } else {
+         out.push_back(data[i]);
+      }
+   }
+   out.push_back(KISS_FEND);
+}
+
+/**
+ * Split a KISS stream into data frames (type byte removed)
+ */
+std::vector<std::string> kissSplit(const std::vector<uint8_t>& in) {
+   std::vector<std::string> frames;
+   std::string cur;
+   bool escape = false;
+   for (size_t i = 0; i < in.size(); i++) {
+      uint8_t b = in[i];
+      if (b == KISS_FEND) {
+         if (cur.size() > 1 && cur[0] == KISS_CMD_DATA) {
+            frames.push_back(cur.substr(1));
+         }
+         cur.clear();
+         escape = false;
+      } else if (escape) {
+         cur += (char)(b == KISS_TFEND ? KISS_FEND : b == KISS_TFESC ? KISS_FESC : b);
+         escape = false;
+      } else if (b == KISS_FESC) {
+         escape = true;
+      } else {
+         cur += (char)b;
+      }
+   }
+   return frames;
+}
+
+/**
+ * Test frame i: UI frame whose info field needs KISS escaping
+ */
+std::string testFrame(int i) {
+   APRS::AX25Call dst = { "APZMDR", 0 };
+   APRS::AX25Call src = { "N0CALL", (uint8_t)(i % 16) };
+   APRS::AX25Call path = { "WIDE1", 1 };
+
+   char text[48];
+   int n = snprintf(text, sizeof(text), ">KISS test %d ", i);
+   uint8_t info[64];
+   memcpy(info, text, n);
+   const uint8_t escapes[] = { KISS_FEND, KISS_FESC, KISS_TFEND, KISS_FESC, KISS_FEND };
+   memcpy(info + n, escapes, sizeof(escapes));
+
+   uint8_t frame[AX25_MAX_FRAME_LEN];
+   APRS::AX25FrameBuilder builder(frame, sizeof(frame));
+   builder.addAddress(dst);
+   builder.addAddress(src);
+   builder.addAddress(path);
+   builder.addHeader();
+   builder.addInfo(info, n + sizeof(escapes));
+   size_t len = builder.finish();
+   return std::string((const char*)frame, len - 2);   // KISS carries no FCS
+}
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+   stopRequested = 1;
+}
+
+void printKissStats(const APRS::KissStats& s) {
+   printf("KISS: %u frames in, %u frames out, %u commands, %u dropped, %u stalls\n", (unsigned)s.frames_in,
+          (unsigned)s.frames_out, (unsigned)s.commands, (unsigned)s.dropped, (unsigned)s.stalls);
+}
+
+} // namespace
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+int cmdKiss(int argc, char** argv) {
+   const char* wav = (argc > 0) ? argv[0] : nullptr;
+
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   APRS::TxEngineConfig txConfig;
+   txConfig.use_task = false;
+   APRS::KissConfig kissConfig;
+   kissConfig.use_task = false;
+   PtyTransport pty;
+   if (!aprs.begin(defaultConfig()) || !aprs.startTxEngine(txConfig) || !pty.open() ||
+       !aprs.startKiss(&pty, kissConfig)) {
+      fprintf(stderr, "KISS TNC failed to start\n");
+      return 1;
+   }
+
+   signal(SIGINT, onSignal);
+   printf("KISS TNC on %s (Ctrl-C to stop)\n", pty.path());
+   fflush(stdout);
+
+   while (!stopRequested) {
+      aprs.kissService();
+      if (aprs.service()) {
+         const APRS::TxStats& tx = aprs.lastTxStats();
+         printf("  t=%9.1f ms  key-up: %u frame(s), %u ms airtime\n", APRS::HAL::Native::nowMicros() / 1000.0,
+                (unsigned)tx.frames, (unsigned)tx.airtime_ms);
+         fflush(stdout);
+      }
+   }
+
+   printf("\n");
+   printKissStats(aprs.kissStats());
+   if (wav) {
+      if (!APRS::HAL::Native::writeWav(wav)) {
+         fprintf(stderr, "Cannot write %s\n", wav);
+         return 1;
+      }
+      printf("Wrote %zu samples to %s\n", APRS::HAL::Native::samples().size(), wav);
+   }
+   return 0;
+}
+
+int cmdKissTest(int argc, char** argv) {
+   int count = (argc > 0) ? atoi(argv[0]) : 12;
+   unsigned seed = (argc > 1) ? (unsigned)atoi(argv[1]) : 1;
+   if (count < 1 || count > 100) {
+      fprintf(stderr, "kisstest: 1 to 100 frames\n");
+      return 2;
+   }
+
+   // Host stream: parameters, then every frame back to back (one doubled FEND)
+   std::vector<std::string> sent;
+   std::vector<uint8_t> stream;
+   const uint8_t txdelay = 30, txtail = 5, slottime = 5;
+   kissAppend(stream, KISS_CMD_TXDELAY, &txdelay, 1);
+   kissAppend(stream, KISS_CMD_TXTAIL, &txtail, 1);
+   kissAppend(stream, KISS_CMD_SLOTTIME, &slottime, 1);
+   for (int i = 0; i < count; i++) {
+      sent.push_back(testFrame(i));
+      kissAppend(stream, KISS_CMD_DATA, (const uint8_t*)sent.back().data(), sent.back().size());
+      if (i == count / 2) {
+         stream.push_back(KISS_FEND);
+      }
+   }
+
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   APRS::TxEngineConfig txConfig;
+   txConfig.use_task = false;
+   APRS::KissConfig kissConfig;
+   kissConfig.use_task = false;
+   MemoryTransport host(stream, seed);
+   if (!aprs.begin(defaultConfig()) || !aprs.startTxEngine(txConfig) || !aprs.startKiss(&host, kissConfig)) {
+      fprintf(stderr, "KISS TNC failed to start\n");
+      return 1;
+   }
+
+   // Let the TNC read until the queue pushes back, then send one key-up
+   for (;;) {
+      while (aprs.kissService()) {
+      }
+      bool sending = aprs.service();
+      if (!sending && host.drained() && !aprs.isBusy()) {
+         break;
+      }
+   }
+   printf("%d frames, %zu KISS bytes in chunks of 1-64\n", count, stream.size());
+   APRS::TxEngineStats engine = aprs.txEngineStats();
+   printf("TX: %u key-ups, %u frames, %.1f s virtual time\n", (unsigned)engine.keyups, (unsigned)engine.frames,
+          APRS::HAL::Native::nowMicros() / 1e6);
+
+   // Demodulate what went on air and hand it back to the host
+   std::vector<std::string> decoded;
+   if (!decodeRendered(decoded)) {
+      return 1;
+   }
+   for (size_t i = 0; i < decoded.size(); i++) {
+      aprs.kissForward((const uint8_t*)decoded[i].data(), decoded[i].size());
+   }
+   std::vector<std::string> returned = kissSplit(host.output());
+
+   const APRS::KissStats& stats = aprs.kissStats();
+   printKissStats(stats);
+   bool ok = stats.frames_in == (uint32_t)count && stats.dropped == 0 && stats.commands == 3;
+   ok = ok && decoded == sent && returned == sent;
+   printf("%s: %zu of %d frames on air, %zu returned to the host intact\n", ok ? "OK" : "FAIL", decoded.size(), count,
+          returned.size());
+   return ok ? 0 : 1;
+}
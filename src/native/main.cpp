@@ -0,0 +1,1069 @@
+/**
+ * Host-side driver for LibAPRS_Refactored (PlatformIO env:native)
+ *
+ * Runs the real APRSClient/Protocol code against the native HAL, which
+ * captures every DAC sample and PTT edge with a virtual timestamp.
+ *
+ * Usage:
+ *   program render [out.wav] [modulator] [modem]  Render one tracker cycle and report stats
+ *   program bench [iterations]                     Compare modulator paths on identical frames
+ *   program rates [iterations]                     Compare modem sample rates per modulator
+ *   program sinks [out.wav]                        Render through each audio sink and compare
+ *   program spectrum [modulator] [modem]           Tone accuracy, harmonics, phase continuity
+ *   program queue                                  Exercise the TX queue and coalescing
+ *   program burst [out.wav]                        Compare one key-up per packet against a burst
+ *   program decode <in.wav> [modem]                Demodulate a WAV file and print the frames
+ *   program loopback [modulator] [noise] [modem]   Modulate, demodulate and check a tracker cycle
+ *   program parse [iterations]                     AX.25 parse, format and encode throughput
+ *   program kiss [out.wav]                         KISS TNC on a pseudo-terminal
+ *   program kisstest [frames] [seed]               Back-to-back KISS frames through the TNC and back
+ *   program golden [dir]                           Render, check and write the per-modem golden WAVs
+ *   program fx25 [trials] [seed]                   FX.25 round trip, RS encoder timing and loopback
+ *   program il2p [trials] [seed]                   IL2P round trip, airtime and known answers
+ *   program cache [iterations]                     Render cache: identical audio, hit counts, timing
+ *   program airtime [iterations]                   Airtime estimates against the captured PTT time
+ *   program duty [percent] [window_s]              Duty-cycle limit under a runaway beacon loop
+ *   program ptt [lead_ms] [tail_ms]                PTT edges against the first and last audio sample
+ *   program crc [megabytes]                        FCS tables against a bitwise reference, throughput
+ *   program position [iterations]                  Compressed/uncompressed reports: round trip, bytes, airtime
+ *   program smartbeacon [fixed_s]                  SmartBeaconing against fixed intervals on a replayed drive
+ *   program schedule [minutes]                     Job lateness under load: timer scheduler against polling
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Shared helpers
+// ============================================================================
+
+APRS::Config defaultConfig(APRS::ModulatorMode modulator) {
+   APRS::Config config;
+   config.modulator = modulator;
+   config.callsign = "NOCALL";
+   config.ssid = 9;
+   config.preamble_ms = 350;
+   config.tail_ms = 50;
+   return config;
+}
+
+APRS::TelemetryData sampleTelemetry() {
+   APRS::TelemetryData telem;
+   telem.analog[0] = 3.7f;
+   telem.analog[1] = 21.5f;
+   telem.analog[2] = 1013.2f;
+   telem.analog[3] = 45.0f;
+   telem.analog[4] = 100.0f;
+   telem.digital = 0;
+   return telem;
+}
+
+bool parseModulator(const char* name, APRS::ModulatorMode& mode) {
+   if (strcmp(name, "sample") == 0) {
+      mode = APRS::ModulatorMode::Sample;
+   } else if (strcmp(name, "block") == 0) {
+      mode = APRS::ModulatorMode::Block;
+   } else if (strcmp(name, "dds") == 0) {
+      mode = APRS::ModulatorMode::Dds;
+   } else {
+      return false;
+   }
+   return true;
+}
+
+bool parseModem(const char* name, const APRS::ModemProfile*& modem) {
+   if (strcmp(name, "105k") == 0) {
+      modem = &APRS::Bell202::PROFILE;
+   } else if (strcmp(name, "26k") == 0) {
+      modem = &APRS::Bell202_26k::PROFILE;
+   } else if (strcmp(name, "13k") == 0) {
+      modem = &APRS::Bell202_13k::PROFILE;
+   } else if (strcmp(name, "hf300") == 0) {
+      modem = &APRS::Hf300::PROFILE;
+   } else if (strcmp(name, "hf300-13k") == 0) {
+      modem = &APRS::Hf300_13k::PROFILE;
+   } else {
+      return false;
+   }
+   return true;
+}
+
+/**
+ * Telemetry definitions are left out of sendReports(): their message
+ * numbers run on across clients, so renders would differ.
+ */
+bool sendReports(APRS::APRSClient& aprs) {
+   return aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0) &&
+          aprs.sendTelemetry(sampleTelemetry());
+}
+
+namespace {
+
+double msFromSamples(uint64_t samples) {
+   return samples * 1000.0 / APRS::HAL::Native::sampleRate();
+}
+
+/**
+ * Print figures for one step. PTT time spans every edge captured since
+ * first_edge; frame/sample counts are those of the step's last packet.
+ */
+void reportPacket(const char* name, const APRS::TxStats& stats, size_t first_edge, double wall_s) {
+   using namespace APRS::HAL;
+   const std::vector<Native::PttEdge>& edges = Native::pttEdges();
+
+   double ptt_ms = 0.0;
+   if (edges.size() >= first_edge + 2) {
+      ptt_ms = (edges[edges.size() - 1].time_us - edges[first_edge].time_us) / 1000.0;
+   }
+
+   printf("%-12s frame=%3u B  stuffed=%2u  bits=%4u  samples=%7u  audio=%7.1f ms  ptt=%7.1f ms  %6.2f Msps\n",
+          name, (unsigned)stats.frame_bytes, (unsigned)stats.stuffed_bits, (unsigned)stats.bits, (unsigned)stats.samples,
+          msFromSamples(stats.samples), ptt_ms, wall_s > 0 ? stats.samples / wall_s / 1e6 : 0.0);
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+/**
+ * Render one tracker cycle (position, PARM/UNIT, telemetry) with one key-up
+ * per packet and write the audio to a WAV file.
+ */
+int cmdRender(int argc, char** argv) {
+   const char* out = (argc > 0) ? argv[0] : "aprs.wav";
+   APRS::ModulatorMode modulator = APRS::ModulatorMode::Block;
+   if (argc > 1 && !parseModulator(argv[1], modulator)) {
+      fprintf(stderr, "Unknown modulator '%s'\n", argv[1]);
+      return 2;
+   }
+   APRS::Config config = defaultConfig(modulator);
+   if (argc > 2 && !parseModem(argv[2], config.modem)) {
+      fprintf(stderr, "Unknown modem '%s'\n", argv[2]);
+      return 2;
+   }
+
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   if (!aprs.begin(config)) {
+      fprintf(stderr, "APRSClient::begin() failed\n");
+      return 1;
+   }
+
+   struct Step {
+      const char* name;
+      int kind;
+   } steps[] = { { "position", 0 }, { "definitions", 1 }, { "telemetry", 2 } };
+
+   for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+      size_t first_edge = APRS::HAL::Native::pttEdges().size();
+      auto start = std::chrono::steady_clock::now();
+
+      bool ok = false;
+      switch (steps[i].kind) {
+      case 0:
+         ok = aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+         break;
+      case 1:
+         ok = aprs.sendTelemetryDefinitions();
+         break;
+      default:
+         ok = aprs.sendTelemetry(sampleTelemetry());
+         break;
+      }
+
+      std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+      if (!ok) {
+         fprintf(stderr, "%s: send failed\n", steps[i].name);
+         return 1;
+      }
+      reportPacket(steps[i].name, aprs.lastTxStats(), first_edge, wall.count());
+   }
+
+   const std::vector<APRS::HAL::Native::PttEdge>& edges = APRS::HAL::Native::pttEdges();
+   printf("\nPTT edges:\n");
+   for (size_t i = 0; i < edges.size(); i++) {
+      printf("  t=%10.3f ms  pin=%u  level=%d\n", edges[i].time_us / 1000.0, edges[i].pin, edges[i].level);
+   }
+
+   printf("\nTotal: %zu samples @ %u Hz, virtual time %.1f ms\n", APRS::HAL::Native::samples().size(),
+          APRS::HAL::Native::sampleRate(), APRS::HAL::Native::nowMicros() / 1000.0);
+
+   if (!APRS::HAL::Native::writeWav(out)) {
+      fprintf(stderr, "Failed to write %s\n", out);
+      return 1;
+   }
+   printf("Wrote %s\n", out);
+   return 0;
+}
+
+/**
+ * Modulate the same position frame repeatedly with each modulator path and
+ * compare throughput. Sample capture is disabled so only the modulator is
+ * measured.
+ */
+int cmdBench(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 200;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   struct Result {
+      const char* name;
+      APRS::ModulatorMode mode;
+      uint32_t bits;
+      double seconds;
+   } results[] = { { "sample", APRS::ModulatorMode::Sample, 0, 0.0 },
+                   { "block", APRS::ModulatorMode::Block, 0, 0.0 },
+                   { "dds", APRS::ModulatorMode::Dds, 0, 0.0 } };
+   const size_t count = sizeof(results) / sizeof(results[0]);
+
+   APRS::HAL::Native::setCapture(false);
+   for (size_t r = 0; r < count; r++) {
+      APRS::HAL::Native::reset();
+      APRS::APRSClient aprs;
+      aprs.begin(defaultConfig(results[r].mode));
+
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; i++) {
+         aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+      }
+      std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+      results[r].bits = aprs.lastTxStats().bits;
+      results[r].seconds = wall.count();
+   }
+   APRS::HAL::Native::setCapture(true);
+
+   printf("%d frames, %u on-air bits per frame\n\n", iterations, (unsigned)results[0].bits);
+   printf("%-8s %12s %12s %10s\n", "path", "ns/bit", "Msamples/s", "speedup");
+   for (size_t r = 0; r < count; r++) {
+      double bits = (double)results[r].bits * iterations;
+      double ns_per_bit = results[r].seconds * 1e9 / bits;
+      double msps = bits * APRS::Bell202::SAMPLES_PER_BIT / results[r].seconds / 1e6;
+      printf("%-8s %12.1f %12.2f %9.1fx\n", results[r].name, ns_per_bit, msps,
+             results[0].seconds / results[r].seconds);
+   }
+
+   for (size_t r = 1; r < count; r++) {
+      if (results[r].bits != results[0].bits) {
+         fprintf(stderr, "\nBit count mismatch between paths\n");
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/**
+ * Render the same reports through the HAL DAC sink (16-bit words) and a
+ * FileSink (8-bit samples) with each modulator. The file must hold exactly
+ * the high bytes of the DAC capture; timings run with capture disabled.
+ */
+int cmdSinks(int argc, char** argv) {
+   const char* out = (argc > 0) ? argv[0] : "sink.wav";
+   const APRS::ModulatorMode modes[] = { APRS::ModulatorMode::Sample, APRS::ModulatorMode::Block,
+                                         APRS::ModulatorMode::Dds };
+   const char* names[] = { "sample", "block", "dds" };
+
+   printf("%-8s %10s %14s %14s %8s\n", "path", "samples", "dac ns/sample", "file ns/sample", "match");
+   bool all_match = true;
+   for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+      // Reference: the default sink into the native capture
+      APRS::HAL::Native::reset();
+      APRS::APRSClient dac;
+      if (!dac.begin(defaultConfig(modes[m])) || !sendReports(dac)) {
+         fprintf(stderr, "%s: HAL DAC render failed\n", names[m]);
+         return 1;
+      }
+      std::vector<uint16_t> reference = APRS::HAL::Native::samples();
+
+      APRS::HAL::Native::reset();
+      APRS::HAL::Native::setCapture(false);
+      APRS::APRSClient timed;
+      timed.begin(defaultConfig(modes[m]));
+      auto start = std::chrono::steady_clock::now();
+      sendReports(timed);
+      std::chrono::duration<double> dac_wall = std::chrono::steady_clock::now() - start;
+      APRS::HAL::Native::setCapture(true);
+
+      // Same cycle straight into an 8-bit WAV
+      APRS::HAL::Native::reset();
+      APRS::FileSink file(out);
+      APRS::Config config = defaultConfig(modes[m]);
+      config.sink = &file;
+      APRS::APRSClient aprs;
+      start = std::chrono::steady_clock::now();
+      if (!aprs.begin(config) || !sendReports(aprs)) {
+         fprintf(stderr, "%s: file render failed\n", names[m]);
+         return 1;
+      }
+      std::chrono::duration<double> file_wall = std::chrono::steady_clock::now() - start;
+      uint32_t written = file.samples();
+      if (!file.close()) {
+         fprintf(stderr, "Failed to write %s\n", out);
+         return 1;
+      }
+
+      std::vector<uint8_t> data(written);
+      FILE* f = fopen(out, "rb");
+      bool match = f && fseek(f, 44, SEEK_SET) == 0 && fread(data.data(), 1, written, f) == written &&
+                   written == reference.size();
+      if (f) {
+         fclose(f);
+      }
+      for (size_t i = 0; match && i < written; i++) {
+         match = data[i] == (reference[i] >> 8);
+      }
+      all_match = all_match && match;
+
+      printf("%-8s %10u %14.2f %14.2f %8s\n", names[m], (unsigned)written,
+             dac_wall.count() * 1e9 / reference.size(), file_wall.count() * 1e9 / written,
+             match ? "yes" : "NO");
+   }
+
+   if (!all_match) {
+      fprintf(stderr, "\nFileSink output differs from the DAC capture\n");
+      return 1;
+   }
+   printf("\nWrote %s (last path)\n", out);
+   return 0;
+}
+
+/**
+ * Modulate the same position frame at each Bell 202 sample rate with every
+ * modulator: CPU per bit and share of one core in real time, bytes the DAC
+ * DMA moves per second, flash used by the modem tables, and whether the
+ * rendered cycle still decodes.
+ */
+int cmdRates(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 200;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   const APRS::ModemProfile* modems[] = { &APRS::Bell202::PROFILE, &APRS::Bell202_26k::PROFILE,
+                                          &APRS::Bell202_13k::PROFILE };
+   const APRS::ModulatorMode modes[] = { APRS::ModulatorMode::Sample, APRS::ModulatorMode::Block,
+                                         APRS::ModulatorMode::Dds };
+   const char* names[] = { "sample", "block", "dds" };
+
+   printf("%d frames per run\n\n", iterations);
+   printf("%-8s %-7s %5s %9s %10s %10s %9s %7s\n", "rate", "path", "spb", "ns/bit", "% core", "DMA B/s",
+          "table B", "decode");
+   bool all_ok = true;
+   for (size_t r = 0; r < sizeof(modems) / sizeof(modems[0]); r++) {
+      const APRS::ModemProfile& modem = *modems[r];
+      // Flash per modulator: both block table formats, the shared DDS
+      // table, the sample modulator's 128-entry quarter wave
+      const size_t table_bytes[] = {
+         128, 2u * modem.block_phases * modem.samples_per_bit * (sizeof(uint8_t) + sizeof(uint16_t)),
+         (DDS_TABLE_LEN + 1) * sizeof(int16_t)
+      };
+      for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+         APRS::Config config = defaultConfig(modes[m]);
+         config.modem = &modem;
+
+         APRS::HAL::Native::reset();
+         APRS::HAL::Native::setCapture(false);
+         APRS::APRSClient timed;
+         timed.begin(config);
+         auto start = std::chrono::steady_clock::now();
+         for (int i = 0; i < iterations; i++) {
+            timed.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+         }
+         std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+         APRS::HAL::Native::setCapture(true);
+         double ns_per_bit = wall.count() * 1e9 / ((double)timed.lastTxStats().bits * iterations);
+
+         // Same rate through the receiver
+         APRS::HAL::Native::reset();
+         APRS::APRSClient aprs;
+         std::vector<std::string> frames;
+         bool ok = aprs.begin(config) && sendReports(aprs) && decodeRendered(frames) && frames.size() == 2;
+         all_ok = all_ok && ok;
+
+         char rate[16];
+         snprintf(rate, sizeof(rate), "%.1fk", modem.sample_rate / 1000.0);
+         printf("%-8s %-7s %5u %9.1f %10.4f %10u %9zu %7s\n", rate, names[m], (unsigned)modem.samples_per_bit,
+                ns_per_bit, ns_per_bit * modem.baud / 1e7, (unsigned)(modem.sample_rate * sizeof(uint16_t)),
+                table_bytes[m], ok ? "ok" : "FAIL");
+      }
+   }
+
+   if (!all_ok) {
+      fprintf(stderr, "\nA rendered cycle did not decode\n");
+      return 1;
+   }
+   return 0;
+}
+
+const char* txStateName(APRS::TxState state) {
+   switch (state) {
+   case APRS::TxState::Queued:
+      return "queued";
+   case APRS::TxState::Sending:
+      return "sending";
+   case APRS::TxState::Sent:
+      return "sent";
+   case APRS::TxState::Failed:
+      return "failed";
+   case APRS::TxState::Superseded:
+      return "superseded";
+   case APRS::TxState::Dropped:
+      return "dropped";
+   default:
+      return "unknown";
+   }
+}
+
+void printCompletion(APRS::TxHandle handle, APRS::TxState state, void* user) {
+   (void)user;
+   printf("  t=%9.1f ms  handle %u -> %s\n", APRS::HAL::Native::nowMicros() / 1000.0, (unsigned)handle,
+          txStateName(state));
+}
+
+struct LateSubmit {
+   APRS::APRSClient* aprs;
+   APRS::TxHandle handle;
+};
+
+// Stands in for the tracker task: a newer position while the TX task waits
+void submitNewerPosition(void* arg) {
+   LateSubmit* late = static_cast<LateSubmit*>(arg);
+   late->handle = late->aprs->queuePosition(49.104000f, -122.655000f, "ESP32-Tracker");
+}
+
+/**
+ * Queue a tracker cycle, then a newer position before the queue drains,
+ * and service the queue on this thread (the native HAL has no TX task).
+ * Then queue a position and submit a newer one while service() waits out
+ * the gap after the previous key-up: it must still replace the old one.
+ */
+int cmdQueue(int argc, char** argv) {
+   (void)argc;
+   (void)argv;
+
+   APRS::HAL::Native::reset();
+   APRS::HAL::Native::setCapture(false);
+   APRS::APRSClient aprs;
+   APRS::TxEngineConfig engine;
+   engine.use_task = false;
+   if (!aprs.begin(defaultConfig()) || !aprs.startTxEngine(engine)) {
+      fprintf(stderr, "APRS initialization failed\n");
+      return 1;
+   }
+   aprs.onTxComplete(printCompletion);
+
+   APRS::TxHandle pos = aprs.queuePosition(49.102421f, -122.653579f, "ESP32-Tracker");
+   APRS::TxHandle unit = aprs.queueTelemetryDefinitions();
+   APRS::TxHandle telem = aprs.queueTelemetry(sampleTelemetry());
+   printf("queued position=%u definitions=%u telemetry=%u\n", (unsigned)pos, (unsigned)unit, (unsigned)telem);
+
+   APRS::TxHandle newer = aprs.queuePosition(49.103000f, -122.654000f, "ESP32-Tracker");
+   printf("queued newer position=%u\n", (unsigned)newer);
+
+   while (aprs.service()) {
+   }
+   APRS::HAL::Native::setCapture(true);
+
+   printf("final: position=%s newer=%s telemetry=%s\n", txStateName(aprs.txState(pos)),
+          txStateName(aprs.txState(newer)), txStateName(aprs.txState(telem)));
+
+   // The next position goes out no sooner than gap_ms after the last key-up
+   APRS::HAL::Native::setCapture(false);
+   uint32_t keyups = aprs.txEngineStats().keyups;
+   APRS::TxHandle waiting = aprs.queuePosition(49.103500f, -122.654500f, "ESP32-Tracker");
+   LateSubmit late = { &aprs, 0 };
+   APRS::HAL::Timer timer = APRS::HAL::timerCreate(submitNewerPosition, &late, "late_submit");
+   APRS::HAL::timerArmAt(timer, APRS::HAL::micros() + engine.gap_ms * 500ULL);
+   printf("queued position=%u, newer due mid-gap\n", (unsigned)waiting);
+   while (aprs.service()) {
+   }
+   APRS::HAL::Native::setCapture(true);
+
+   uint32_t gap_keyups = aprs.txEngineStats().keyups - keyups;
+   printf("final: position=%s newer=%s in %u key-up(s)\n", txStateName(aprs.txState(waiting)),
+          txStateName(aprs.txState(late.handle)), (unsigned)gap_keyups);
+   bool ok = aprs.txState(waiting) == APRS::TxState::Superseded &&
+             aprs.txState(late.handle) == APRS::TxState::Sent && gap_keyups == 1;
+   if (!ok) {
+      fprintf(stderr, "queue: a position submitted during the gap did not replace the queued one\n");
+   }
+   return ok ? 0 : 1;
+}
+
+/**
+ * Total PTT-on time of the edges captured since first_edge (PTT is active
+ * low, see Protocol::setPTT())
+ */
+double pttOnMs(size_t first_edge) {
+   const std::vector<APRS::HAL::Native::PttEdge>& edges = APRS::HAL::Native::pttEdges();
+   double total_us = 0.0;
+   for (size_t i = first_edge; i + 1 < edges.size(); i++) {
+      if (!edges[i].level) {
+         total_us += edges[i + 1].time_us - edges[i].time_us;
+      }
+   }
+   return total_us / 1000.0;
+}
+
+/**
+ * Queue one tracker cycle (position, PARM, UNIT, telemetry), inside a burst
+ * if requested, and drain it. Returns the engine counters.
+ */
+bool runCycle(bool burst, APRS::TxEngineStats& stats, double& ptt_ms) {
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   APRS::TxEngineConfig engine;
+   engine.use_task = false;
+   engine.gap_ms = 0;
+   if (!aprs.begin(defaultConfig()) || !aprs.startTxEngine(engine)) {
+      fprintf(stderr, "APRS initialization failed\n");
+      return false;
+   }
+
+   if (burst) {
+      aprs.beginBurst();
+   }
+   bool ok = aprs.queuePosition(49.102421f, -122.653579f, "ESP32-Tracker") != 0;
+   ok = ok && aprs.queueTelemetryDefinitions() != 0;
+   ok = ok && aprs.queueTelemetry(sampleTelemetry()) != 0;
+   if (burst) {
+      aprs.endBurst();
+   }
+   if (!ok) {
+      fprintf(stderr, "Could not queue the cycle\n");
+      return false;
+   }
+
+   while (aprs.service()) {
+   }
+   stats = aprs.txEngineStats();
+   ptt_ms = pttOnMs(0);
+   return true;
+}
+
+/**
+ * Send the same tracker cycle as separate key-ups and as one burst, and
+ * compare the airtime reported by the engine with the captured PTT time.
+ */
+int cmdBurst(int argc, char** argv) {
+   const char* out = (argc > 0) ? argv[0] : nullptr;
+
+   APRS::TxEngineStats separate;
+   APRS::TxEngineStats burst;
+   double separate_ptt = 0.0;
+   double burst_ptt = 0.0;
+   if (!runCycle(false, separate, separate_ptt) || !runCycle(true, burst, burst_ptt)) {
+      return 1;
+   }
+
+   printf("%-9s %7s %7s %12s %12s %10s\n", "mode", "keyups", "frames", "airtime ms", "ptt ms", "saved ms");
+   printf("%-9s %7u %7u %12u %12.1f %10u\n", "separate", (unsigned)separate.keyups, (unsigned)separate.frames,
+          (unsigned)separate.airtime_ms, separate_ptt, (unsigned)separate.saved_ms);
+   printf("%-9s %7u %7u %12u %12.1f %10u\n", "burst", (unsigned)burst.keyups, (unsigned)burst.frames,
+          (unsigned)burst.airtime_ms, burst_ptt, (unsigned)burst.saved_ms);
+   printf("\nMeasured saving %.1f ms (%.0f%%), reported %u ms\n", separate_ptt - burst_ptt,
+          100.0 * (separate_ptt - burst_ptt) / separate_ptt, (unsigned)burst.saved_ms);
+
+   if (out) {
+      if (!APRS::HAL::Native::writeWav(out)) {
+         fprintf(stderr, "Failed to write %s\n", out);
+         return 1;
+      }
+      printf("Wrote %s\n", out);
+   }
+   return 0;
+}
+
+/**
+ * Estimate the airtime of each payload with APRSClient::airtimeMs(), send
+ * it, and compare with the PTT-on time the HAL captured, for each modem
+ * and framing; the last column switches modem just before estimating.
+ * Then time the estimator alone.
+ */
+int cmdAirtime(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 20000;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   // Position, telemetry, and info bytes of all ones (a stuffed bit every 5)
+   char ones[64];
+   memset(ones, 0xFF, sizeof(ones));
+   struct Payload {
+      const char* name;
+      const char* data;
+      size_t len;
+   } payloads[] = { { "position", nullptr, 0 },
+                    { "telemetry", "T#000,3.700,21.500,1013.200,45.000,100.000,00000000", 51 },
+                    { "all-ones", ones, sizeof(ones) } };
+   struct Case {
+      const char* name;
+      const char* modem;
+      APRS::FX25Mode fx25;
+      APRS::Framing framing;
+   } cases[] = { { "105k", "105k", APRS::FX25Mode::Off, APRS::Framing::Ax25 },
+                 { "13k", "13k", APRS::FX25Mode::Off, APRS::Framing::Ax25 },
+                 { "hf300", "hf300", APRS::FX25Mode::Off, APRS::Framing::Ax25 },
+                 { "fx25/32", "105k", APRS::FX25Mode::Check32, APRS::Framing::Ax25 },
+                 { "il2p", "105k", APRS::FX25Mode::Off, APRS::Framing::Il2p },
+                 { "->hf300", "hf300", APRS::FX25Mode::Off, APRS::Framing::Ax25 } };
+   const size_t ncases = sizeof(cases) / sizeof(cases[0]);
+
+   printf("%-10s", "payload");
+   for (size_t c = 0; c < ncases; c++) {
+      printf(" %13s", cases[c].name);
+   }
+   printf("\n");
+   bool ok = true;
+   for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++) {
+      printf("%-10s", payloads[p].name);
+      for (size_t c = 0; c < ncases; c++) {
+         const APRS::ModemProfile* modem = nullptr;
+         parseModem(cases[c].modem, modem);
+         APRS::HAL::Native::reset();
+         APRS::Config config = defaultConfig();
+         config.fx25 = cases[c].fx25;
+         config.framing = cases[c].framing;
+         bool pending = c == ncases - 1;
+         config.modem = pending ? nullptr : modem;
+         APRS::APRSClient aprs;
+         if (!aprs.begin(config)) {
+            fprintf(stderr, "APRS initialization failed\n");
+            return 1;
+         }
+         if (pending) {
+            aprs.setModem(modem);
+         }
+
+         uint32_t estimate;
+         bool sent;
+         if (payloads[p].data) {
+            const uint8_t* data = (const uint8_t*)payloads[p].data;
+            estimate = aprs.airtimeMs(data, payloads[p].len);
+            sent = aprs.sendRawPacket(data, payloads[p].len);
+         } else {
+            estimate = aprs.positionAirtimeMs(49.102421f, -122.653579f, "ESP32-Tracker");
+            sent = aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker");
+         }
+         uint32_t measured = (uint32_t)(pttOnMs(0) + 0.5);
+         bool match = sent && estimate > 0 && estimate == measured && estimate == aprs.lastTxStats().airtime_ms;
+         ok = ok && match;
+         char cell[32];
+         if (match) {
+            snprintf(cell, sizeof(cell), "%u", (unsigned)estimate);
+         } else {
+            snprintf(cell, sizeof(cell), "%u!=%u", (unsigned)estimate, (unsigned)measured);
+         }
+         printf(" %13s", cell);
+      }
+      printf("\n");
+   }
+   printf("\nms, PTT on to PTT off; every estimate must equal the captured PTT time.\n");
+
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   aprs.begin(defaultConfig());
+   uint32_t check = 0;
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; i++) {
+      check += aprs.positionAirtimeMs(49.102421f + i * 1e-5f, -122.653579f, "ESP32-Tracker");
+   }
+   std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+   printf("positionAirtimeMs(): %.0f ns per call (checksum %u)\n", wall.count() * 1e9 / iterations,
+          (unsigned)check);
+
+   if (!ok) {
+      fprintf(stderr, "\nAirtime estimate differs from the key-up\n");
+      return 1;
+   }
+   return 0;
+}
+
+/**
+ * Longest PTT-on time within any window_ms span of the captured edges
+ */
+double maxWindowPttMs(uint32_t window_ms) {
+   const std::vector<APRS::HAL::Native::PttEdge>& edges = APRS::HAL::Native::pttEdges();
+   std::vector<std::pair<uint64_t, uint64_t> > on;
+   for (size_t i = 0; i + 1 < edges.size(); i++) {
+      if (!edges[i].level) {
+         on.push_back(std::make_pair(edges[i].time_us, edges[i + 1].time_us));
+      }
+   }
+   // The busiest window starts with a key-up
+   uint64_t best = 0;
+   for (size_t i = 0; i < on.size(); i++) {
+      uint64_t end = on[i].first + (uint64_t)window_ms * 1000;
+      uint64_t total = 0;
+      for (size_t j = i; j < on.size() && on[j].first < end; j++) {
+         total += (on[j].second < end ? on[j].second : end) - on[j].first;
+      }
+      best = total > best ? total : best;
+   }
+   return best / 1000.0;
+}
+
+/**
+ * The tracker as transmitAPRS() polled it, with a stored update interval
+ * of 0 (what loadAPRSConfig() now clamps to 1 minute): a tracker cycle
+ * burst is due on every 10 ms loop. Runs an hour of virtual time with and
+ * without the duty-cycle limit and checks the busiest window of captured
+ * PTT time against the limit. Then an Urgent frame must go out despite it.
+ */
+int cmdDuty(int argc, char** argv) {
+   int percent = (argc > 0) ? atoi(argv[0]) : 10;
+   int window_s = (argc > 1) ? atoi(argv[1]) : 600;
+   if (percent <= 0 || percent > 100 || window_s <= 0) {
+      fprintf(stderr, "percent must be 1-100 and the window positive\n");
+      return 2;
+   }
+   const uint32_t run_ms = 3600000;
+   const uint32_t window_ms = (uint32_t)window_s * 1000;
+
+   printf("%-10s %7s %7s %8s %9s %11s %13s %9s\n", "limit", "keyups", "frames", "dropped", "deferred",
+          "ledger ms", "busiest ms", "duty");
+   bool ok = true;
+   for (int limited = 0; limited < 2; limited++) {
+      APRS::HAL::Native::reset();
+      APRS::HAL::Native::setCapture(false);
+      APRS::APRSClient aprs;
+      APRS::TxEngineConfig engine;
+      engine.use_task = false;
+      engine.max_duty_percent = limited ? (uint8_t)percent : 0;
+      engine.duty_window_ms = window_ms;
+      if (!aprs.begin(defaultConfig()) || !aprs.startTxEngine(engine)) {
+         fprintf(stderr, "APRS initialization failed\n");
+         return 1;
+      }
+
+      const uint16_t update_interval_min = 0;
+      const uint32_t interval_ms = update_interval_min * 60000UL;
+      uint32_t last_cycle = 0;
+      uint32_t cycles = 0;
+      uint32_t loops = 0;
+      while (APRS::HAL::millis() < run_ms) {
+         uint32_t now = APRS::HAL::millis();
+         if (cycles == 0 || now - last_cycle >= interval_ms) {
+            aprs.beginBurst();
+            aprs.queuePosition(49.102421f, -122.653579f, "ESP32-Tracker");
+            aprs.queueTelemetryDefinitions();
+            aprs.queueTelemetry(sampleTelemetry());
+            aprs.endBurst();
+            last_cycle = now;
+            cycles++;
+         }
+         aprs.service();
+         APRS::HAL::delayMs(10);
+         loops++;
+      }
+      ok = ok && cycles == loops;
+
+      APRS::TxEngineStats stats = aprs.txEngineStats();
+      APRS::DutyCycleStatus duty = aprs.dutyCycle();
+      double busiest = maxWindowPttMs(window_ms);
+      char name[16];
+      snprintf(name, sizeof(name), limited ? "%d%%" : "none", percent);
+      printf("%-10s %7u %7u %8u %8us %11u %13.0f %8.1f%%\n", name, (unsigned)stats.keyups, (unsigned)stats.frames,
+             (unsigned)stats.dropped, (unsigned)(stats.deferred_ms / 1000), (unsigned)duty.window.airtime_ms,
+             busiest, 100.0 * busiest / window_ms);
+
+      if (limited) {
+         ok = ok && busiest <= window_ms * percent / 100.0 && stats.dropped > 0 && stats.deferred_ms > 0;
+
+         // The budget is spent: the position waits, an Urgent frame behind
+         // it goes out first
+         uint32_t before = APRS::HAL::millis();
+         APRS::TxHandle position = aprs.queuePosition(49.102421f, -122.653579f, "ESP32-Tracker");
+         aprs.service();
+         APRS::TxHandle urgent = aprs.queueMessage(":NOCALL-1 :help", APRS::TxPriority::Urgent);
+         while (aprs.txState(urgent) == APRS::TxState::Queued) {
+            aprs.service();
+         }
+         bool deferred = aprs.txState(position) == APRS::TxState::Queued;
+         printf("\nspent budget: urgent message %s after %u ms, position %s\n",
+                txStateName(aprs.txState(urgent)), (unsigned)(APRS::HAL::millis() - before),
+                txStateName(aprs.txState(position)));
+         ok = ok && deferred && aprs.txState(urgent) == APRS::TxState::Sent;
+      }
+      APRS::HAL::Native::setCapture(true);
+   }
+
+   if (!ok) {
+      fprintf(stderr, "\nDuty-cycle limit check failed\n");
+      return 1;
+   }
+   return 0;
+}
+
+/**
+ * Send a position with several PTT lead/tail settings, modems and
+ * polarities and check the key-up against the captured samples: PTT on at
+ * the first sample of the key-up, exactly the lead of silence before the
+ * first modulated sample and the tail after the last, PTT off as the last
+ * sample ends, and the airtime estimate equal to the PTT time.
+ */
+int cmdPtt(int argc, char** argv) {
+   struct Case {
+      const char* modem;
+      int lead_ms;
+      int tail_ms;
+      bool active_high;
+   } cases[] = {
+      { "105k", PTT_LEAD_MS, PTT_TAIL_MS, false },
+      { "105k", 250, 120, false },
+      { "13k", 0, 0, false },
+      { "13k", 30, 10, true },
+      { "hf300", 75, 25, false },
+   };
+   if (argc > 0) {
+      for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+         cases[c].lead_ms = atoi(argv[0]);
+         cases[c].tail_ms = (argc > 1) ? atoi(argv[1]) : cases[c].lead_ms;
+      }
+   }
+
+   printf("%-7s %6s %6s %5s %11s %11s %11s %9s %9s\n", "modem", "lead", "tail", "pol", "lead ms", "tail ms",
+          "ptt ms", "estimate", "check");
+   bool all_ok = true;
+   for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+      const Case& k = cases[c];
+      APRS::Config config = defaultConfig();
+      if (k.lead_ms < 0 || k.lead_ms > 65535 || k.tail_ms < 0 || k.tail_ms > 65535 ||
+          !parseModem(k.modem, config.modem)) {
+         fprintf(stderr, "lead and tail must be 0-65535 ms\n");
+         return 2;
+      }
+      config.ptt_lead_ms = (uint16_t)k.lead_ms;
+      config.ptt_tail_ms = (uint16_t)k.tail_ms;
+      config.ptt_active_high = k.active_high;
+
+      APRS::HAL::Native::reset();
+      APRS::APRSClient aprs;
+      if (!aprs.begin(config)) {
+         fprintf(stderr, "APRSClient::begin() failed\n");
+         return 1;
+      }
+      size_t first_edge = APRS::HAL::Native::pttEdges().size();
+      uint64_t start_us = APRS::HAL::Native::nowMicros();
+      uint32_t estimate = aprs.positionAirtimeMs(49.102421f, -122.653579f, "ESP32-Tracker");
+      if (!aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker")) {
+         fprintf(stderr, "%s: send failed\n", k.modem);
+         return 1;
+      }
+
+      // Silence at both ends of the key-up, modulated bits in between
+      const std::vector<uint16_t>& samples = APRS::HAL::Native::samples();
+      const std::vector<APRS::HAL::Native::PttEdge>& edges = APRS::HAL::Native::pttEdges();
+      const APRS::TxStats& tx = aprs.lastTxStats();
+      const APRS::ModemProfile& modem = aprs.modem();
+      uint32_t rate = modem.sample_rate;
+      uint32_t lead = (uint32_t)(((uint64_t)k.lead_ms * rate + 500) / 1000);
+      uint32_t tail = (uint32_t)(((uint64_t)k.tail_ms * rate + 500) / 1000);
+      bool ok = samples.size() == tx.samples && tx.samples == lead + tx.bits * modem.samples_per_bit + tail;
+      for (size_t i = 0; ok && i < lead; i++) {
+         ok = samples[i] == (128 << 8);
+      }
+      for (size_t i = samples.size() - tail; ok && i < samples.size(); i++) {
+         ok = samples[i] == (128 << 8);
+      }
+
+      // One edge each way, on the first sample and after the last
+      bool edges_ok = edges.size() == first_edge + 2 && edges[first_edge].level == k.active_high &&
+                      edges[first_edge + 1].level != k.active_high && edges[first_edge].time_us == start_us &&
+                      edges[first_edge + 1].time_us == start_us + (uint64_t)tx.samples * 1000000 / rate;
+      double ptt_ms = edges_ok ? (edges[first_edge + 1].time_us - edges[first_edge].time_us) / 1000.0 : 0.0;
+      ok = ok && edges_ok && estimate == tx.airtime_ms && (uint32_t)(ptt_ms + 0.5) == estimate;
+      all_ok = all_ok && ok;
+
+      printf("%-7s %6d %6d %5s %11.3f %11.3f %11.3f %9u %9s\n", k.modem, k.lead_ms, k.tail_ms,
+             k.active_high ? "high" : "low", lead * 1000.0 / rate, tail * 1000.0 / rate, ptt_ms,
+             (unsigned)estimate, ok ? "ok" : "FAIL");
+   }
+
+   printf("\nlead/tail ms: silence around the modulated bits; ptt ms: captured edges.\n");
+   if (!all_ok) {
+      fprintf(stderr, "\nPTT edges do not line up with the audio\n");
+      return 1;
+   }
+   return 0;
+}
+
+/**
+ * Build a mix of tracker and digipeated frames with AX25FrameBuilder, then
+ * time AX25FrameView::parse() alone and parse plus TNC2 formatting.
+ */
+int cmdParse(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 200000;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   struct Sample {
+      size_t path_len;
+      bool repeated;
+      const char* info;
+   } samples[] = {
+      { 2, false, "=4906.15N/12239.21WnPHG1110ESP32-Tracker" },
+      { 2, false, ":NOCALL-9 :PARM.Battery,Temp,Pressure,Humidity,Altitude" },
+      { 2, false, "T#000,3.700,21.500,1013.200,45.000,100.000,00000000" },
+      { AX25_MAX_PATH, true, "!4903.50N/07201.75W-Digipeated through a full path" },
+   };
+   const size_t count = sizeof(samples) / sizeof(samples[0]);
+
+   APRS::AX25Call src = { "NOCALL", 9 };
+   APRS::AX25Call dst = { "APZMDR", 0 };
+   APRS::AX25Call path[2] = { { "WIDE1", 1 }, { "WIDE2", 2 } };
+   uint8_t frames[count][AX25_MAX_FRAME_LEN];
+   size_t lens[count];
+   for (size_t i = 0; i < count; i++) {
+      APRS::AX25FrameBuilder builder(frames[i], sizeof(frames[i]));
+      builder.addAddress(dst);
+      builder.addAddress(src);
+      for (size_t p = 0; p < samples[i].path_len; p++) {
+         builder.addAddress(path[p % 2], samples[i].repeated);
+      }
+      builder.addHeader();
+      builder.addInfo((const uint8_t*)samples[i].info, strlen(samples[i].info));
+      lens[i] = builder.finish();
+      if (lens[i] == 0) {
+         fprintf(stderr, "Frame %zu does not fit\n", i);
+         return 1;
+      }
+      lens[i] -= 2;   // Views see frames as the demodulator delivers them, without FCS
+
+      APRS::AX25FrameView view;
+      char line[512];
+      if (!view.parse(frames[i], lens[i]) || view.format(line, sizeof(line)) == 0) {
+         fprintf(stderr, "Frame %zu does not parse\n", i);
+         return 1;
+      }
+      printf("%3zu B  %s\n", lens[i], line);
+   }
+
+   // Fold fields into a checksum so the parse cannot be optimized away
+   uint32_t check = 0;
+   auto start = std::chrono::steady_clock::now();
+   for (int n = 0; n < iterations; n++) {
+      for (size_t i = 0; i < count; i++) {
+         APRS::AX25FrameView view;
+         if (view.parse(frames[i], lens[i])) {
+            check += view.source().ssid() + view.pathLength() + view.infoLength() + view.info()[0];
+            if (view.pathLength() > 0 && view.path(view.pathLength() - 1).isRepeated()) {
+               check++;
+            }
+         }
+      }
+   }
+   std::chrono::duration<double> parse_s = std::chrono::steady_clock::now() - start;
+
+   char line[512];
+   start = std::chrono::steady_clock::now();
+   for (int n = 0; n < iterations; n++) {
+      for (size_t i = 0; i < count; i++) {
+         APRS::AX25FrameView view;
+         if (view.parse(frames[i], lens[i])) {
+            check += view.format(line, sizeof(line));
+         }
+      }
+   }
+   std::chrono::duration<double> format_s = std::chrono::steady_clock::now() - start;
+
+   // Encode: full frame build per packet against the cached header
+   uint8_t out[AX25_MAX_FRAME_LEN];
+   start = std::chrono::steady_clock::now();
+   for (int n = 0; n < iterations; n++) {
+      for (size_t i = 0; i < count; i++) {
+         check += APRS::Protocol::encodeFrame(src, dst, path, 2, (const uint8_t*)samples[i].info,
+                                              strlen(samples[i].info), out, sizeof(out));
+      }
+   }
+   std::chrono::duration<double> build_s = std::chrono::steady_clock::now() - start;
+
+   APRS::AX25HeaderCache header;
+   header.build(src, dst, path, 2);
+   start = std::chrono::steady_clock::now();
+   for (int n = 0; n < iterations; n++) {
+      for (size_t i = 0; i < count; i++) {
+         check += header.encode((const uint8_t*)samples[i].info, strlen(samples[i].info), out, sizeof(out));
+      }
+   }
+   std::chrono::duration<double> cached_s = std::chrono::steady_clock::now() - start;
+
+   double total = (double)iterations * count;
+   printf("\n%.0f frames (checksum %u)\n", total, (unsigned)check);
+   printf("%-14s %10.1f ns/frame %12.0f frames/s\n", "parse", parse_s.count() * 1e9 / total,
+          total / parse_s.count());
+   printf("%-14s %10.1f ns/frame %12.0f frames/s\n", "parse+format", format_s.count() * 1e9 / total,
+          total / format_s.count());
+   printf("%-14s %10.1f ns/frame %12.0f frames/s\n", "encode", build_s.count() * 1e9 / total,
+          total / build_s.count());
+   printf("%-14s %10.1f ns/frame %12.0f frames/s\n", "encode cached", cached_s.count() * 1e9 / total,
+          total / cached_s.count());
+   printf("1200 bd channel peak: %.1f frames/s\n", APRS::Bell202::BAUD / 8.0 / (lens[0] + 4));
+   return 0;
+}
+
+struct Command {
+   const char* name;
+   int (*run)(int argc, char** argv);
+   const char* help;
+};
+
+const Command COMMANDS[] = {
+   { "render", cmdRender, "render [out.wav] [modulator] [modem] Render one tracker cycle to WAV and report stats" },
+   { "bench", cmdBench, "bench [iterations]                   Compare modulator paths on identical frames" },
+   { "rates", cmdRates, "rates [iterations]                   Compare modem sample rates per modulator" },
+   { "sinks", cmdSinks, "sinks [out.wav]                      Render through each audio sink and compare" },
+   { "spectrum", cmdSpectrum, "spectrum [modulator] [modem]         Tone error, harmonics and bit-boundary continuity" },
+   { "queue", cmdQueue, "queue                                Exercise the TX queue and coalescing" },
+   { "burst", cmdBurst, "burst [out.wav]                      Compare one key-up per packet against a burst" },
+   { "decode", cmdDecode, "decode <in.wav> [modem]              Demodulate a WAV file and print the frames" },
+   { "loopback", cmdLoopback, "loopback [modulator] [noise] [modem] Modulate, demodulate and check a tracker cycle" },
+   { "parse", cmdParse, "parse [iterations]                   AX.25 parse, format and encode throughput" },
+   { "kiss", cmdKiss, "kiss [out.wav]                       KISS TNC on a pseudo-terminal" },
+   { "kisstest", cmdKissTest, "kisstest [frames] [seed]             Back-to-back KISS frames through the TNC and back" },
+   { "golden", cmdGolden, "golden [dir]                         Render, check and write the per-modem golden WAVs" },
+   { "fx25", cmdFx25, "fx25 [trials] [seed]                 FX.25 round trip, RS encoder timing and loopback" },
+   { "il2p", cmdIl2p, "il2p [trials] [seed]                 IL2P round trip, airtime and known answers" },
+   { "cache", cmdCache, "cache [iterations]                   Render cache: identical audio, hit counts, timing" },
+   { "airtime", cmdAirtime, "airtime [iterations]                 Airtime estimates against the captured PTT time" },
+   { "duty", cmdDuty, "duty [percent] [window_s]            Duty-cycle limit under a runaway beacon loop" },
+   { "ptt", cmdPtt, "ptt [lead_ms] [tail_ms]              PTT edges against the first and last audio sample" },
+   { "crc", cmdCrc, "crc [megabytes]                      FCS tables against a bitwise reference, throughput" },
+   { "position", cmdPosition, "position [iterations]                Compressed/uncompressed reports: round trip, bytes, airtime" },
+   { "smartbeacon", cmdSmartBeacon, "smartbeacon [fixed_s]                SmartBeaconing against fixed intervals on a replayed drive" },
+   { "schedule", cmdSchedule, "schedule [minutes]                   Job lateness under load: timer scheduler against polling" },
+};
+
+void usage(const char* prog) {
+   fprintf(stderr, "Usage: %s <command> [args]\n\n", prog);
+   for (size_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++) {
+      fprintf(stderr, "  %s\n", COMMANDS[i].help);
+   }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+   if (argc < 2) {
+      usage(argv[0]);
+      return 2;
+   }
+
+   for (size_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++) {
+      if (strcmp(argv[1], COMMANDS[i].name) == 0) {
+         return COMMANDS[i].run(argc - 2, argv + 2);
+      }
+   }
+
+   usage(argv[0]);
+   return 2;
+}
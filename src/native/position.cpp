@@ -0,0 +1,484 @@
+/**
+ * Position command for the native host driver
+ *
+ * position Round-trip random reports through the uncompressed, compressed
+ *          (Base91) and Mic-E encoders and a reference decoder, then send a
+ *          parked and a moving tracker's report in each format through
+ *          the modulator and receiver: info bytes, on-air bits and airtime
+ *          against the current PHG report. Last, time the encoders.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+/**
+ * What a receiver makes of a position report
+ */
+struct Decoded {
+   double lat;
+   double lon;
+   bool has_course_speed;
+   int course;
+   double speed_knots;
+   bool has_altitude;
+   double altitude_ft;
+   int message;           // Mic-E message code, -1 if mixed or not Mic-E
+};
+
+// Largest errors seen, in the units of each field
+struct Errors {
+   double position;       // Degrees
+   double course;         // Degrees
+   double speed;          // Relative (compressed) or knots
+   double altitude;       // Relative (in cs), feet or meters (Mic-E)
+};
+
+int base91(const char* p, int digits) {
+   int value = 0;
+   for (int i = 0; i < digits; i++) {
+      value = value * 91 + (p[i] - 33);
+   }
+   return value;
+}
+
+double altitudeFromComment(const char* info, size_t len, bool& found) {
+   std::string text(info, len);
+   size_t at = text.find("/A=");
+   found = at != std::string::npos;
+   return found ? atof(text.c_str() + at + 3) : 0.0;
+}
+
+/**
+ * Reference decoder for the compressed format (APRS 1.0.1 chapter 9), in
+ * floating point
+ */
+bool decodeCompressed(const char* info, size_t len, Decoded& out) {
+   if (len < POSITION_COMPRESSED_LEN) {
+      return false;
+   }
+   for (int i = 1; i < 9; i++) {
+      if (info[i] < 33 || info[i] > 123) {
+         return false;
+      }
+   }
+   out.lat = 90.0 - base91(info + 1, 4) / 380926.0;
+   out.lon = -180.0 + base91(info + 5, 4) / 190463.0;
+   out.has_course_speed = false;
+   out.has_altitude = false;
+
+   char c = info[10];
+   char s = info[11];
+   int type = info[12] - 33;
+   if (c != ' ') {
+      if (((type >> 3) & 3) == 2) {
+         out.has_altitude = true;
+         out.altitude_ft = pow(1.002, base91(info + 10, 2));
+      } else if (c - 33 <= 89) {
+         out.has_course_speed = true;
+         out.course = (c - 33) * 4;
+         out.speed_knots = pow(1.08, s - 33) - 1.0;
+      }
+   }
+   if (!out.has_altitude) {
+      out.altitude_ft = altitudeFromComment(info + POSITION_COMPRESSED_LEN, len - POSITION_COMPRESSED_LEN,
+                                            out.has_altitude);
+   }
+   return true;
+}
+
+/**
+ * Reference decoder for DDMM.MMN/DDDMM.MMW$ with an optional ccc/sss
+ */
+bool decodeUncompressed(const char* info, size_t len, Decoded& out) {
+   std::string text(info, len);
+   int lat_deg, lon_deg;
+   double lat_min, lon_min;
+   char ns, ew;
+   if (len < 19 || sscanf(text.c_str(), "%2d%5lf%c%*c%3d%5lf%c", &lat_deg, &lat_min, &ns, &lon_deg, &lon_min,
+                          &ew) != 6) {
+      return false;
+   }
+   out.lat = (lat_deg + lat_min / 60.0) * (ns == 'S' ? -1 : 1);
+   out.lon = (lon_deg + lon_min / 60.0) * (ew == 'W' ? -1 : 1);
+
+   int course, speed;
+   out.has_course_speed = len >= 26 && text[22] == '/' && sscanf(text.c_str() + 19, "%3d/%3d", &course, &speed) == 2;
+   out.course = out.has_course_speed ? course % 360 : 0;
+   out.speed_knots = out.has_course_speed ? speed : 0.0;
+   out.altitude_ft = altitudeFromComment(info + 19, len - 19, out.has_altitude);
+   return true;
+}
+
+/**
+ * Reference decoder for Mic-E (APRS 1.0.1 chapter 10): latitude and
+ * message bits from the destination, the rest from the information field
+ */
+bool decodeMicE(const char* dest, const char* info, size_t len, Decoded& out) {
+   if (strlen(dest) != MICE_DEST_LEN || len < MICE_INFO_LEN) {
+      return false;
+   }
+   int digit[MICE_DEST_LEN];
+   bool flag[MICE_DEST_LEN];
+   bool custom = false;
+   for (int i = 0; i < MICE_DEST_LEN; i++) {
+      char c = dest[i];
+      if (c >= '0' && c <= '9') {
+         digit[i] = c - '0';
+         flag[i] = false;
+      } else if (c >= 'P' && c <= 'Y') {
+         digit[i] = c - 'P';
+         flag[i] = true;
+      } else if (c >= 'A' && c <= 'J' && i < 3) {
+         digit[i] = c - 'A';
+         flag[i] = true;
+         custom = true;
+      } else {
+         return false;
+      }
+   }
+   out.lat = digit[0] * 10 + digit[1] + (digit[2] * 10 + digit[3] + (digit[4] * 10 + digit[5]) / 100.0) / 60.0;
+   out.lat = flag[3] ? out.lat : -out.lat;
+
+   int bits = (flag[0] ? 4 : 0) | (flag[1] ? 2 : 0) | (flag[2] ? 1 : 0);
+   bool standard = dest[0] >= 'P' || dest[1] >= 'P' || dest[2] >= 'P';
+   out.message = (bits == 0) ? (int)APRS::MicEMessage::Emergency
+               : (custom && standard) ? -1
+               : (custom ? (int)APRS::MicEMessage::Custom0 : 0) + 7 - bits;
+
+   int d = info[1] - 28 + (flag[4] ? 100 : 0);
+   d = (d >= 180 && d <= 189) ? d - 80 : (d >= 190 && d <= 199) ? d - 190 : d;
+   int m = info[2] - 28;
+   m = (m >= 60) ? m - 60 : m;
+   out.lon = d + (m + (info[3] - 28) / 100.0) / 60.0;
+   out.lon = flag[5] ? -out.lon : out.lon;
+
+   int sp = info[4] - 28;
+   int dc = info[5] - 28;
+   int speed = sp * 10 + dc / 10;
+   int course = dc % 10 * 100 + (info[6] - 28);
+   speed = (speed >= 800) ? speed - 800 : speed;
+   course = (course >= 400) ? course - 400 : course;
+   out.has_course_speed = speed != 0 || course != 0;
+   out.course = course % 360;
+   out.speed_knots = speed;
+
+   out.has_altitude = len >= MICE_INFO_LEN + MICE_ALTITUDE_LEN && info[MICE_INFO_LEN + 3] == '}';
+   out.altitude_ft = out.has_altitude ? (base91(info + MICE_INFO_LEN, 3) - 10000) / 0.3048 : 0.0;
+   return true;
+}
+
+bool decode(APRS::PositionFormat format, const char* dest, const char* info, size_t len, Decoded& out) {
+   out.message = -1;
+   if (format == APRS::PositionFormat::MicE) {
+      return len >= 1 && info[0] == '`' && decodeMicE(dest, info, len, out);
+   }
+   if (len < 1 || info[0] != '=' || strcmp(dest, "APZMDR") != 0) {
+      return false;
+   }
+   return (format == APRS::PositionFormat::Compressed) ? decodeCompressed(info + 1, len - 1, out)
+                                                       : decodeUncompressed(info + 1, len - 1, out);
+}
+
+/**
+ * Check a decoded report against what was encoded, within the resolution
+ * of the format
+ */
+bool matches(APRS::PositionFormat format, const APRS::PositionReport& report, const Decoded& got, Errors& worst) {
+   bool compressed = format == APRS::PositionFormat::Compressed;
+   bool mic_e = format == APRS::PositionFormat::MicE;
+
+   // Half a step of 1/380926 (1/190463) degree, or of 0.01 minute, plus
+   // float input
+   double dlat = fabs(got.lat - report.lat);
+   double dlon = fabs(got.lon - report.lon);
+   double position_limit = compressed ? 3.2e-6 : 0.005 / 60.0 + 2e-5;
+   worst.position = fmax(worst.position, fmax(dlat, dlon));
+   bool ok = dlat <= position_limit && dlon <= position_limit;
+
+   if (report.hasCourseSpeed()) {
+      int dcourse = abs(got.course - report.course % 360);
+      dcourse = (dcourse > 180) ? 360 - dcourse : dcourse;
+      double speed_error = compressed ? fabs(log(got.speed_knots + 1.0) - log(report.speed_knots + 1.0))
+                                      : fabs(got.speed_knots - report.speed_knots);
+      worst.course = fmax(worst.course, dcourse);
+      worst.speed = fmax(worst.speed, speed_error);
+      ok = ok && got.has_course_speed && dcourse <= (compressed ? 2 : 0) &&
+           speed_error <= (compressed ? log(1.08) / 2 + 0.01 / (report.speed_knots + 1.0) : 0.5);
+   } else {
+      ok = ok && !got.has_course_speed;
+   }
+
+   if (report.has_altitude) {
+      double feet = floor(report.altitude_m / 0.3048 + 0.5);
+      bool in_cs = compressed && !report.hasCourseSpeed();
+      double altitude_error = in_cs ? fabs(log(got.altitude_ft) - log(fmax(feet, 1.0)))
+                            : mic_e ? fabs(got.altitude_ft * 0.3048 - report.altitude_m)
+                                    : fabs(got.altitude_ft - feet);
+      if (in_cs || !compressed) {
+         worst.altitude = fmax(worst.altitude, altitude_error);
+      }
+      ok = ok && got.has_altitude &&
+           altitude_error <= (in_cs ? log(1.002) / 2 + 2e-5 : mic_e ? 0.5 + 1e-3 : 1.0);
+   } else {
+      ok = ok && !got.has_altitude;
+   }
+   return ok;
+}
+
+APRS::PositionReport randomReport(unsigned& seed) {
+   APRS::PositionReport report;
+   report.lat = (float)(rand_r(&seed) / (double)RAND_MAX * 180.0 - 90.0);
+   report.lon = (float)(rand_r(&seed) / (double)RAND_MAX * 360.0 - 180.0);
+   if (rand_r(&seed) % 3 != 0) {
+      report.course = (int16_t)(rand_r(&seed) % 360);
+      report.speed_knots = (float)(rand_r(&seed) / (double)RAND_MAX * 400.0);
+   }
+   if (rand_r(&seed) % 3 != 0) {
+      report.has_altitude = true;
+      report.altitude_m = (float)(rand_r(&seed) / (double)RAND_MAX * 20000.0 - 100.0);
+   }
+   return report;
+}
+
+/**
+ * Build what buildPositionPayload() sends for a report, from the public
+ * encoders
+ */
+size_t encodeInfo(APRS::PositionFormat format, const APRS::PositionReport& report, APRS::MicEMessage message,
+                  char* info, char* dest) {
+   if (format == APRS::PositionFormat::MicE) {
+      return APRS::encodeMicE(report, message, '/', '>', dest, info);
+   }
+   strcpy(dest, "APZMDR");
+   size_t idx = 0;
+   info[idx++] = '=';
+   if (format == APRS::PositionFormat::Compressed) {
+      size_t len = APRS::encodeCompressedPosition(report, '/', 'n', &info[idx]);
+      if (len == 0) {
+         return 0;
+      }
+      idx += len;
+      if (report.has_altitude && report.hasCourseSpeed()) {
+         idx += APRS::encodeAltitude(report.altitude_m, &info[idx]);
+      }
+   } else {
+      if (!APRS::convertLatitude(report.lat, &info[idx]) || !APRS::convertLongitude(report.lon, &info[idx + 9])) {
+         return 0;
+      }
+      info[idx + 8] = '/';
+      idx += 18;
+      info[idx++] = 'n';
+      if (report.hasCourseSpeed()) {
+         idx += APRS::encodeCourseSpeed(report.course, report.speed_knots, &info[idx]);
+      }
+      if (report.has_altitude) {
+         idx += APRS::encodeAltitude(report.altitude_m, &info[idx]);
+      }
+   }
+   return idx;
+}
+
+bool roundTrip(int trials, unsigned seed) {
+   const APRS::PositionFormat formats[] = { APRS::PositionFormat::Uncompressed, APRS::PositionFormat::Compressed,
+                                            APRS::PositionFormat::MicE };
+   const char* names[] = { "uncompressed", "compressed", "Mic-E" };
+
+   printf("%-13s %7s %12s %10s %10s %10s\n", "format", "reports", "position deg", "course deg", "speed",
+          "altitude");
+   bool ok = true;
+   for (int f = 0; f < 3; f++) {
+      unsigned s = seed;
+      Errors worst = { 0.0, 0.0, 0.0, 0.0 };
+      int failed = 0;
+      for (int t = 0; t < trials; t++) {
+         APRS::PositionReport report = randomReport(s);
+         APRS::MicEMessage message = (APRS::MicEMessage)(rand_r(&s) % ((int)APRS::MicEMessage::Emergency + 1));
+         char info[64];
+         char dest[MICE_DEST_LEN + 1];
+         size_t len = encodeInfo(formats[f], report, message, info, dest);
+         Decoded got;
+         bool mic_e = formats[f] == APRS::PositionFormat::MicE;
+         if (len == 0 || !decode(formats[f], dest, info, len, got) || !matches(formats[f], report, got, worst) ||
+             got.message != (mic_e ? (int)message : -1)) {
+            if (failed++ == 0) {
+               fprintf(stderr, "position: %s %.6f %.6f cse %d spd %.2f alt %d/%.1f -> %s \"%.*s\"\n", names[f],
+                       report.lat, report.lon, report.course, report.speed_knots, report.has_altitude,
+                       report.altitude_m, dest, (int)len, info);
+            }
+         }
+      }
+      bool compressed = formats[f] == APRS::PositionFormat::Compressed;
+      bool mic_e = formats[f] == APRS::PositionFormat::MicE;
+      printf("%-13s %7d %12.2e %10.0f %9.2f%s %9.2f%s %s\n", names[f], trials, worst.position, worst.course,
+             compressed ? 100.0 * (exp(worst.speed) - 1.0) : worst.speed, compressed ? "%" : "k",
+             compressed ? 100.0 * (exp(worst.altitude) - 1.0) : worst.altitude,
+             compressed ? "%" : mic_e ? "m" : "f", failed ? "FAIL" : "ok");
+      ok = ok && failed == 0;
+   }
+   printf("(largest errors: knots and feet (Mic-E: meters), or relative where cs carries them;\n"
+          " compressed /A= is checked to 1 ft, Mic-E message codes exactly)\n");
+   return ok;
+}
+
+/**
+ * Send each report in each format through the modulator, decode it, and
+ * compare bytes, bits and airtime with the current PHG report
+ */
+bool onAir() {
+   struct Case {
+      const char* name;
+      APRS::PositionReport report;
+   } cases[3];
+   cases[0].name = "parked";
+   cases[0].report.has_altitude = true;
+   cases[0].report.altitude_m = 120.0f;
+   cases[1].name = "moving";
+   cases[1].report = cases[0].report;
+   cases[1].report.course = 87;
+   cases[1].report.speed_knots = 52.0f;
+   cases[2].name = "no-alt";
+   cases[2].report.course = 270;
+   cases[2].report.speed_knots = 8.5f;
+   for (int c = 0; c < 3; c++) {
+      cases[c].report.lat = 49.102421f;
+      cases[c].report.lon = -122.653579f;
+   }
+
+   struct Format {
+      const char* name;
+      APRS::PositionFormat format;
+      bool phg;
+   } formats[] = { { "current PHG", APRS::PositionFormat::Uncompressed, true },
+                   { "uncompressed", APRS::PositionFormat::Uncompressed, false },
+                   { "compressed", APRS::PositionFormat::Compressed, false },
+                   { "Mic-E", APRS::PositionFormat::MicE, false } };
+   const int format_count = sizeof(formats) / sizeof(formats[0]);
+
+   printf("\n%-7s %-13s %6s %5s %10s %8s %7s  %s\n", "report", "format", "info B", "bits", "airtime ms",
+          "vs PHG", "decode", "destination:info");
+   bool ok = true;
+   for (int c = 0; c < 3; c++) {
+      uint32_t baseline = 0;
+      for (int f = 0; f < format_count; f++) {
+         APRS::HAL::Native::reset();
+         APRS::Config config = defaultConfig();
+         config.position_format = formats[f].format;
+         APRS::APRSClient aprs;
+         if (!aprs.begin(config)) {
+            fprintf(stderr, "position: client failed to start\n");
+            return false;
+         }
+
+         const APRS::PositionReport& report = cases[c].report;
+         uint32_t estimate;
+         bool sent;
+         if (formats[f].phg) {
+            estimate = aprs.positionAirtimeMs(report.lat, report.lon, "ESP32-Tracker");
+            sent = aprs.sendPosition(report.lat, report.lon, "ESP32-Tracker");
+         } else {
+            estimate = aprs.positionAirtimeMs(report, "ESP32-Tracker");
+            sent = aprs.sendPosition(report, "ESP32-Tracker");
+         }
+         APRS::TxStats tx = aprs.lastTxStats();
+
+         std::vector<std::string> frames;
+         APRS::AX25FrameView view;
+         bool received = sent && decodeRendered(frames) && frames.size() == 1 &&
+                         view.parse((const uint8_t*)frames[0].data(), frames[0].size());
+         const char* info = received ? (const char*)view.info() : "";
+         size_t info_len = received ? view.infoLength() : 0;
+         char dest[7] = "";
+         if (received) {
+            view.destination().callsign(dest);
+         }
+
+         // The PHG report only needs to arrive; the others must carry the fix
+         Decoded got;
+         Errors worst = { 0.0, 0.0, 0.0, 0.0 };
+         APRS::PositionReport expected = report;
+         if (formats[f].phg) {
+            expected.course = -1;
+            expected.has_altitude = false;
+         }
+         bool decoded = received && decode(formats[f].format, dest, info, info_len, got);
+         decoded = decoded && (formats[f].phg || matches(formats[f].format, expected, got, worst));
+         decoded = decoded && (formats[f].format != APRS::PositionFormat::MicE ||
+                               got.message == (int)config.mic_e_message);
+         ok = ok && decoded && estimate == tx.airtime_ms;
+
+         baseline = (f == 0) ? tx.airtime_ms : baseline;
+         std::string shown(info, info_len);
+         for (size_t i = 0; i < shown.size(); i++) {
+            shown[i] = (shown[i] < 0x20 || shown[i] > 0x7E) ? '.' : shown[i];
+         }
+         printf("%-7s %-13s %6zu %5u %10u %+8d %7s  %s:%s\n", cases[c].name, formats[f].name, info_len,
+                (unsigned)tx.bits, (unsigned)tx.airtime_ms, (int)tx.airtime_ms - (int)baseline,
+                decoded ? "ok" : "FAIL", dest, shown.c_str());
+      }
+   }
+   return ok;
+}
+
+template <typename F>
+double nsPerCall(F encode, int iterations) {
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; i++) {
+      encode(i);
+   }
+   std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+   return wall.count() * 1e9 / iterations;
+}
+
+void timing(int iterations) {
+   APRS::PositionReport report;
+   report.course = 87;
+   report.speed_knots = 52.0f;
+   uint32_t check = 0;
+   char out[32];
+   char dest[MICE_DEST_LEN + 1];
+
+   double snprintf_ns = nsPerCall([&](int i) {
+      APRS::convertLatitude(49.102421f + i * 1e-6f, out);
+      APRS::convertLongitude(-122.653579f, out + 9);
+      check += (uint8_t)out[6] + (uint8_t)out[15];
+   }, iterations);
+   double base91_ns = nsPerCall([&](int i) {
+      report.lat = 49.102421f + i * 1e-6f;
+      report.lon = -122.653579f;
+      check += (uint32_t)APRS::encodeCompressedPosition(report, '/', 'n', out) + (uint8_t)out[4];
+   }, iterations);
+
+   double mic_e_ns = nsPerCall([&](int i) {
+      report.lat = 49.102421f + i * 1e-6f;
+      report.lon = -122.653579f;
+      check += (uint32_t)APRS::encodeMicE(report, APRS::MicEMessage::EnRoute, '/', '>', dest, out) +
+               (uint8_t)dest[5];
+   }, iterations);
+
+   printf("\nconvertLatitude() + convertLongitude(): %.0f ns per report\n", snprintf_ns);
+   printf("encodeCompressedPosition() with course/speed: %.0f ns per report (%.1fx)\n", base91_ns,
+          snprintf_ns / base91_ns);
+   printf("encodeMicE() with course/speed: %.0f ns per report (%.1fx, checksum %u)\n", mic_e_ns,
+          snprintf_ns / mic_e_ns, (unsigned)check);
+}
+
+} // namespace
+
+int cmdPosition(int argc, char** argv) {
+   int iterations = (argc > 0) ? atoi(argv[0]) : 200000;
+   if (iterations <= 0) {
+      fprintf(stderr, "iterations must be positive\n");
+      return 2;
+   }
+
+   bool ok = roundTrip(iterations, 1);
+   ok = onAir() && ok;
+   timing(iterations);
+   return ok ? 0 : 1;
+}
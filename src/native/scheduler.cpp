@@ -0,0 +1,244 @@
+/**
+ * Beacon scheduler command for the native host driver
+ *
+ * schedule  Run the tracker's jobs (position, telemetry, definitions, a
+ *           one-shot status) through APRS::Scheduler on the virtual clock,
+ *           alongside a job that blocks for a while every few seconds, with
+ *           every TX burst modulated on the same thread. Reports per-job
+ *           lateness and compares the position timeline with the old
+ *           loop(): poll every 100 ms and restart the interval from the
+ *           time of the send.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+
+const uint32_t POSITION_MS = 60000;
+const uint32_t TELEMETRY_MS = 300000;
+const uint32_t DEFINITIONS_MS = 1800000;
+const uint32_t LOAD_MS = 7000;          // A blocking job every 7 s ...
+const uint32_t LOAD_BUSY_MS = 1500;     // ... busy for 1.5 s
+const uint32_t POLL_MS = 100;           // Old loop() delay
+
+struct Run {
+   APRS::APRSClient* aprs;
+   uint32_t batch_max_us;               // Longest TX drain after a batch
+   uint32_t position_sends;
+   uint64_t position_last_us;
+};
+
+void positionJob(void* arg) {
+   Run* run = static_cast<Run*>(arg);
+   run->aprs->queuePosition(49.102421f, -122.653579f, "ESP32-Tracker");
+   run->position_sends++;
+   run->position_last_us = APRS::HAL::micros();
+}
+
+void telemetryJob(void* arg) {
+   static_cast<Run*>(arg)->aprs->queueTelemetry(sampleTelemetry());
+}
+
+void definitionsJob(void* arg) {
+   static_cast<Run*>(arg)->aprs->queueTelemetryDefinitions();
+}
+
+void statusJob(void* arg) {
+   static const char status[] = ">ESP32 APRS tracker";
+   static_cast<Run*>(arg)->aprs->queueRawPacket((const uint8_t*)status, sizeof(status) - 1);
+}
+
+void loadJob(void* arg) {
+   (void)arg;
+   APRS::HAL::delayMs(LOAD_BUSY_MS);
+}
+
+void batchBegin(void* arg) {
+   static_cast<Run*>(arg)->aprs->beginBurst();
+}
+
+// The TX task's work, done here on the only thread: key up and modulate
+void batchEnd(void* arg) {
+   Run* run = static_cast<Run*>(arg);
+   uint64_t start = APRS::HAL::micros();
+   run->aprs->endBurst();
+   while (run->aprs->service()) {
+   }
+   uint64_t took = APRS::HAL::micros() - start;
+   if (took > run->batch_max_us) {
+      run->batch_max_us = (uint32_t)took;
+   }
+}
+
+bool startClient(APRS::APRSClient& aprs) {
+   APRS::HAL::Native::reset();
+   APRS::HAL::Native::setCapture(false);
+   APRS::TxEngineConfig txConfig;
+   txConfig.use_task = false;
+   return aprs.begin(defaultConfig()) && aprs.startTxEngine(txConfig);
+}
+
+} // namespace
+
+int cmdSchedule(int argc, char** argv) {
+   int minutes = (argc > 0) ? atoi(argv[0]) : 60;
+   if (minutes <= 0) {
+      fprintf(stderr, "duration must be positive\n");
+      return 2;
+   }
+   uint64_t end_us = (uint64_t)minutes * 60000000ULL;
+
+   // Scheduler: woken by its timer, releases on a fixed grid
+   APRS::APRSClient aprs;
+   if (!startClient(aprs)) {
+      fprintf(stderr, "APRS client failed to start\n");
+      return 1;
+   }
+   Run run = { &aprs, 0, 0, 0 };
+   APRS::Scheduler scheduler;
+   APRS::SchedulerConfig config;
+   config.use_task = false;
+   if (!scheduler.begin(config)) {
+      fprintf(stderr, "scheduler failed to start\n");
+      return 1;
+   }
+   scheduler.onBatch(batchBegin, batchEnd, &run);
+
+   APRS::JobConfig jobs[5];
+   jobs[0].name = "position";
+   jobs[0].function = positionJob;
+   jobs[0].period_ms = POSITION_MS;
+   jobs[0].priority = 3;
+   jobs[1].name = "telemetry";
+   jobs[1].function = telemetryJob;
+   jobs[1].period_ms = TELEMETRY_MS;
+   jobs[1].priority = 2;
+   jobs[2].name = "definitions";
+   jobs[2].function = definitionsJob;
+   jobs[2].period_ms = DEFINITIONS_MS;
+   jobs[2].priority = 1;
+   jobs[2].deadline_ms = 60000;
+   jobs[3].name = "status";
+   jobs[3].function = statusJob;
+   jobs[3].delay_ms = 5000;
+   jobs[3].jitter_ms = 10000;
+   jobs[3].deadline_ms = 30000;
+   jobs[3].priority = 1;
+   jobs[4].name = "load";
+   jobs[4].function = loadJob;
+   jobs[4].period_ms = LOAD_MS;
+   jobs[4].delay_ms = 500;
+   APRS::JobId ids[5];
+   for (int j = 0; j < 5; j++) {
+      jobs[j].arg = &run;
+      ids[j] = scheduler.add(jobs[j]);
+      if (ids[j] < 0) {
+         fprintf(stderr, "job %s not added\n", jobs[j].name);
+         return 1;
+      }
+   }
+
+   // The scheduler task's loop, bounded by the run's end
+   uint32_t wakeups = 0;
+   uint32_t idle = 0;
+   while (APRS::HAL::micros() < end_us) {
+      uint32_t before = 0;
+      for (int j = 0; j < 5; j++) {
+         APRS::JobStats stats = scheduler.stats(ids[j]);
+         before += stats.runs + stats.missed;
+      }
+      uint32_t wait_ms = scheduler.service();
+      wakeups++;
+      uint32_t after = 0;
+      for (int j = 0; j < 5; j++) {
+         APRS::JobStats stats = scheduler.stats(ids[j]);
+         after += stats.runs + stats.missed;
+      }
+      idle += (after == before);
+
+      uint64_t left_ms = (end_us - APRS::HAL::micros() + 999) / 1000;
+      APRS::HAL::taskWait((wait_ms < left_ms) ? wait_ms : (uint32_t)left_ms);
+   }
+   APRS::TxEngineStats tx = aprs.txEngineStats();
+
+   // Old loop(): poll, then restart the interval from the send
+   APRS::APRSClient legacy;
+   if (!startClient(legacy)) {
+      fprintf(stderr, "APRS client failed to start\n");
+      return 1;
+   }
+   Run old = { &legacy, 0, 0, 0 };
+   uint32_t polls = 0;
+   uint32_t last_tx = 0;
+   bool sent = false;
+   uint32_t last_load = 0;
+   uint32_t old_late_max_us = 0;
+   uint64_t old_late_total_us = 0;
+   while (APRS::HAL::micros() < end_us) {
+      uint32_t now = APRS::HAL::millis();
+      if (now - last_load >= LOAD_MS) {
+         last_load = now;
+         loadJob(&old);
+      }
+      now = APRS::HAL::millis();
+      if (now - last_tx >= POSITION_MS || !sent) {
+         last_tx = now;
+         sent = true;
+         uint64_t grid_us = (uint64_t)old.position_sends * POSITION_MS * 1000;
+         batchBegin(&old);
+         positionJob(&old);
+         batchEnd(&old);
+         uint64_t late = old.position_last_us - grid_us;
+         old_late_total_us += late;
+         if (late > old_late_max_us) {
+            old_late_max_us = (uint32_t)late;
+         }
+      }
+      APRS::HAL::delayMs(POLL_MS);
+      polls++;
+   }
+
+   printf("%-12s %8s %4s %5s %6s %13s %12s %11s\n", "job", "period s", "prio", "runs", "missed", "late mean ms",
+          "late max ms", "run max ms");
+   uint32_t others_max_us = run.batch_max_us;
+   for (int j = 0; j < 5; j++) {
+      APRS::JobStats stats = scheduler.stats(ids[j]);
+      printf("%-12s %8u %4u %5u %6u %13.1f %12.1f %11.1f\n", scheduler.name(ids[j]),
+             (unsigned)(jobs[j].period_ms / 1000), (unsigned)jobs[j].priority, (unsigned)stats.runs,
+             (unsigned)stats.missed, stats.lateMeanUs() / 1000.0, stats.late_max_us / 1000.0,
+             stats.run_max_us / 1000.0);
+      if (j != 0 && stats.run_max_us > others_max_us) {
+         others_max_us = stats.run_max_us;
+      }
+   }
+
+   APRS::JobStats position = scheduler.stats(ids[0]);
+   uint64_t position_drift_us = run.position_last_us - (uint64_t)(run.position_sends - 1) * POSITION_MS * 1000;
+   uint64_t old_drift_us = old.position_last_us - (uint64_t)(old.position_sends - 1) * POSITION_MS * 1000;
+   printf("\n%d min, %u key-ups, %u frames; longest TX burst %.1f ms\n", minutes, (unsigned)tx.keyups,
+          (unsigned)tx.frames, run.batch_max_us / 1000.0);
+   printf("%-22s %7s %8s %13s %12s %14s\n", "position timeline", "sends", "wakeups", "late mean ms", "late max ms",
+          "last vs grid s");
+   printf("%-22s %7u %8u %13.1f %12.1f %14.1f\n", "scheduler", (unsigned)run.position_sends, (unsigned)wakeups,
+          position.lateMeanUs() / 1000.0, position.late_max_us / 1000.0, position_drift_us / 1e6);
+   printf("%-22s %7u %8u %13.1f %12.1f %14.1f\n", "poll 100 ms (old)", (unsigned)old.position_sends,
+          (unsigned)polls, old_late_total_us / 1000.0 / (old.position_sends ? old.position_sends : 1),
+          old_late_max_us / 1000.0, old_drift_us / 1e6);
+   printf("(%u of %u wakeups found nothing to run)\n", (unsigned)idle, (unsigned)wakeups);
+
+   // Every release accounted for (one more if a busy job ran past the
+   // end), the status sent once, nothing polled, the top job late by at
+   // most one other job (or TX burst), and no drift
+   uint32_t expected = (uint32_t)((end_us - 1) / (POSITION_MS * 1000ULL)) + 1;
+   uint32_t releases = position.runs + position.missed;
+   APRS::JobStats status = scheduler.stats(ids[3]);
+   bool ok = (releases == expected || releases == expected + 1) && status.runs == 1 && idle == 0 &&
+             position.late_max_us <= others_max_us + 1000 && position_drift_us <= position.late_max_us &&
+             old_drift_us > position.late_max_us;
+   if (!ok) {
+      fprintf(stderr, "schedule: timing check failed (expected %u position releases)\n", (unsigned)expected);
+   }
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/**
+ * Spectral accuracy harness for the AFSK modulators
+ *
+ * Renders one position frame per modulator (at any modem rate) and reports:
+ * - Tone frequency error, from the phase drift of each tone across runs of
+ *   identical bits (one-period correlation windows at the nominal tone)
+ * - Harmonic levels relative to the fundamental, from a Hann-windowed FFT
+ * - Phase continuity: largest second difference at bit boundaries versus
+ *   inside bits. A continuous-phase tone switch only bends the slope, so
+ *   the boundary value stays near A * 2 * pi * (space - mark) / fs (about 8
+ *   DAC steps for Bell 202 at 105.6 kHz); a phase jump shows up as a much
+ *   larger spike.
+ */
+#include "commands.h"
+#include <APRS_HAL_Native.h>
+#include <complex>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+
+typedef std::complex<double> cplx;
+
+const double PI = 3.14159265358979323846;
+
+// ============================================================================
+// FFT (iterative radix-2, in place)
+// ============================================================================
+void fft(std::vector<cplx>& a) {
+   size_t n = a.size();
+   for (size_t i = 1, j = 0; i < n; i++) {
+      size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1) {
+         j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+         std::swap(a[i], a[j]);
+      }
+   }
+   for (size_t len = 2; len <= n; len <<= 1) {
+      cplx wlen = std::polar(1.0, -2.0 * PI / len);
+      for (size_t i = 0; i < n; i += len) {
+         cplx w(1.0, 0.0);
+         for (size_t k = 0; k < len / 2; k++) {
+            cplx u = a[i + k];
+            cplx v = a[i + k + len / 2] * w;
+            a[i + k] = u + v;
+            a[i + k + len / 2] = u - v;
+            w *= wlen;
+         }
+      }
+   }
+}
+
+// ============================================================================
+// Analysis
+// ============================================================================
+
+/**
+ * Correlate x[start, start + len) against the tone at absolute sample time
+ */
+cplx correlate(const std::vector<double>& x, size_t start, size_t len, double freq, double fs) {
+   cplx acc(0.0, 0.0);
+   for (size_t n = start; n < start + len && n < x.size(); n++) {
+      acc += x[n] * std::polar(1.0, -2.0 * PI * freq * n / fs);
+   }
+   return acc;
+}
+
+struct ToneResult {
+   double freq;     // Estimated frequency (Hz)
+   size_t runs;     // Runs used for the estimate
+};
+
+/**
+ * Estimate a tone's true frequency from its phase drift (relative to the
+ * nominal frequency) between the first and last bit of every run of at
+ * least three bits sent on that tone.
+ */
+ToneResult estimateTone(const std::vector<double>& x, const std::vector<int>& tones, int tone, double nominal,
+                        double fs, size_t spb) {
+   const size_t window = (size_t)lround(fs / nominal);   // One tone period
+   double num = 0.0;
+   double den = 0.0;
+   size_t runs = 0;
+
+   size_t b = 0;
+   while (b < tones.size()) {
+      size_t e = b;
+      while (e < tones.size() && tones[e] == tones[b]) {
+         e++;
+      }
+      if (tones[b] == tone && e - b >= 3) {
+         size_t first = b * spb;
+         size_t last = (e - 1) * spb;
+         double p1 = std::arg(correlate(x, first, window, nominal, fs));
+         double p2 = std::arg(correlate(x, last, window, nominal, fs));
+         double dphi = remainder(p2 - p1, 2.0 * PI);
+         double dt = (last - first) / fs;
+         num += dphi * dt;
+         den += dt * dt;
+         runs++;
+      }
+      b = e;
+   }
+
+   ToneResult result = { nominal, runs };
+   if (den > 0.0) {
+      result.freq = nominal + num / den / (2.0 * PI);
+   }
+   return result;
+}
+
+/**
+ * Peak power in [freq - width, freq + width] of a one-sided power spectrum
+ */
+double bandPeak(const std::vector<double>& power, double freq, double width, double fs) {
+   size_t n = (power.size() - 1) * 2;
+   size_t lo = (size_t)((freq - width) * n / fs);
+   size_t hi = (size_t)((freq + width) * n / fs);
+   double peak = 1e-30;
+   for (size_t k = lo; k <= hi && k < power.size(); k++) {
+      if (power[k] > peak) {
+         peak = power[k];
+      }
+   }
+   return peak;
+}
+
+int analyze(const char* name, APRS::ModulatorMode mode, const APRS::ModemProfile* modem) {
+   APRS::HAL::Native::reset();
+   APRS::APRSClient aprs;
+   APRS::Config config = defaultConfig(mode);
+   config.modem = modem;
+   if (!aprs.begin(config)) {
+      fprintf(stderr, "APRSClient::begin() failed\n");
+      return 1;
+   }
+   aprs.sendPosition(49.102421f, -122.653579f, "ESP32-Tracker", 1, 1, 1, 0);
+
+   const double fs = APRS::HAL::Native::sampleRate();
+   const double mark_hz = aprs.modem().mark_freq;
+   const double space_hz = aprs.modem().space_freq;
+   const size_t spb = aprs.modem().samples_per_bit;
+   const std::vector<uint16_t>& raw = APRS::HAL::Native::samples();
+   size_t nbits = aprs.lastTxStats().bits;
+
+   // Modulated body only (drop trailing silence), centred on the DAC midpoint
+   std::vector<double> x(nbits * spb);
+   for (size_t n = 0; n < x.size(); n++) {
+      x[n] = (double)(raw[n] >> 8) - 128.0;
+   }
+
+   // Tone of every bit by correlation energy over the whole bit
+   std::vector<int> tones(nbits);
+   for (size_t b = 0; b < nbits; b++) {
+      double m = std::abs(correlate(x, b * spb, spb, mark_hz, fs));
+      double s = std::abs(correlate(x, b * spb, spb, space_hz, fs));
+      tones[b] = (m >= s) ? 0 : 1;
+   }
+
+   ToneResult mark = estimateTone(x, tones, 0, mark_hz, fs, spb);
+   ToneResult space = estimateTone(x, tones, 1, space_hz, fs, spb);
+
+   // Hann-windowed FFT of the body
+   size_t n = 1;
+   while (n < x.size()) {
+      n <<= 1;
+   }
+   std::vector<cplx> spectrum(n, cplx(0.0, 0.0));
+   for (size_t i = 0; i < x.size(); i++) {
+      double w = 0.5 - 0.5 * cos(2.0 * PI * i / (x.size() - 1));
+      spectrum[i] = cplx(x[i] * w, 0.0);
+   }
+   fft(spectrum);
+   std::vector<double> power(n / 2 + 1);
+   for (size_t k = 0; k < power.size(); k++) {
+      power[k] = std::norm(spectrum[k]);
+   }
+
+   const double band = 60.0;
+   double ref = fmax(bandPeak(power, mark_hz, band, fs), bandPeak(power, space_hz, band, fs));
+   double h2m = 10.0 * log10(bandPeak(power, 2.0 * mark_hz, band, fs) / ref);
+   double h3m = 10.0 * log10(bandPeak(power, 3.0 * mark_hz, band, fs) / ref);
+   double h2s = 10.0 * log10(bandPeak(power, 2.0 * space_hz, band, fs) / ref);
+   double h3s = 10.0 * log10(bandPeak(power, 3.0 * space_hz, band, fs) / ref);
+
+   // Second difference at bit boundaries versus inside bits
+   double d2_boundary = 0.0;
+   double d2_inside = 0.0;
+   for (size_t i = 2; i < x.size(); i++) {
+      double d2 = fabs(x[i] - 2.0 * x[i - 1] + x[i - 2]);
+      bool boundary = (i % spb) <= 1;
+      if (boundary) {
+         d2_boundary = fmax(d2_boundary, d2);
+      } else {
+         d2_inside = fmax(d2_inside, d2);
+      }
+   }
+
+   printf("%-7s %9.3f %+8.3f %9.3f %+8.3f %6.1f %6.1f %6.1f %6.1f %8.1f %8.1f\n", name, mark.freq,
+          mark.freq - mark_hz, space.freq, space.freq - space_hz, h2m, h3m, h2s, h3s, d2_boundary, d2_inside);
+   return 0;
+}
+
+} // namespace
+
+// ============================================================================
+// Command
+// ============================================================================
+
+int cmdSpectrum(int argc, char** argv) {
+   struct Mode {
+      const char* name;
+      APRS::ModulatorMode mode;
+   } modes[] = { { "sample", APRS::ModulatorMode::Sample },
+                 { "block", APRS::ModulatorMode::Block },
+                 { "dds", APRS::ModulatorMode::Dds } };
+   const size_t count = sizeof(modes) / sizeof(modes[0]);
+
+   APRS::ModulatorMode only = APRS::ModulatorMode::Block;
+   if (argc > 0 && !parseModulator(argv[0], only)) {
+      fprintf(stderr, "Unknown modulator '%s'\n", argv[0]);
+      return 2;
+   }
+   const APRS::ModemProfile* modem = nullptr;
+   if (argc > 1 && !parseModem(argv[1], modem)) {
+      fprintf(stderr, "Unknown modem '%s'\n", argv[1]);
+      return 2;
+   }
+
+   printf("%-7s %9s %8s %9s %8s %6s %6s %6s %6s %8s %8s\n", "path", "mark Hz", "err", "space Hz", "err",
+          "H2m", "H3m", "H2s", "H3s", "d2 edge", "d2 bit");
+   printf("%-7s %9s %8s %9s %8s %6s %6s %6s %6s %8s %8s\n", "", "", "", "", "", "dBc", "dBc", "dBc", "dBc", "",
+          "");
+   for (size_t i = 0; i < count; i++) {
+      if (argc > 0 && modes[i].mode != only) {
+         continue;
+      }
+      if (analyze(modes[i].name, modes[i].mode, modem) != 0) {
+         return 1;
+      }
+   }
+   return 0;
+}